@@ -0,0 +1,88 @@
+extends SceneTree
+
+# Pre-generates a world region into a region file, without the editor:
+#
+#   godot --headless --path demo --script res://tools/bake_world.gd -- \
+#       --seed=1234 --size=64 --out=user://world.vxrg
+#
+# Options (all optional):
+#   --seed=N             world seed (default 1234)
+#   --size=N             chunks along x and z, centered on 0 (default 32)
+#   --from=x,y,z         first chunk, overrides --size
+#   --to=x,y,z           last chunk (inclusive), overrides --size
+#   --world-height=N     voxels (default 256)
+#   --sea-level=N        (default 64)
+#   --terrain-height=F   (default 32)
+#   --out=PATH           (default user://baked_world.vxrg)
+#   --verify             load the file back and check it against a fresh
+#                        generation of the same chunks, exits with 1 on mismatch
+
+func _init():
+	var options = parse_options(OS.get_cmdline_user_args())
+
+	var generator = VoxelGenerator.new()
+	generator.debug_verbosity = 1
+	generator.seeder = int(options.get("seed", "1234"))
+	generator.world_height = int(options.get("world-height", "256"))
+	generator.sea_level = int(options.get("sea-level", "64"))
+	generator.terrain_height = float(options.get("terrain-height", "32"))
+
+	var size = int(options.get("size", "32"))
+	var vertical_chunks = ceili(generator.world_height / 8.0)
+	var from_chunk = Vector3i(-size / 2, 0, -size / 2)
+	var to_chunk = Vector3i(from_chunk.x + size - 1, vertical_chunks - 1, from_chunk.z + size - 1)
+	if options.has("from"):
+		from_chunk = parse_vector3i(options["from"])
+	if options.has("to"):
+		to_chunk = parse_vector3i(options["to"])
+	var path = options.get("out", "user://baked_world.vxrg")
+
+	print("Baking chunks %s to %s, seed %d, into %s" % [from_chunk, to_chunk, generator.seeder, path])
+	var stats = generator.bake_region(from_chunk, to_chunk, path)
+	if stats.is_empty():
+		generator.free()
+		printerr("Bake failed")
+		quit(1)
+		return
+
+	print("%d chunks, %.1f MB in %.2f s" % [stats["chunks"], stats["bytes"] / 1048576.0, stats["seconds"]])
+	print("%.0f chunks/s, %.2f MB/s written, %.1f MB/s of voxels generated" % [stats["chunks_per_second"], stats["mb_per_second"], stats["voxel_mb_per_second"]])
+
+	var ok = true
+	if options.has("verify"):
+		ok = verify(generator, from_chunk, to_chunk, path, stats["chunks"])
+	generator.free()
+	quit(0 if ok else 1)
+
+
+# Reads the file back the way the game would load it
+func verify(generator: VoxelGenerator, from_chunk: Vector3i, to_chunk: Vector3i, path: String, chunk_count: int) -> bool:
+	var loaded = generator.load_region(path)
+	if loaded.is_empty():
+		printerr("Can't load the baked file back")
+		return false
+	print("Loaded %d chunks in %.2f s" % [loaded["chunks"], loaded["seconds"]])
+	if loaded["chunks"] != chunk_count:
+		printerr("%d chunks baked, %d loaded" % [chunk_count, loaded["chunks"]])
+		return false
+	var expected = generator.compute_region_hash(from_chunk, to_chunk)
+	if loaded["hash"] != expected:
+		printerr("Loaded voxels differ from a fresh generation: hash %x != %x" % [loaded["hash"], expected])
+		return false
+	print("Verified")
+	return true
+
+
+func parse_options(args: PackedStringArray) -> Dictionary:
+	var options = {}
+	for arg in args:
+		if not arg.begins_with("--"):
+			continue
+		var parts = arg.substr(2).split("=", true, 1)
+		options[parts[0]] = parts[1] if parts.size() > 1 else "true"
+	return options
+
+
+func parse_vector3i(text: String) -> Vector3i:
+	var parts = text.split(",")
+	return Vector3i(int(parts[0]), int(parts[1]), int(parts[2]))
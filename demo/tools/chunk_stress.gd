@@ -0,0 +1,193 @@
+extends SceneTree
+
+# Edits, meshing and unloading at the same time, to shake out races between
+# the main thread and the mesh jobs:
+#
+#   godot --headless --path demo --script res://tools/chunk_stress.gd -- \
+#       --seed=1234 --size=6 --frames=600 --edits=200 --reload-every=40 [--sparse]
+#
+# Every frame edits voxels and the density field, which queues mesh jobs, and
+# every --reload-every frames recreates the chunks while those jobs are still
+# running, then reads them while they are generating: straight from the chunks,
+# which must not crash, and through the generator queries, which must wait and
+# see the finished voxels. Once the jobs have drained, a reference generator replays the same
+# edits without that pressure: every chunk must hold the same voxels and show
+# the same mesh, or a job result was lost or applied out of order. Also exits
+# with 1 when unloaded chunk data is never freed.
+
+const WORLD_HEIGHT = 48
+# Frames in a row without jobs before the state counts as settled
+const SETTLE_FRAMES = 3
+# Chunk reads right after each reload
+const QUERIES = 64
+
+var generator: VoxelGenerator
+var reference: VoxelGenerator
+var rng = RandomNumberGenerator.new()
+var world_seed = 1234
+var frame = 0
+var frames = 600
+var edits = 200
+var reload_every = 40
+var size = 6
+var sparse = false
+var area = Vector3i()
+# Voxel edits since the chunks were last recreated, and every brush, in order
+var voxel_edits = []
+var brushes = []
+var settled_frames = 0
+
+
+func _initialize():
+	var options = parse_options(OS.get_cmdline_user_args())
+	size = int(options.get("size", "6"))
+	frames = int(options.get("frames", "600"))
+	edits = int(options.get("edits", "200"))
+	reload_every = int(options.get("reload-every", "40"))
+	world_seed = int(options.get("seed", "1234"))
+	sparse = options.has("sparse")
+	rng.seed = world_seed
+
+	generator = create_generator()
+	area = Vector3i(size * 8, WORLD_HEIGHT, size * 8)
+
+
+func _process(_delta: float) -> bool:
+	frame += 1
+	if frame > frames:
+		return drain()
+
+	for i in edits:
+		var pos = Vector3i(rng.randi_range(0, area.x - 1), rng.randi_range(0, area.y - 1), rng.randi_range(0, area.z - 1))
+		var type = rng.randi_range(0, 4)
+		generator.set_voxel_at(pos, type)
+		voxel_edits.push_back([pos, type])
+	var brush = Vector3(rng.randf_range(-1, 1), rng.randf_range(-1, 1), rng.randf_range(-1, 1))
+	generator.modify_terrain(brush, 0.3)
+	brushes.push_back(brush)
+
+	if frame % reload_every == 0:
+		# Mesh jobs of the old chunks are still queued or running
+		generator.create_chunks()
+		voxel_edits.clear()
+		if not query_while_generating():
+			return finish(false)
+	if frame % 100 == 0:
+		var stats = generator.get_generation_stats()
+		print("Frame %d: %d chunk jobs, %d retired chunk data" % [frame, stats["chunk_jobs_in_flight"], stats["retired_chunk_data"]])
+	return false
+
+
+# No more edits: the last mesh jobs end, the reference catches up, and what
+# was unloaded gets freed
+func drain() -> bool:
+	if reference == null:
+		reference = create_generator()
+		for brush in brushes:
+			reference.modify_terrain(brush, 0.3)
+		for edit in voxel_edits:
+			reference.set_voxel_at(edit[0], edit[1])
+
+	if is_idle(generator) and is_idle(reference):
+		settled_frames += 1
+	else:
+		settled_frames = 0
+	if settled_frames >= SETTLE_FRAMES:
+		if not compare_chunks():
+			return finish(false)
+		var retired = generator.get_generation_stats()["retired_chunk_data"]
+		if retired == 0:
+			return finish(true)
+	if frame > frames + 300:
+		if settled_frames < SETTLE_FRAMES:
+			printerr("Jobs never drained")
+		else:
+			printerr("%d chunk data never freed" % generator.get_generation_stats()["retired_chunk_data"])
+		return finish(false)
+	return false
+
+
+func create_generator() -> VoxelGenerator:
+	var result = VoxelGenerator.new()
+	result.debug_verbosity = 0
+	result.seeder = world_seed
+	result.world_height = WORLD_HEIGHT
+	result.generate_size = size
+	result.visualize_noise_values = false
+	result.sparse_chunks = sparse
+	# Flowing water would keep changing voxels after the edits
+	result.fluid_simulation = false
+	# Meshes stay on the chunks, where they can be compared
+	result.region_batching = false
+	root.add_child(result)
+	result.generate()
+	result.create_chunks()
+	return result
+
+
+func query_while_generating() -> bool:
+	var chunk_count = Vector3i(size, ceili(WORLD_HEIGHT / 8.0), size)
+	# No waiting here: these race the generation jobs swapping the storage
+	for i in QUERIES:
+		var chunk = generator.get_chunk(Vector3i(rng.randi_range(0, chunk_count.x - 1), rng.randi_range(0, chunk_count.y - 1), rng.randi_range(0, chunk_count.z - 1)))
+		chunk.get_voxel_type(Vector3i(rng.randi_range(0, 7), rng.randi_range(0, 7), rng.randi_range(0, 7)))
+		chunk.get_voxel_data()
+		chunk.serialize_voxels()
+
+	# The generator waits, so its answer must match the finished chunk
+	var coord = Vector3i(rng.randi_range(0, chunk_count.x - 1), rng.randi_range(0, chunk_count.y - 1), rng.randi_range(0, chunk_count.z - 1))
+	var counted = generator.count_voxels_in_box(AABB(Vector3(coord * 8), Vector3(8, 8, 8)))
+	var expected = 0
+	for type in generator.get_chunk(coord).get_voxel_data():
+		if type != 0:
+			expected += 1
+	if counted != expected:
+		printerr("Frame %d, chunk %s: counted %d voxels while generating, %d once generated" % [frame, coord, counted, expected])
+		return false
+	var column = Vector3(coord.x * 8 + 4.5, WORLD_HEIGHT + 1, coord.z * 8 + 4.5)
+	generator.raycast_voxels(column, Vector3.DOWN, INF)
+	return true
+
+
+func is_idle(target: VoxelGenerator) -> bool:
+	var stats = target.get_generation_stats()
+	return stats["chunk_jobs_in_flight"] == 0 and stats["jobs_queued"] == 0 and stats["jobs_completions_pending"] == 0
+
+
+func compare_chunks() -> bool:
+	for x in size:
+		for y in ceili(WORLD_HEIGHT / 8.0):
+			for z in size:
+				var coord = Vector3i(x, y, z)
+				var chunk = generator.get_chunk(coord)
+				var expected = reference.get_chunk(coord)
+				if chunk.get_voxel_data() != expected.get_voxel_data():
+					printerr("Chunk %s: voxels differ from the reference, an edit was lost" % coord)
+					return false
+				if get_mesh_vertices(chunk) != get_mesh_vertices(expected):
+					printerr("Chunk %s: mesh differs from the reference, a stale mesh was applied" % coord)
+					return false
+	return true
+
+
+func get_mesh_vertices(chunk: Node) -> PackedVector3Array:
+	var instance = chunk.get_node_or_null("ChunkMesh") as MeshInstance3D
+	if instance == null or instance.mesh == null or instance.mesh.get_surface_count() == 0:
+		return PackedVector3Array()
+	return instance.mesh.surface_get_arrays(0)[Mesh.ARRAY_VERTEX]
+
+
+func finish(ok: bool) -> bool:
+	print("OK" if ok else "FAILED")
+	quit(0 if ok else 1)
+	return true
+
+
+func parse_options(args: PackedStringArray) -> Dictionary:
+	var options = {}
+	for arg in args:
+		if not arg.begins_with("--"):
+			continue
+		var parts = arg.substr(2).split("=", true, 1)
+		options[parts[0]] = parts[1] if parts.size() > 1 else "true"
+	return options
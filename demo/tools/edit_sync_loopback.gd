@@ -0,0 +1,170 @@
+extends SceneTree
+
+# Checks edit sync between two generators in one process, the way a host and a
+# client would exchange deltas over the network:
+#
+#   godot --headless --path demo --script res://tools/edit_sync_loopback.gd -- \
+#       --seed=1234 --size=4 --edits=500
+#
+# The host edits voxels and the density field, the client catches up through
+# serialize_edits_since() / apply_edit_delta(), then a late joiner catches up
+# from a compacted journal. Voxels are compared where they were edited, and the
+# density field around every brush. Last, hand-made deltas with records that
+# don't fit in their chunk must be rejected whole. Exits with 1 when a world
+# differs or a malformed delta gets through.
+
+const BRUSH_RADIUS = 1.5
+# Density samples per axis across a brush
+const BRUSH_SAMPLES = 7
+
+func _init():
+	var options = parse_options(OS.get_cmdline_user_args())
+	var world_seed = int(options.get("seed", "1234"))
+	var size = int(options.get("size", "4"))
+	var edits = int(options.get("edits", "500"))
+
+	var host = create_peer(world_seed, size)
+	var client = create_peer(world_seed, size)
+	var area = Vector3i(size * 8, 48, size * 8)
+	var rng = RandomNumberGenerator.new()
+	rng.seed = world_seed
+
+	var ok = true
+	var brushes = []
+	for pass_index in 3:
+		var edited = {}
+		for i in edits:
+			var pos = Vector3i(rng.randi_range(0, area.x - 1), rng.randi_range(0, area.y - 1), rng.randi_range(0, area.z - 1))
+			host.set_voxel_at(pos, rng.randi_range(0, 4))
+			edited[pos] = true
+		var brush = Vector3(rng.randf_range(-1, 1), rng.randf_range(-1, 1), rng.randf_range(-1, 1))
+		host.modify_terrain(brush, 0.3, BRUSH_RADIUS)
+		brushes.push_back(brush)
+
+		var delta = host.serialize_edits_since(client.get_edit_versions())
+		var result = client.apply_edit_delta(delta)
+		print("Pass %d: %d edits, %d bytes for %d chunks (%d bytes of voxels), %s" % [
+				pass_index, edits, delta.size(), result["chunks"], result["chunks"] * 512, result])
+		ok = compare(host, client, edited.keys()) and ok
+		ok = compare_density(host, client, brushes) and ok
+
+	# Nothing new: only the header goes out
+	var empty = host.serialize_edits_since(client.get_edit_versions())
+	print("Up to date: %d bytes" % empty.size())
+
+	host.compact_edit_journal()
+	var late = create_peer(world_seed, size)
+	var snapshot = host.serialize_edits_since({})
+	var late_result = late.apply_edit_delta(snapshot)
+	print("Late joiner from the compacted journal: %d bytes, %s" % [snapshot.size(), late_result])
+	var all_positions = []
+	for x in area.x:
+		for y in area.y:
+			for z in area.z:
+				all_positions.push_back(Vector3i(x, y, z))
+	ok = compare(host, late, all_positions) and ok
+	ok = compare(host, client, all_positions) and ok
+	ok = compare_density(host, late, brushes) and ok
+	ok = compare_density(host, client, brushes) and ok
+	ok = check_malformed_deltas(world_seed, size) and ok
+
+	host.free()
+	client.free()
+	late.free()
+	print("OK" if ok else "FAILED")
+	quit(0 if ok else 1)
+
+
+func create_peer(world_seed: int, size: int) -> VoxelGenerator:
+	var generator = VoxelGenerator.new()
+	generator.debug_verbosity = 0
+	generator.seeder = world_seed
+	generator.world_height = 48
+	generator.generate_size = size
+	generator.fluid_simulation = false
+	generator.visualize_noise_values = false
+	generator.generate()
+	generator.create_chunks()
+	return generator
+
+
+func compare(a: VoxelGenerator, b: VoxelGenerator, positions: Array) -> bool:
+	for pos in positions:
+		if a.get_voxel_type_at(pos) != b.get_voxel_type_at(pos):
+			printerr("Voxel %s differs: %d != %d" % [pos, a.get_voxel_type_at(pos), b.get_voxel_type_at(pos)])
+			return false
+	return true
+
+
+# Replayed brushes must leave the same density field, not only the same voxels
+func compare_density(a: VoxelGenerator, b: VoxelGenerator, brushes: Array) -> bool:
+	var step = BRUSH_RADIUS * 2.0 / (BRUSH_SAMPLES - 1)
+	for brush in brushes:
+		for x in BRUSH_SAMPLES:
+			for y in BRUSH_SAMPLES:
+				for z in BRUSH_SAMPLES:
+					var pos = brush + Vector3(x, y, z) * step - Vector3.ONE * BRUSH_RADIUS
+					if a.get_density_at(pos) != b.get_density_at(pos):
+						printerr("Density at %s differs: %f != %f" % [pos, a.get_density_at(pos), b.get_density_at(pos)])
+						return false
+	return true
+
+
+func check_malformed_deltas(world_seed: int, size: int) -> bool:
+	var peer = create_peer(world_seed, size)
+	# Index 512 is one past the chunk, it would decode to (0, 8, 0) in the chunk above
+	var neighbor_type = peer.get_voxel_type_at(Vector3i(0, 8, 0))
+	var cases = [
+		["index past the chunk", voxel_record([0x80, 0x04], 0, 1), false],
+		["unknown voxel type", voxel_record([5], 0, 200), false],
+		["NaN brush radius", brush_record(Vector3(1, 1, 1), 0.3, NAN), false],
+		["infinite brush strength", brush_record(Vector3(1, 1, 1), INF, 1.5), false],
+		["huge brush radius", brush_record(Vector3(1, 1, 1), 0.3, 1e30), false],
+		["brush outside its chunk", brush_record(Vector3(20, 1, 1), 0.3, 1.5), false],
+		["valid voxel", voxel_record([5], 0, 1), true],
+	]
+	var ok = true
+	for entry in cases:
+		var result = peer.apply_edit_delta(make_delta(entry[1]))
+		if result.is_empty() == entry[2]:
+			printerr("Delta with a %s: %s" % [entry[0], "rejected" if entry[2] else "accepted"])
+			ok = false
+	if peer.get_voxel_type_at(Vector3i(0, 8, 0)) != neighbor_type:
+		printerr("A malformed delta edited the neighboring chunk")
+		ok = false
+	peer.free()
+	return ok
+
+
+# One chunk at (0, 0, 0) going from version 0 to 1, holding `record`
+func make_delta(record: PackedByteArray) -> PackedByteArray:
+	var bytes = "VXED".to_ascii_buffer()
+	bytes.append_array(PackedByteArray([1, 0, 0, 0, 1, 0, 0, 0, 0, 1, 1]))
+	bytes.append_array(record)
+	return bytes
+
+
+func voxel_record(index_varint: Array, old_type: int, new_type: int) -> PackedByteArray:
+	var record = PackedByteArray([0, 1])
+	record.append_array(PackedByteArray(index_varint))
+	record.append_array(PackedByteArray([old_type, new_type]))
+	return record
+
+
+func brush_record(point: Vector3, strength: float, radius: float) -> PackedByteArray:
+	var record = PackedByteArray([1, 1])
+	record.resize(22)
+	var values = [point.x, point.y, point.z, strength, radius]
+	for i in values.size():
+		record.encode_float(2 + i * 4, values[i])
+	return record
+
+
+func parse_options(args: PackedStringArray) -> Dictionary:
+	var options = {}
+	for arg in args:
+		if not arg.begins_with("--"):
+			continue
+		var parts = arg.substr(2).split("=", true, 1)
+		options[parts[0]] = parts[1] if parts.size() > 1 else "true"
+	return options
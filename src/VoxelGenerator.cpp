@@ -29,14 +29,31 @@
 /**************************************************************************/
 
 #include "VoxelGenerator.h"
-#include "Constants.h"
+#include "core/chunk_visibility.h"
+#include "core/epoch_reclaimer.h"
+#include "core/marching_cubes_mesher.h"
+#include "core/region_file.h"
+#include "core/voxel_constants.h"
+#include "core/voxel_material.h"
+#include "core/voxel_octree.h"
+#include "core/voxel_math.h"
+#include "core/voxel_raycast.h"
+
+#include <algorithm>
+#include <cstring>
 
 // Godot includes
+#include <godot_cpp/classes/array_mesh.hpp>
+#include <godot_cpp/classes/editor_undo_redo_manager.hpp>
 #include <godot_cpp/classes/fast_noise_lite.hpp>
+#include <godot_cpp/classes/file_access.hpp>
 #include <godot_cpp/classes/immediate_mesh.hpp>
 #include <godot_cpp/classes/mesh_instance3d.hpp>
 #include <godot_cpp/classes/standard_material3d.hpp>
 #include <godot_cpp/classes/surface_tool.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/classes/undo_redo.hpp>
+#include <godot_cpp/classes/viewport.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/color.hpp>
 #include <godot_cpp/variant/vector3.hpp>
@@ -45,6 +62,7 @@ namespace voxel_engine {
 
 void VoxelGenerator::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("generate"), &VoxelGenerator::generate);
+	ClassDB::bind_method(D_METHOD("modify_terrain", "point", "strength", "radius"), &VoxelGenerator::modify_terrain, DEFVAL(1.5f));
 
 	ClassDB::bind_method(D_METHOD("set_generate_size", "value"), &VoxelGenerator::set_generate_size);
 	ClassDB::bind_method(D_METHOD("get_generate_size"), &VoxelGenerator::get_generate_size);
@@ -62,6 +80,66 @@ void VoxelGenerator::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_auto_generate"), &VoxelGenerator::get_auto_generate);
 	ClassDB::bind_method(D_METHOD("set_seeder", "value"), &VoxelGenerator::set_seeder);
 	ClassDB::bind_method(D_METHOD("get_seeder"), &VoxelGenerator::get_seeder);
+	ClassDB::bind_method(D_METHOD("set_world_height", "value"), &VoxelGenerator::set_world_height);
+	ClassDB::bind_method(D_METHOD("get_world_height"), &VoxelGenerator::get_world_height);
+	ClassDB::bind_method(D_METHOD("set_sea_level", "value"), &VoxelGenerator::set_sea_level);
+	ClassDB::bind_method(D_METHOD("get_sea_level"), &VoxelGenerator::get_sea_level);
+	ClassDB::bind_method(D_METHOD("set_terrain_height", "value"), &VoxelGenerator::set_terrain_height);
+	ClassDB::bind_method(D_METHOD("get_terrain_height"), &VoxelGenerator::get_terrain_height);
+	ClassDB::bind_method(D_METHOD("set_sparse_chunks", "value"), &VoxelGenerator::set_sparse_chunks);
+	ClassDB::bind_method(D_METHOD("get_sparse_chunks"), &VoxelGenerator::get_sparse_chunks);
+	ClassDB::bind_method(D_METHOD("set_frustum_culling", "value"), &VoxelGenerator::set_frustum_culling);
+	ClassDB::bind_method(D_METHOD("get_frustum_culling"), &VoxelGenerator::get_frustum_culling);
+	ClassDB::bind_method(D_METHOD("set_occlusion_culling", "value"), &VoxelGenerator::set_occlusion_culling);
+	ClassDB::bind_method(D_METHOD("get_occlusion_culling"), &VoxelGenerator::get_occlusion_culling);
+	ClassDB::bind_method(D_METHOD("set_region_batching", "value"), &VoxelGenerator::set_region_batching);
+	ClassDB::bind_method(D_METHOD("get_region_batching"), &VoxelGenerator::get_region_batching);
+	ClassDB::bind_method(D_METHOD("set_region_size", "value"), &VoxelGenerator::set_region_size);
+	ClassDB::bind_method(D_METHOD("get_region_size"), &VoxelGenerator::get_region_size);
+	ClassDB::bind_method(D_METHOD("set_main_thread_budget_msec", "value"), &VoxelGenerator::set_main_thread_budget_msec);
+	ClassDB::bind_method(D_METHOD("get_main_thread_budget_msec"), &VoxelGenerator::get_main_thread_budget_msec);
+	ClassDB::bind_method(D_METHOD("set_mesher_mode", "mode"), &VoxelGenerator::set_mesher_mode);
+	ClassDB::bind_method(D_METHOD("get_mesher_mode"), &VoxelGenerator::get_mesher_mode);
+	ClassDB::bind_method(D_METHOD("set_ambient_occlusion", "value"), &VoxelGenerator::set_ambient_occlusion);
+	ClassDB::bind_method(D_METHOD("get_ambient_occlusion"), &VoxelGenerator::get_ambient_occlusion);
+	ClassDB::bind_method(D_METHOD("set_compact_vertices", "value"), &VoxelGenerator::set_compact_vertices);
+	ClassDB::bind_method(D_METHOD("get_compact_vertices"), &VoxelGenerator::get_compact_vertices);
+	ClassDB::bind_method(D_METHOD("set_voxel_textures", "textures"), &VoxelGenerator::set_voxel_textures);
+	ClassDB::bind_method(D_METHOD("get_voxel_textures"), &VoxelGenerator::get_voxel_textures);
+	ClassDB::bind_method(D_METHOD("set_mesh_simplification", "value"), &VoxelGenerator::set_mesh_simplification);
+	ClassDB::bind_method(D_METHOD("get_mesh_simplification"), &VoxelGenerator::get_mesh_simplification);
+	ClassDB::bind_method(D_METHOD("set_simplification_distance", "value"), &VoxelGenerator::set_simplification_distance);
+	ClassDB::bind_method(D_METHOD("get_simplification_distance"), &VoxelGenerator::get_simplification_distance);
+	ClassDB::bind_method(D_METHOD("set_simplification_error", "value"), &VoxelGenerator::set_simplification_error);
+	ClassDB::bind_method(D_METHOD("get_simplification_error"), &VoxelGenerator::get_simplification_error);
+	ClassDB::bind_method(D_METHOD("set_lighting", "value"), &VoxelGenerator::set_lighting);
+	ClassDB::bind_method(D_METHOD("get_lighting"), &VoxelGenerator::get_lighting);
+	ClassDB::bind_method(D_METHOD("set_fluid_simulation", "value"), &VoxelGenerator::set_fluid_simulation);
+	ClassDB::bind_method(D_METHOD("get_fluid_simulation"), &VoxelGenerator::get_fluid_simulation);
+	ClassDB::bind_method(D_METHOD("set_fluid_tick_rate", "value"), &VoxelGenerator::set_fluid_tick_rate);
+	ClassDB::bind_method(D_METHOD("get_fluid_tick_rate"), &VoxelGenerator::get_fluid_tick_rate);
+	ClassDB::bind_method(D_METHOD("set_memory_budget_mb", "value"), &VoxelGenerator::set_memory_budget_mb);
+	ClassDB::bind_method(D_METHOD("get_memory_budget_mb"), &VoxelGenerator::get_memory_budget_mb);
+	ClassDB::bind_method(D_METHOD("get_memory_stats"), &VoxelGenerator::get_memory_stats);
+	ClassDB::bind_method(D_METHOD("create_chunks"), &VoxelGenerator::create_chunks);
+	ClassDB::bind_method(D_METHOD("add_decoration", "mesh", "transform"), &VoxelGenerator::add_decoration);
+	ClassDB::bind_method(D_METHOD("clear_decorations"), &VoxelGenerator::clear_decorations);
+	ClassDB::bind_method(D_METHOD("get_batching_stats"), &VoxelGenerator::get_batching_stats);
+	ClassDB::bind_method(D_METHOD("set_voxel_at", "world_pos", "type"), &VoxelGenerator::set_voxel_at);
+	ClassDB::bind_method(D_METHOD("get_edit_version", "chunk_coord"), &VoxelGenerator::get_edit_version);
+	ClassDB::bind_method(D_METHOD("get_edit_versions"), &VoxelGenerator::get_edit_versions);
+	ClassDB::bind_method(D_METHOD("serialize_edits_since", "known_versions"), &VoxelGenerator::serialize_edits_since);
+	ClassDB::bind_method(D_METHOD("apply_edit_delta", "delta"), &VoxelGenerator::apply_edit_delta);
+	ClassDB::bind_method(D_METHOD("compact_edit_journal"), &VoxelGenerator::compact_edit_journal);
+	ClassDB::bind_method(D_METHOD("take_snapshot"), &VoxelGenerator::take_snapshot);
+	ClassDB::bind_method(D_METHOD("restore_snapshot", "snapshot"), &VoxelGenerator::restore_snapshot);
+	ClassDB::bind_method(D_METHOD("commit_undo_action", "undo_redo", "action_name", "before"), &VoxelGenerator::commit_undo_action);
+	ClassDB::bind_method(D_METHOD("update_chunk_visibility", "camera"), &VoxelGenerator::update_chunk_visibility);
+	ClassDB::bind_method(D_METHOD("get_culling_stats"), &VoxelGenerator::get_culling_stats);
+	ClassDB::bind_method(D_METHOD("get_generation_stats"), &VoxelGenerator::get_generation_stats);
+	ClassDB::bind_method(D_METHOD("bake_region", "from_chunk", "to_chunk", "path"), &VoxelGenerator::bake_region);
+	ClassDB::bind_method(D_METHOD("load_region", "path"), &VoxelGenerator::load_region);
+	ClassDB::bind_method(D_METHOD("compute_region_hash", "from_chunk", "to_chunk", "threaded"), &VoxelGenerator::compute_region_hash, DEFVAL(true));
 
 	// Bind debug methods
 	ClassDB::bind_method(D_METHOD("set_debug_mode", "enabled"), &VoxelGenerator::set_debug_mode);
@@ -73,6 +151,13 @@ void VoxelGenerator::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_debug_verbosity", "level"), &VoxelGenerator::set_debug_verbosity);
 	ClassDB::bind_method(D_METHOD("get_debug_verbosity"), &VoxelGenerator::get_debug_verbosity);
 
+	ClassDB::bind_method(D_METHOD("set_noise_slice_axis", "axis"), &VoxelGenerator::set_noise_slice_axis);
+	ClassDB::bind_method(D_METHOD("get_noise_slice_axis"), &VoxelGenerator::get_noise_slice_axis);
+	ClassDB::bind_method(D_METHOD("set_noise_slice_position", "position"), &VoxelGenerator::set_noise_slice_position);
+	ClassDB::bind_method(D_METHOD("get_noise_slice_position"), &VoxelGenerator::get_noise_slice_position);
+	ClassDB::bind_method(D_METHOD("set_noise_slice_sweep_speed", "speed"), &VoxelGenerator::set_noise_slice_sweep_speed);
+	ClassDB::bind_method(D_METHOD("get_noise_slice_sweep_speed"), &VoxelGenerator::get_noise_slice_sweep_speed);
+
 	ClassDB::bind_method(D_METHOD("debug_print_state"), &VoxelGenerator::debug_print_state);
 	ClassDB::bind_method(D_METHOD("debug_draw_noise_slice", "y_level"), &VoxelGenerator::debug_draw_noise_slice);
 	ClassDB::bind_method(D_METHOD("log_message", "message", "verbosity_level"), &VoxelGenerator::log_message, DEFVAL(1));
@@ -81,17 +166,55 @@ void VoxelGenerator::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("is_object_binding_set_by_parent_constructor"), &VoxelGenerator::is_object_binding_set_by_parent_constructor);
 
+	// Bind voxel queries
+	ClassDB::bind_method(D_METHOD("get_chunk", "chunk_coord"), &VoxelGenerator::get_chunk);
+	ClassDB::bind_method(D_METHOD("get_voxel_type_at", "world_pos"), &VoxelGenerator::get_voxel_type_at);
+	ClassDB::bind_method(D_METHOD("get_density_at", "position"), &VoxelGenerator::get_density_at);
+	ClassDB::bind_method(D_METHOD("raycast_voxels", "origin", "direction", "max_distance", "hit_liquids"), &VoxelGenerator::raycast_voxels, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("count_voxels_in_box", "box", "type"), &VoxelGenerator::count_voxels_in_box, DEFVAL(-1));
+	ClassDB::bind_method(D_METHOD("count_voxels_in_sphere", "center", "radius", "type"), &VoxelGenerator::count_voxels_in_sphere, DEFVAL(-1));
+	ClassDB::bind_method(D_METHOD("get_voxels_in_box", "box", "type"), &VoxelGenerator::get_voxels_in_box, DEFVAL(-1));
+	ClassDB::bind_method(D_METHOD("get_voxels_in_sphere", "center", "radius", "type"), &VoxelGenerator::get_voxels_in_sphere, DEFVAL(-1));
+	ClassDB::bind_method(D_METHOD("count_voxel_types_in_box", "box"), &VoxelGenerator::count_voxel_types_in_box);
+
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "generate_size", PROPERTY_HINT_RANGE, "1,100,1"), "set_generate_size", "get_generate_size");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "resolution", PROPERTY_HINT_RANGE, "1,10,1"), "set_resolution", "get_resolution");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "cutoff", PROPERTY_HINT_RANGE, "-1,1,0.1"), "set_cutoff", "get_cutoff");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "mesher_mode", PROPERTY_HINT_ENUM, "Marching Cubes,Surface Nets,Dual Contouring"), "set_mesher_mode", "get_mesher_mode");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "seeder", PROPERTY_HINT_RANGE, "0,1000000,1"), "set_seeder", "get_seeder");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "randomizer"), "set_randomizer", "get_randomizer");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "show_centers"), "set_show_centers", "get_show_centers");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "show_grid"), "set_show_grid", "get_show_grid");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "auto_generate"), "set_auto_generate", "get_auto_generate");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "world_height", PROPERTY_HINT_RANGE, "8,1024,8"), "set_world_height", "get_world_height");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "sea_level", PROPERTY_HINT_RANGE, "0,1024,1"), "set_sea_level", "get_sea_level");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "terrain_height", PROPERTY_HINT_RANGE, "0,256,0.5"), "set_terrain_height", "get_terrain_height");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "sparse_chunks"), "set_sparse_chunks", "get_sparse_chunks");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "frustum_culling"), "set_frustum_culling", "get_frustum_culling");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "occlusion_culling"), "set_occlusion_culling", "get_occlusion_culling");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "region_batching"), "set_region_batching", "get_region_batching");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "region_size", PROPERTY_HINT_RANGE, "1,16,1"), "set_region_size", "get_region_size");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "lighting"), "set_lighting", "get_lighting");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "ambient_occlusion"), "set_ambient_occlusion", "get_ambient_occlusion");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "compact_vertices"), "set_compact_vertices", "get_compact_vertices");
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "voxel_textures", PROPERTY_HINT_RESOURCE_TYPE, "Texture2DArray"), "set_voxel_textures", "get_voxel_textures");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "mesh_simplification"), "set_mesh_simplification", "get_mesh_simplification");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "simplification_distance", PROPERTY_HINT_RANGE, "0,1024,1,or_greater"), "set_simplification_distance", "get_simplification_distance");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "simplification_error", PROPERTY_HINT_RANGE, "0,2,0.01"), "set_simplification_error", "get_simplification_error");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "fluid_simulation"), "set_fluid_simulation", "get_fluid_simulation");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "fluid_tick_rate", PROPERTY_HINT_RANGE, "1,60,0.5"), "set_fluid_tick_rate", "get_fluid_tick_rate");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "memory_budget_mb", PROPERTY_HINT_RANGE, "0,65536,1,or_greater"), "set_memory_budget_mb", "get_memory_budget_mb");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "main_thread_budget_msec", PROPERTY_HINT_RANGE, "0.1,33.0,0.1"), "set_main_thread_budget_msec", "get_main_thread_budget_msec");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "debug_mode"), "set_debug_mode", "get_debug_mode");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "visualize_noise_values"), "set_visualize_noise_values", "get_visualize_noise_values");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "debug_verbosity", PROPERTY_HINT_RANGE, "0,3,1"), "set_debug_verbosity", "get_debug_verbosity");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "noise_slice_axis", PROPERTY_HINT_ENUM, "X,Y,Z"), "set_noise_slice_axis", "get_noise_slice_axis");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "noise_slice_position", PROPERTY_HINT_RANGE, "-100,100,0.01,or_greater,or_less"), "set_noise_slice_position", "get_noise_slice_position");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "noise_slice_sweep_speed", PROPERTY_HINT_RANGE, "0,20,0.1,or_greater"), "set_noise_slice_sweep_speed", "get_noise_slice_sweep_speed");
+
+	BIND_ENUM_CONSTANT(MESHER_MARCHING_CUBES);
+	BIND_ENUM_CONSTANT(MESHER_SURFACE_NETS);
+	BIND_ENUM_CONSTANT(MESHER_DUAL_CONTOURING);
 }
 
 bool VoxelGenerator::has_object_instance_binding() const {
@@ -118,6 +241,7 @@ VoxelGenerator::~VoxelGenerator() {
 		}
 	}
 	chunks.clear();
+	chunk_map.clear();
 	log_message("VoxelGenerator destroyed and chunks cleaned up.", 1);
 }
 
@@ -135,11 +259,14 @@ void VoxelGenerator::_notification(int p_what) {
 		case NOTIFICATION_READY: {
 			// Initialize Godot-specific settings now that object is fully ready
 			set_name("VoxelGenerator");
-			set_process(false);
+			// The slice sweep animates before any chunk exists
+			set_process(noise_slice_sweep_speed > 0.0f);
 			set_physics_process(false);
 			
 			remove_children();
-			randomize_seed();
+			if (randomizer) {
+				randomize_seed();
+			}
 
 			if (auto_generate) {
 				generate();
@@ -150,7 +277,22 @@ void VoxelGenerator::_notification(int p_what) {
 			}
 			break;
 		}
+		case NOTIFICATION_PROCESS: {
+			// Finished meshes first so this frame's flush picks them up
+			JobSystem::get_singleton()->drain_completions((int64_t)(main_thread_budget_msec * 1000.0f));
+			update_fluids(get_process_delta_time());
+			update_noise_slice_sweep(get_process_delta_time());
+			update_dirty_chunks(); // Also flushes the region batcher
+			if (get_viewport()) {
+				update_chunk_visibility(get_viewport()->get_camera_3d());
+			}
+			enforce_memory_budget();
+			// Chunk data unloaded while mesh jobs were reading it
+			EpochReclaimer::get_singleton()->collect();
+			break;
+		}
 		case NOTIFICATION_PREDELETE:
+			cancel_chunk_jobs();
 			// Make sure to clean up chunks when the generator is deleted
 			for (Chunk *chunk : chunks) {
 				if (chunk && is_instance_valid(chunk)) {
@@ -158,6 +300,7 @@ void VoxelGenerator::_notification(int p_what) {
 				}
 			}
 			chunks.clear();
+			chunk_map.clear();
 			break;
 		default:
 			break;
@@ -165,14 +308,19 @@ void VoxelGenerator::_notification(int p_what) {
 };
 
 void VoxelGenerator::reset() {
+	// Generation jobs hold on to the chunks
+	cancel_chunk_jobs();
 	// Clean up chunks
 	for (Chunk *chunk : chunks) {
 		memdelete(chunk); // Use memdelete for cleanup
 	}
 	chunks.clear();
+	chunk_map.clear();
 
 	remove_children();
-	randomize_seed();
+	if (randomizer) {
+		randomize_seed();
+	}
 	generate_size = 1;
 	resolution = 1;
 	cutoff = 0.1f;
@@ -197,6 +345,263 @@ bool VoxelGenerator::get_auto_generate() const {
 	return auto_generate;
 }
 
+void VoxelGenerator::set_world_height(int value) {
+	world_height = MAX(value, DEFAULT_CHUNK_SIZE);
+}
+
+int VoxelGenerator::get_world_height() const {
+	return world_height;
+}
+
+void VoxelGenerator::set_sea_level(int value) {
+	sea_level = value;
+}
+
+int VoxelGenerator::get_sea_level() const {
+	return sea_level;
+}
+
+void VoxelGenerator::set_terrain_height(float value) {
+	terrain_height = value;
+}
+
+float VoxelGenerator::get_terrain_height() const {
+	return terrain_height;
+}
+
+void VoxelGenerator::set_sparse_chunks(bool value) {
+	sparse_chunks = value;
+	for (Chunk *chunk : chunks) {
+		chunk->set_storage_mode(sparse_chunks ? Chunk::STORAGE_SPARSE : Chunk::STORAGE_DENSE);
+	}
+}
+
+bool VoxelGenerator::get_sparse_chunks() const {
+	return sparse_chunks;
+}
+
+void VoxelGenerator::set_frustum_culling(bool value) {
+	frustum_culling = value;
+}
+
+bool VoxelGenerator::get_frustum_culling() const {
+	return frustum_culling;
+}
+
+void VoxelGenerator::set_occlusion_culling(bool value) {
+	occlusion_culling = value;
+}
+
+bool VoxelGenerator::get_occlusion_culling() const {
+	return occlusion_culling;
+}
+
+void VoxelGenerator::set_region_batching(bool value) {
+	if (region_batching == value) {
+		return;
+	}
+	region_batching = value;
+	// Meshes move between the chunks and the regions on the next process tick
+	remesh_all_chunks();
+}
+
+bool VoxelGenerator::get_region_batching() const {
+	return region_batching;
+}
+
+void VoxelGenerator::set_region_size(int value) {
+	value = CLAMP(value, 1, 16);
+	if (region_size == value) {
+		return;
+	}
+	region_size = value;
+	if (region_batching) {
+		remesh_all_chunks();
+	}
+}
+
+int VoxelGenerator::get_region_size() const {
+	return region_size;
+}
+
+void VoxelGenerator::set_mesher_mode(MesherMode value) {
+	if (mesher_mode == value) {
+		return;
+	}
+	mesher_mode = value;
+	if (terrain_instance) {
+		rebuild_terrain_mesh();
+		rebuild_debug_meshes();
+	}
+}
+
+VoxelGenerator::MesherMode VoxelGenerator::get_mesher_mode() const {
+	return mesher_mode;
+}
+
+void VoxelGenerator::set_ambient_occlusion(bool value) {
+	if (ambient_occlusion == value) {
+		return;
+	}
+	ambient_occlusion = value;
+	// Baked into the vertices, so everything is meshed again
+	remesh_all_chunks();
+	if (terrain_instance) {
+		rebuild_terrain_mesh();
+	}
+}
+
+bool VoxelGenerator::get_ambient_occlusion() const {
+	return ambient_occlusion;
+}
+
+void VoxelGenerator::set_compact_vertices(bool value) {
+	if (compact_vertices == value) {
+		return;
+	}
+	compact_vertices = value;
+	if (chunks.empty()) {
+		return;
+	}
+	chunk_material = create_chunk_material();
+	for (Chunk *chunk : chunks) {
+		chunk->compact_vertices = compact_vertices;
+		chunk->set_material(chunk_material);
+	}
+	remesh_all_chunks();
+}
+
+bool VoxelGenerator::get_compact_vertices() const {
+	return compact_vertices;
+}
+
+void VoxelGenerator::set_voxel_textures(const Ref<Texture2DArray> &value) {
+	voxel_textures = value;
+	// Materials already handed out are shared, updating them is enough
+	Ref<ShaderMaterial> shader_material = chunk_material;
+	if (shader_material.is_valid()) {
+		VoxelMaterial::set_textures(shader_material, voxel_textures);
+	}
+	if (terrain_material.is_valid()) {
+		VoxelMaterial::set_textures(terrain_material, voxel_textures);
+	}
+	// The terrain switches between position colors and voxel types
+	if (terrain_instance) {
+		rebuild_terrain_mesh();
+	}
+}
+
+Ref<Texture2DArray> VoxelGenerator::get_voxel_textures() const {
+	return voxel_textures;
+}
+
+Ref<Material> VoxelGenerator::create_chunk_material() const {
+	if (compact_vertices) {
+		return VoxelMaterial::create(voxel_textures);
+	}
+	Ref<StandardMaterial3D> material;
+	material.instantiate();
+	material->set_flag(BaseMaterial3D::FLAG_ALBEDO_FROM_VERTEX_COLOR, true);
+	return material;
+}
+
+void VoxelGenerator::set_mesh_simplification(bool value) {
+	if (mesh_simplification == value) {
+		return;
+	}
+	mesh_simplification = value;
+	if (!value) {
+		// Turning it on waits for the next visibility pass, which knows the camera
+		for (Chunk *chunk : chunks) {
+			if (chunk->mesh_simplified) {
+				chunk->mesh_simplified = false;
+				dirty_chunks.insert(chunk->get_chunk_coord());
+			}
+		}
+	}
+}
+
+bool VoxelGenerator::get_mesh_simplification() const {
+	return mesh_simplification;
+}
+
+void VoxelGenerator::set_simplification_distance(float value) {
+	simplification_distance = MAX(value, 0.0f);
+}
+
+float VoxelGenerator::get_simplification_distance() const {
+	return simplification_distance;
+}
+
+void VoxelGenerator::set_simplification_error(float value) {
+	simplification_error = MAX(value, 0.0f);
+	for (Chunk *chunk : chunks) {
+		if (chunk->mesh_simplified) {
+			dirty_chunks.insert(chunk->get_chunk_coord());
+		}
+	}
+}
+
+float VoxelGenerator::get_simplification_error() const {
+	return simplification_error;
+}
+
+void VoxelGenerator::set_lighting(bool value) {
+	lighting = value;
+}
+
+bool VoxelGenerator::get_lighting() const {
+	return lighting;
+}
+
+void VoxelGenerator::set_fluid_simulation(bool value) {
+	fluid_simulation = value;
+}
+
+bool VoxelGenerator::get_fluid_simulation() const {
+	return fluid_simulation;
+}
+
+void VoxelGenerator::set_fluid_tick_rate(float value) {
+	fluid_tick_rate = CLAMP(value, 1.0f, 60.0f);
+}
+
+float VoxelGenerator::get_fluid_tick_rate() const {
+	return fluid_tick_rate;
+}
+
+void VoxelGenerator::set_memory_budget_mb(int value) {
+	memory_budget_mb = MAX(value, 0);
+	MemoryTracker::get_singleton()->set_budget((int64_t)memory_budget_mb * 1024 * 1024);
+}
+
+int VoxelGenerator::get_memory_budget_mb() const {
+	return memory_budget_mb;
+}
+
+Dictionary VoxelGenerator::get_memory_stats() const {
+	const MemoryTracker *tracker = MemoryTracker::get_singleton();
+	Dictionary stats;
+	for (int i = 0; i < MemoryTracker::CATEGORY_COUNT; ++i) {
+		const MemoryTracker::Category category = MemoryTracker::Category(i);
+		stats[MemoryTracker::get_category_name(category)] = tracker->get_usage(category);
+	}
+	stats["total"] = tracker->get_total();
+	stats["peak"] = tracker->get_peak();
+	stats["budget"] = tracker->get_budget();
+	stats["evicted_meshes"] = evicted_mesh_count;
+	stats["compressed_chunks"] = compressed_chunk_count;
+	return stats;
+}
+
+void VoxelGenerator::set_main_thread_budget_msec(float value) {
+	main_thread_budget_msec = MAX(value, 0.1f);
+}
+
+float VoxelGenerator::get_main_thread_budget_msec() const {
+	return main_thread_budget_msec;
+}
+
 void VoxelGenerator::set_generate_size(int value) {
 	generate_size = value;
 	if (auto_generate)
@@ -219,6 +624,7 @@ int VoxelGenerator::get_resolution() const {
 
 void VoxelGenerator::set_cutoff(float value) {
 	cutoff = value;
+	noise_slice.set_iso(cutoff);
 	if (auto_generate)
 		generate();
 }
@@ -228,25 +634,16 @@ float VoxelGenerator::get_cutoff() const {
 }
 
 void VoxelGenerator::set_randomizer(bool value) {
-	if (value) {
-		randomize_seed();
-		if (auto_generate)
-			generate();
-	}
+	randomizer = value;
 }
 
 bool VoxelGenerator::get_randomizer() const {
-	return true; // This is a placeholder, as the randomizer is always enabled in this implementation.
+	return randomizer;
 }
 
 void VoxelGenerator::set_show_centers(bool value) {
 	show_centers = value;
-	for (int i = 0; i < get_child_count(); ++i) {
-		MeshInstance3D *child = Object::cast_to<MeshInstance3D>(get_child(i));
-		if (child && child->get_name() == godot::StringName("MeshInstanceCenters")) {
-			child->set_visible(value);
-		}
-	}
+	rebuild_debug_meshes();
 }
 
 bool VoxelGenerator::get_show_centers() const {
@@ -255,12 +652,7 @@ bool VoxelGenerator::get_show_centers() const {
 
 void VoxelGenerator::set_show_grid(bool value) {
 	show_grid = value;
-	for (int i = 0; i < get_child_count(); ++i) {
-		MeshInstance3D *child = Object::cast_to<MeshInstance3D>(get_child(i));
-		if (child && child->get_name() == StringName("MeshInstanceCubes")) {
-			child->set_visible(value);
-		}
-	}
+	rebuild_debug_meshes();
 }
 
 void VoxelGenerator::set_seeder(int value) {
@@ -278,6 +670,18 @@ bool VoxelGenerator::get_show_grid() const {
 }
 
 void VoxelGenerator::remove_children() {
+	cancel_chunk_jobs();
+	// Chunks are children too, forget them before they are freed
+	chunks.clear();
+	chunk_map.clear();
+	chunk_grid_size = Vector3i();
+	memory_budget_stalled = false;
+	region_batcher.clear();
+	region_batcher.forget_decoration_instances();
+	terrain_instance = nullptr;
+	noise_slice.forget();
+	active_cells.clear();
+
 	while (get_child_count() > 0) {
 		Node *child = get_child(0);
 		remove_child(child);
@@ -305,183 +709,237 @@ void VoxelGenerator::generate() {
 
 	log_message("Noise generator initialized", 2);
 
-	// # Create centers mesh
-	Ref<ImmediateMesh> mesh_centers;
-	mesh_centers.instantiate();
-	mesh_centers->surface_begin(Mesh::PRIMITIVE_POINTS);
-
-	// # Create cubes mesh
-	Ref<ImmediateMesh> mesh_cubes;
-	mesh_cubes.instantiate();
-	mesh_cubes->surface_begin(Mesh::PRIMITIVE_LINES);
-
-	// # Create triangles mesh
-	Ref<ImmediateMesh> mesh_triangles;
-	mesh_triangles.instantiate();
-	mesh_triangles->surface_begin(Mesh::PRIMITIVE_TRIANGLES);
-
-	log_message("Meshes created", 2);
-
 	int start = -generate_size * resolution;
 	int end = (generate_size + 1) * resolution;
 
-	int total_cubes = (end - start) * (end - start) * (end - start);
-	int current_cube = 0;
-	int triangle_count = 0;
-
-	for (int x = start; x < end; ++x) {
-		for (int y = start; y < end; ++y) {
-			for (int z = start; z < end; ++z) {
-				current_cube++;
-				if (debug_mode && debug_verbosity >= 3) {
-					// Progress update for very verbose mode
-					if (current_cube % 1000 == 0 || current_cube == total_cubes) {
-						log_message(String("Processing cube {0}/{1} ({2}%)")
-											.format(Array::make(current_cube, total_cubes, int(100.0f * current_cube / total_cubes))),
-								3);
-					}
-				}
-
-				// Calculate the center position of the voxel
-				Vector3 center = Vector3((float)x / resolution, (float)y / resolution, (float)z / resolution);
-
-				// Get the noise value at the center position
-				float center_value = noise->get_noise_3d(center.x, center.y, center.z);
-
-				if (debug_mode && debug_verbosity >= 3) {
-					log_message(String("  Cube at {0},{1},{2}: noise={3}")
-										.format(Array::make(center.x, center.y, center.z, center_value)),
-							3);
-				}
-
-				// Create marching cube vertices
-				Vector<Vector3> cube_vertices = create_cube_vertices(center);
-
-				// Get the scalar value at the corners for the current cube
-				std::vector<float> cube_values = get_cube_values(noise, cube_vertices);
-
-				if (center_value < cutoff) {
-					add_cubes_vertices(mesh_cubes, cube_vertices);
-				} // Get the lookup index for the current cube
-				int lookup_index = get_lookup_index(cube_values, cutoff); // Bounds check to prevent crash with incomplete lookup table
-				const auto &marching_triangles = Constants::get_marching_triangles();
-				if (lookup_index >= marching_triangles.size()) {
-					if (debug_mode && debug_verbosity >= 2) {
-						log_message(String("Warning: lookup_index {0} exceeds table size {1}, skipping cube")
-											.format(Array::make(lookup_index, (int)marching_triangles.size())),
-								1);
-					}
-					continue; // Skip this cube to prevent crash
-				}
-
-				// Get triangles
-				std::vector<int> triangles(marching_triangles[lookup_index].begin(), marching_triangles[lookup_index].end());
+	// Sample every cell corner once; neighboring cells share their corners.
+	// Brick bounds are accumulated in the same pass.
+	const int point_count = end - start + 1;
+	const float spacing = 1.0f / (float)resolution;
+	density_field.create(Vector3i(point_count, point_count, point_count), Vector3(start - 0.5f, start - 0.5f, start - 0.5f) * spacing, spacing);
+	density_field.fill([&noise](const Vector3 &position) {
+		return noise->get_noise_3d(position.x, position.y, position.z);
+	});
+	tracked_density_field.set(density_field.get_memory_usage());
+	// Brushes recorded so far shaped the previous field
+	edit_journal.clear_records(EditJournal::RECORD_BRUSH);
+	tracked_edit_journal.set(edit_journal.get_memory_usage());
 
-				Color color(
-						(center.x + generate_size) / (generate_size * 2.0f),
-						(center.y + generate_size) / (generate_size * 2.0f),
-						(center.z + generate_size) / (generate_size * 2.0f));
+	log_message(String("Density field sampled: {0} points").format(Array::make(point_count * point_count * point_count)), 2);
 
-				if (triangles.size() > 1) {
-					mesh_centers->surface_set_color(color);
-					mesh_centers->surface_add_vertex(center);
-				};
+	rebuild_terrain_mesh();
+	rebuild_debug_meshes();
 
-				for (size_t index = 0; index < triangles.size(); index += 3) {
-					int point_1 = triangles[index];
-					if (point_1 == -1)
-						continue;
+	if (visualize_noise_values) {
+		log_message("Creating noise visualization", 2);
+		visualize_noise_field();
+	}
+}
 
-					int point_2 = triangles[index + 1];
-					if (point_2 == -1)
-						continue;
+void VoxelGenerator::rebuild_terrain_mesh() {
+	MeshData mesh_data;
+	active_cells.clear();
+	switch (mesher_mode) {
+		case MESHER_SURFACE_NETS:
+			DualMesher::build(density_field, cutoff, DualMesher::SURFACE_NETS, ambient_occlusion, mesh_data, &mesher_stats, &active_cells);
+			break;
+		case MESHER_DUAL_CONTOURING:
+			DualMesher::build(density_field, cutoff, DualMesher::DUAL_CONTOURING, ambient_occlusion, mesh_data, &mesher_stats, &active_cells);
+			break;
+		default:
+			MarchingCubesMesher::build(density_field, cutoff, ambient_occlusion, mesh_data, &mesher_stats, &active_cells);
+			break;
+	}
 
-					int point_3 = triangles[index + 2];
-					if (point_3 == -1)
-						continue;
+	log_message(String("Generation completed: {0} triangles created").format(Array::make((int64_t)mesher_stats.triangles)), 2);
+	log_message(String("  Cells meshed: {0}, skipped: {1} in {2} bricks")
+						.format(Array::make((int64_t)mesher_stats.cells_visited, (int64_t)mesher_stats.cells_skipped, (int64_t)mesher_stats.bricks_skipped)),
+			2);
 
-					triangle_count++;
+	const bool textured = voxel_textures.is_valid();
+	if (textured) {
+		// Voxel types by slope: flat ground is grass, slopes dirt, cliffs
+		// stone. The field has no up, so ceilings count as flat. The mesher's
+		// AO stays in the vertex colors, which the voxel shader multiplies in.
+		mesh_data.voxel_attributes.resize(mesh_data.vertices.size());
+		for (size_t i = 0; i < mesh_data.vertices.size(); ++i) {
+			const float flatness = Math::abs(mesh_data.normals[i].y);
+			const int type = flatness > 0.75f ? GRASS : (flatness > 0.4f ? DIRT : STONE);
+			mesh_data.voxel_attributes[i] = pack_voxel_material(type, make_light(MAX_LIGHT, 0), 3, false);
+		}
+	} else {
+		// Color by position inside the generated volume, shaded by the mesher's AO
+		const bool has_occlusion = mesh_data.colors.size() == mesh_data.vertices.size();
+		mesh_data.colors.resize(mesh_data.vertices.size());
+		for (size_t i = 0; i < mesh_data.vertices.size(); ++i) {
+			const Vector3 &vertex = mesh_data.vertices[i];
+			const float occlusion = has_occlusion ? mesh_data.colors[i].r : 1.0f;
+			mesh_data.colors[i] = Color(
+					occlusion * (vertex.x + generate_size) / (generate_size * 2.0f),
+					occlusion * (vertex.y + generate_size) / (generate_size * 2.0f),
+					occlusion * (vertex.z + generate_size) / (generate_size * 2.0f));
+		}
+	}
 
-					int a0 = Constants::cornerIndexAFromEdge[point_1];
-					int b0 = Constants::cornerIndexBFromEdge[point_1];
+	Ref<ArrayMesh> mesh_triangles;
+	mesh_triangles.instantiate();
+	tracked_terrain_mesh.set(mesh_data.get_memory_usage());
+	if (!mesh_data.is_empty()) {
+		mesh_triangles->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, mesh_data.to_surface_arrays(), TypedArray<Array>(), Dictionary(), mesh_data.get_surface_flags());
 
-					int a1 = Constants::cornerIndexAFromEdge[point_2];
-					int b1 = Constants::cornerIndexBFromEdge[point_2];
+		if (textured) {
+			if (terrain_material.is_null()) {
+				terrain_material = VoxelMaterial::create(voxel_textures);
+			}
+			mesh_triangles->surface_set_material(0, terrain_material);
+		} else {
+			// # Create triangles material
+			Ref<StandardMaterial3D> material_triangles;
+			material_triangles.instantiate();
+			material_triangles->set_flag(godot::BaseMaterial3D::FLAG_ALBEDO_FROM_VERTEX_COLOR, true);
+			mesh_triangles->surface_set_material(0, material_triangles);
+		}
+	}
 
-					int a2 = Constants::cornerIndexAFromEdge[point_3];
-					int b2 = Constants::cornerIndexBFromEdge[point_3];
+	// # Create triangles mesh instance and add it to the scene
+	if (terrain_instance == nullptr) {
+		terrain_instance = memnew(MeshInstance3D);
+		terrain_instance->set_name("MeshInstanceTriangles");
+		add_child(terrain_instance);
+	}
+	terrain_instance->set_mesh(mesh_triangles);
+}
 
-					Vector3 vertex1 = interpolate(cube_vertices[a0], cube_values[a0], cube_vertices[b0], cube_values[b0]);
-					Vector3 vertex2 = interpolate(cube_vertices[a1], cube_values[a1], cube_vertices[b1], cube_values[b1]);
-					Vector3 vertex3 = interpolate(cube_vertices[a2], cube_values[a2], cube_vertices[b2], cube_values[b2]);
+void VoxelGenerator::rebuild_debug_meshes() {
+	for (int i = get_child_count() - 1; i >= 0; --i) {
+		Node *child = get_child(i);
+		if (child->get_name() == StringName("MeshInstanceCenters") || child->get_name() == StringName("MeshInstanceCubes")) {
+			remove_child(child);
+			child->queue_free();
+		}
+	}
 
-					Vector3 vector_a = vertex3 - vertex1;
-					Vector3 vector_b = vertex2 - vertex1;
+	// The debug views walk the whole volume, only pay for them when shown
+	if (show_centers && !active_cells.empty()) {
+		Ref<ImmediateMesh> mesh_centers;
+		mesh_centers.instantiate();
+		mesh_centers->surface_begin(Mesh::PRIMITIVE_POINTS);
+		for (const Vector3 &center : active_cells) {
+			mesh_centers->surface_set_color(Color(
+					(center.x + generate_size) / (generate_size * 2.0f),
+					(center.y + generate_size) / (generate_size * 2.0f),
+					(center.z + generate_size) / (generate_size * 2.0f)));
+			mesh_centers->surface_add_vertex(center);
+		}
+		mesh_centers->surface_end();
+
+		// # Create centers material
+		Ref<StandardMaterial3D> material_centers;
+		material_centers.instantiate();
+		material_centers->set_flag(godot::BaseMaterial3D::FLAG_ALBEDO_FROM_VERTEX_COLOR, true);
+		material_centers->set_shading_mode(BaseMaterial3D::SHADING_MODE_UNSHADED);
+		material_centers->set_point_size(20.0);
+		mesh_centers->surface_set_material(0, material_centers);
+
+		MeshInstance3D *mi_centers = memnew(MeshInstance3D);
+		mi_centers->set_name("MeshInstanceCenters");
+		mi_centers->set_mesh(mesh_centers);
+		add_child(mi_centers);
+	}
 
-					Vector3 normal = vector_a.cross(vector_b).normalized();
+	if (show_grid) {
+		const Vector3i cells = density_field.get_cell_dims();
+		if (cells.x <= 0) {
+			return;
+		}
 
-					mesh_triangles->surface_set_color(color);
-					mesh_triangles->surface_set_normal(normal);
-					mesh_triangles->surface_add_vertex(vertex1);
-					mesh_triangles->surface_add_vertex(vertex2);
-					mesh_triangles->surface_add_vertex(vertex3);
+		// # Create cubes mesh
+		Ref<ImmediateMesh> mesh_cubes;
+		mesh_cubes.instantiate();
+		mesh_cubes->surface_begin(Mesh::PRIMITIVE_LINES);
+
+		const float half = density_field.get_spacing() * 0.5f;
+		for (int z = 0; z < cells.z; ++z) {
+			for (int y = 0; y < cells.y; ++y) {
+				for (int x = 0; x < cells.x; ++x) {
+					// Cell value taken as the mean of its corners, so edits show up too
+					float center_value = 0.0f;
+					for (int i = 0; i < 8; ++i) {
+						center_value += density_field.get(x + (i & 1), y + ((i >> 1) & 1), z + (i >> 2));
+					}
+					if (center_value * 0.125f < cutoff) {
+						add_cubes_vertices(mesh_cubes, create_cube_vertices(density_field.get_point_position(x, y, z) + Vector3(half, half, half)));
+					}
 				}
 			}
 		}
+		mesh_cubes->surface_end();
+
+		// # Create cubes material
+		Ref<StandardMaterial3D> material_cubes;
+		material_cubes.instantiate();
+		material_cubes->set_flag(godot::BaseMaterial3D::FLAG_ALBEDO_FROM_VERTEX_COLOR, true);
+		material_cubes->set_shading_mode(BaseMaterial3D::SHADING_MODE_UNSHADED);
+		mesh_cubes->surface_set_material(0, material_cubes);
+
+		MeshInstance3D *mi_cubes = memnew(MeshInstance3D);
+		mi_cubes->set_name("MeshInstanceCubes");
+		mi_cubes->set_mesh(mesh_cubes);
+		add_child(mi_cubes);
 	}
+}
 
-	log_message(String("Generation completed: {0} triangles created").format(Array::make(triangle_count)), 2);
-
-	// # End surfaces
-	mesh_centers->surface_end();
-	mesh_cubes->surface_end();
-	mesh_triangles->surface_end();
-
-	// # Create centers material
-	Ref<StandardMaterial3D> material_centers;
-	material_centers.instantiate();
-	material_centers->set_flag(godot::BaseMaterial3D::FLAG_ALBEDO_FROM_VERTEX_COLOR, true);
-	material_centers->set_shading_mode(BaseMaterial3D::SHADING_MODE_UNSHADED);
-	material_centers->set_point_size(20.0);
-
-	// # Create cubes material
-	Ref<StandardMaterial3D> material_cubes;
-	material_cubes.instantiate();
-	material_cubes->set_flag(godot::BaseMaterial3D::FLAG_ALBEDO_FROM_VERTEX_COLOR, true);
-	material_cubes->set_shading_mode(BaseMaterial3D::SHADING_MODE_UNSHADED);
-
-	// # Create triangles material
-	Ref<StandardMaterial3D> material_triangles;
-	material_triangles.instantiate();
-	material_triangles->set_flag(godot::BaseMaterial3D::FLAG_ALBEDO_FROM_VERTEX_COLOR, true);
-
-	mesh_centers->surface_set_material(0, material_centers);
-	mesh_cubes->surface_set_material(0, material_cubes);
-	mesh_triangles->surface_set_material(0, material_triangles);
-
-	// # Create mesh instance nodes and add them to the scene
-	MeshInstance3D *mi_centers = memnew(MeshInstance3D);
-	mi_centers->set_name("MeshInstanceCenters");
-	mi_centers->set_visible(show_centers);
-	mi_centers->set_mesh(mesh_centers);
-	add_child(mi_centers);
+void VoxelGenerator::modify_terrain(Vector3 point, float strength, float radius) {
+	// Peers reject larger brushes, see EditJournal::deserialize()
+	ERR_FAIL_COND_MSG(!EditJournal::is_valid_brush(point, strength, radius), "Brush is not finite or too large.");
+	if (!apply_brush(point, strength, radius)) {
+		return;
+	}
+	edit_journal.record_brush(world_to_chunk_coord(world_to_voxel(point), DEFAULT_CHUNK_SIZE), point, strength, radius);
+	tracked_edit_journal.set(edit_journal.get_memory_usage());
 
-	// # Create cubes mesh instance and add it to the scene
-	MeshInstance3D *mi_cubes = memnew(MeshInstance3D);
-	mi_cubes->set_name("MeshInstanceCubes");
-	mi_cubes->set_visible(show_grid);
-	mi_cubes->set_mesh(mesh_cubes);
-	add_child(mi_cubes);
+	rebuild_terrain_mesh();
+	if (show_centers || show_grid) {
+		rebuild_debug_meshes();
+	}
+	if (noise_slice.is_visible()) {
+		visualize_noise_field();
+	}
+}
 
-	// # Create triangles mesh instance and add it to the scene
-	MeshInstance3D *mi_triangles = memnew(MeshInstance3D);
-	mi_triangles->set_mesh(mesh_triangles);
-	add_child(mi_triangles);
+bool VoxelGenerator::apply_brush(const Vector3 &point, float strength, float radius) {
+	const Vector3i points = density_field.get_point_dims();
+	if (points.x <= 0 || radius <= 0.0f) {
+		return false;
+	}
 
-	if (visualize_noise_values) {
-		log_message("Creating noise visualization", 2);
-		visualize_noise_field();
+	// Grid range touched by the brush
+	const float spacing = density_field.get_spacing();
+	const Vector3 grid_center = (point - density_field.get_origin()) / spacing;
+	const float grid_radius = radius / spacing;
+	const Vector3i from = Vector3i((int)std::floor(grid_center.x - grid_radius), (int)std::floor(grid_center.y - grid_radius), (int)std::floor(grid_center.z - grid_radius)).clamp(Vector3i(), points - Vector3i(1, 1, 1));
+	const Vector3i to = Vector3i((int)std::ceil(grid_center.x + grid_radius), (int)std::ceil(grid_center.y + grid_radius), (int)std::ceil(grid_center.z + grid_radius)).clamp(Vector3i(), points - Vector3i(1, 1, 1));
+
+	bool changed = false;
+	for (int z = from.z; z <= to.z; ++z) {
+		for (int y = from.y; y <= to.y; ++y) {
+			for (int x = from.x; x <= to.x; ++x) {
+				const float distance = density_field.get_point_position(x, y, z).distance_to(point);
+				if (distance < radius) {
+					// Linear falloff towards the brush edge
+					density_field.set(x, y, z, density_field.get(x, y, z) + strength * (1.0f - distance / radius));
+					changed = true;
+				}
+			}
+		}
 	}
+	if (!changed) {
+		return false;
+	}
+
+	// Only the bricks under the brush and their parents are recomputed
+	density_field.update_bounds(from, to);
+	return true;
 }
 
 Vector<Vector3> VoxelGenerator::create_cube_vertices(const Vector3 &pos) {
@@ -513,36 +971,6 @@ void VoxelGenerator::add_cubes_vertices(Ref<ImmediateMesh> mesh, const Vector<Ve
 	log_message("Added cube edges to mesh", 3);
 }
 
-int VoxelGenerator::get_lookup_index(const std::vector<float> &cube_values, float cutoff) {
-	int cube_index = 0;
-	if (cube_values[0] < cutoff)
-		cube_index |= 1;
-	if (cube_values[1] < cutoff)
-		cube_index |= 2;
-	if (cube_values[2] < cutoff)
-		cube_index |= 4;
-	if (cube_values[3] < cutoff)
-		cube_index |= 8;
-	if (cube_values[4] < cutoff)
-		cube_index |= 16;
-	if (cube_values[5] < cutoff)
-		cube_index |= 32;
-	if (cube_values[6] < cutoff)
-		cube_index |= 64;
-	if (cube_values[7] < cutoff)
-		cube_index |= 128;
-
-	return cube_index;
-}
-
-std::vector<float, std::allocator<float>> VoxelGenerator::get_cube_values(godot::Ref<godot::FastNoiseLite> noise, const godot::Vector<godot::Vector3> &cube_vertices) {
-	std::vector<float, std::allocator<float>> values(8);
-	for (int i = 0; i < 8; ++i) {
-		values[i] = noise->get_noise_3d(cube_vertices[i].x, cube_vertices[i].y, cube_vertices[i].z);
-	}
-	return values;
-}
-
 void VoxelGenerator::add_cube_edges(Ref<ImmediateMesh> mesh, const std::vector<Vector3> &v) {
 	mesh->surface_add_vertex(v[0]);
 	mesh->surface_add_vertex(v[1]);
@@ -572,14 +1000,6 @@ void VoxelGenerator::add_cube_edges(Ref<ImmediateMesh> mesh, const std::vector<V
 	mesh->surface_add_vertex(v[4]);
 }
 
-Vector3 VoxelGenerator::interpolate(const Vector3 &vertex1, float value1, const Vector3 &vertex2, float value2) {
-	float t = (cutoff - value1) / (value2 - value1);
-	return Vector3(
-			vertex1.x + t * (vertex2.x - vertex1.x),
-			vertex1.y + t * (vertex2.y - vertex1.y),
-			vertex1.z + t * (vertex2.z - vertex1.z));
-}
-
 // Debug methods implementation
 void VoxelGenerator::set_debug_mode(bool p_enabled) {
 	debug_mode = p_enabled;
@@ -594,7 +1014,9 @@ bool VoxelGenerator::get_debug_mode() const {
 
 void VoxelGenerator::set_visualize_noise_values(bool p_enabled) {
 	visualize_noise_values = p_enabled;
-	if (visualize_noise_values && is_inside_tree()) {
+	if (!visualize_noise_values) {
+		noise_slice.remove();
+	} else if (is_inside_tree()) {
 		visualize_noise_field();
 	}
 }
@@ -611,6 +1033,39 @@ int VoxelGenerator::get_debug_verbosity() const {
 	return debug_verbosity;
 }
 
+void VoxelGenerator::set_noise_slice_axis(int p_axis) {
+	noise_slice_axis = CLAMP(p_axis, (int)Vector3::AXIS_X, (int)Vector3::AXIS_Z);
+	if (noise_slice.is_visible()) {
+		visualize_noise_field();
+	}
+}
+
+int VoxelGenerator::get_noise_slice_axis() const {
+	return noise_slice_axis;
+}
+
+void VoxelGenerator::set_noise_slice_position(float p_position) {
+	noise_slice_position = p_position;
+	if (noise_slice.is_visible()) {
+		visualize_noise_field();
+	}
+}
+
+float VoxelGenerator::get_noise_slice_position() const {
+	return noise_slice_position;
+}
+
+void VoxelGenerator::set_noise_slice_sweep_speed(float p_speed) {
+	noise_slice_sweep_speed = MAX(p_speed, 0.0f);
+	if (noise_slice_sweep_speed > 0.0f && is_inside_tree()) {
+		set_process(true);
+	}
+}
+
+float VoxelGenerator::get_noise_slice_sweep_speed() const {
+	return noise_slice_sweep_speed;
+}
+
 void VoxelGenerator::debug_print_state() {
 	String debug_info = "VoxelGenerator Debug Information:\n";
 	debug_info += String("- Generate Size: {0}\n").format(Array::make(generate_size));
@@ -626,73 +1081,9 @@ void VoxelGenerator::debug_print_state() {
 
 void VoxelGenerator::debug_draw_noise_slice(float y_level) {
 	log_message(String("Drawing noise slice at y={0}").format(Array::make(y_level)), 2);
-
-	// Create a new mesh for visualizing the noise slice
-
-	Ref<ImmediateMesh> slice_mesh;
-	slice_mesh.instantiate();
-	slice_mesh->surface_begin(Mesh::PRIMITIVE_TRIANGLES);
-
-	Ref<FastNoiseLite> noise;
-	noise.instantiate();
-	noise->set_seed(seeder);
-
-	int slice_resolution = resolution * 2; // Higher resolution for better visualization
-	float step = 1.0f / slice_resolution;
-	float width = generate_size * 2.0f;
-
-	for (float x = -generate_size; x < generate_size; x += step) {
-		for (float z = -generate_size; z < generate_size; z += step) {
-			float noise_val = noise->get_noise_3d(x, y_level, z);
-
-			// Normalize noise to color (blue = negative, red = positive)
-			Color color;
-			if (noise_val < cutoff) {
-				// Below cutoff - blue to cyan
-				color = Color(0, (noise_val + 1.0f) / 2.0f, 1.0f);
-			} else {
-				// Above cutoff - yellow to red
-				color = Color(1.0f, 1.0f - (noise_val - cutoff) / (1.0f - cutoff), 0);
-			}
-
-			// Draw a small quad for each sample point
-			Vector3 v1 = Vector3(x, y_level, z);
-			Vector3 v2 = Vector3(x + step, y_level, z);
-			Vector3 v3 = Vector3(x + step, y_level, z + step);
-			Vector3 v4 = Vector3(x, y_level, z + step);
-
-			// First triangle
-			slice_mesh->surface_set_color(color);
-			slice_mesh->surface_add_vertex(v1);
-			slice_mesh->surface_add_vertex(v2);
-			slice_mesh->surface_add_vertex(v3);
-
-			// Second triangle
-			slice_mesh->surface_set_color(color);
-			slice_mesh->surface_add_vertex(v1);
-			slice_mesh->surface_add_vertex(v3);
-			slice_mesh->surface_add_vertex(v4);
-		}
-	}
-
-	slice_mesh->surface_end();
-
-	// Create material
-	Ref<StandardMaterial3D> slice_material;
-	slice_material.instantiate();
-	slice_material->set_flag(godot::BaseMaterial3D::FLAG_ALBEDO_FROM_VERTEX_COLOR, true);
-	slice_material->set_shading_mode(BaseMaterial3D::SHADING_MODE_UNSHADED);
-	slice_material->set_transparency(BaseMaterial3D::TRANSPARENCY_ALPHA);
-
-	slice_mesh->surface_set_material(0, slice_material);
-
-	// Create mesh instance and add it to the scene
-	MeshInstance3D *mi_slice = memnew(MeshInstance3D);
-	mi_slice->set_name(String("NoiseSlice_Y{0}").format(Array::make(y_level)));
-	mi_slice->set_mesh(slice_mesh);
-	add_child(mi_slice);
-
-	log_message("Noise slice visualization created", 2);
+	noise_slice_axis = Vector3::AXIS_Y;
+	noise_slice_position = y_level;
+	visualize_noise_field();
 }
 
 void VoxelGenerator::log_message(const String &message, int verbosity_level) {
@@ -706,8 +1097,26 @@ void VoxelGenerator::log_message(const String &message, int verbosity_level) {
 }
 
 void VoxelGenerator::visualize_noise_field() {
-	// Create a visualization of the 3D noise field at the zero plane
-	debug_draw_noise_slice(0.0f);
+	// Sampled by generate(), nothing to show before
+	if (density_field.get_point_dims().x <= 0) {
+		return;
+	}
+	noise_slice.update(this, density_field, noise_slice_axis, noise_slice_position, cutoff);
+}
+
+void VoxelGenerator::update_noise_slice_sweep(double delta) {
+	if (noise_slice_sweep_speed <= 0.0f || !noise_slice.is_visible()) {
+		return;
+	}
+	// Bounces between the first and last layer of points
+	const float start = density_field.get_origin()[noise_slice_axis];
+	const float end = start + (density_field.get_point_dims()[noise_slice_axis] - 1) * density_field.get_spacing();
+	noise_slice_position += noise_slice_sweep_direction * noise_slice_sweep_speed * (float)delta;
+	if (noise_slice_position >= end || noise_slice_position <= start) {
+		noise_slice_position = CLAMP(noise_slice_position, start, end);
+		noise_slice_sweep_direction = -noise_slice_sweep_direction;
+	}
+	visualize_noise_field();
 }
 
 void VoxelGenerator::create_debug_visualization() {
@@ -720,7 +1129,26 @@ void VoxelGenerator::create_debug_visualization() {
 	visualize_noise_field();
 }
 
-void VoxelGenerator::create_chunks() {
+WorldGeneratorSettings VoxelGenerator::get_world_generator_settings() const {
+	WorldGeneratorSettings settings;
+	settings.seed = seeder;
+	settings.world_height = world_height;
+	settings.sea_level = sea_level;
+	settings.terrain_height = terrain_height;
+	return settings;
+}
+
+void VoxelGenerator::configure_world_generator() {
+	const WorldGeneratorSettings settings = get_world_generator_settings();
+	if (!world_generator) {
+		world_generator = std::make_unique<WorldGenerator>(settings);
+	} else {
+		world_generator->configure(settings);
+	}
+}
+
+void VoxelGenerator::create_chunks() {
+	cancel_chunk_jobs();
 	// Clear existing chunks
 	for (Chunk *chunk : chunks) {
 		if (chunk && is_instance_valid(chunk)) {
@@ -729,29 +1157,1142 @@ void VoxelGenerator::create_chunks() {
 		}
 	}
 	chunks.clear();
+	chunk_map.clear();
+	dirty_chunks.clear();
+	// Freshly generated chunks hold none of the recorded voxel edits
+	edit_journal.clear_records(EditJournal::RECORD_VOXEL);
+	tracked_edit_journal.set(edit_journal.get_memory_usage());
+	fluid_simulator.clear();
+	fluid_simulator.set_chunk_lookup([this](const Vector3i &coord) {
+		return get_chunk(coord);
+	});
+	fluid_time = 0.0;
+	region_batcher.configure(this, region_size, DEFAULT_CHUNK_SIZE);
+
+	configure_world_generator();
+	const WorldGeneratorSettings settings = get_world_generator_settings();
+
+	if (chunk_material.is_null()) {
+		chunk_material = create_chunk_material();
+	}
+
+	// Columns of chunks covering the whole world height
+	const int vertical_chunks = (world_height + DEFAULT_CHUNK_SIZE - 1) / DEFAULT_CHUNK_SIZE;
 
 	// Create new chunks properly
 	for (int x = 0; x < generate_size; x++) {
-		for (int y = 0; y < generate_size; y++) {
+		for (int y = 0; y < vertical_chunks; y++) {
 			for (int z = 0; z < generate_size; z++) {
 				Chunk *chunk = memnew(Chunk);
 				chunk->set_name(String("Chunk_{0}_{1}_{2}").format(Array::make(x, y, z)));
+				chunk->set_chunk_coord(Vector3i(x, y, z));
+				chunk->set_storage_mode(sparse_chunks ? Chunk::STORAGE_SPARSE : Chunk::STORAGE_DENSE);
+				chunk->compact_vertices = compact_vertices;
+				chunk->generator_settings = settings;
+				chunk->set_material(chunk_material);
 				add_child(chunk); // Add to scene tree first
 
 				chunks.push_back(chunk);
-				fill_chunk_with_voxels(chunk);
+				chunk_map.insert(Vector3i(x, y, z), chunk);
 			}
 		}
 	}
+	chunk_grid_size = Vector3i(generate_size, vertical_chunks, generate_size);
+
+	// Near chunks first: sorted by distance to the camera (or the middle of
+	// the world), nearest ones in the high priority class
+	Vector3 focus = Vector3(generate_size, vertical_chunks, generate_size) * 0.5f;
+	if (get_viewport() && get_viewport()->get_camera_3d()) {
+		focus = to_local(get_viewport()->get_camera_3d()->get_global_position()) / DEFAULT_CHUNK_SIZE;
+	}
+	std::vector<std::pair<float, int>> order;
+	order.reserve(chunks.size());
+	for (int i = 0; i < (int)chunks.size(); ++i) {
+		const Vector3 center = Vector3(chunks[i]->get_chunk_coord()) + Vector3(0.5f, 0.5f, 0.5f);
+		order.push_back(std::make_pair(center.distance_squared_to(focus), i));
+	}
+	std::sort(order.begin(), order.end());
+	auto get_priority = [](float distance_squared) {
+		return distance_squared < 9.0f ? JobSystem::PRIORITY_HIGH : (distance_squared < 64.0f ? JobSystem::PRIORITY_NORMAL : JobSystem::PRIORITY_LOW);
+	};
+
+	// Each job only writes its own chunk's buffer, nodes are left untouched off the main thread
+	JobSystem *job_system = JobSystem::get_singleton();
+	WorldGenerator *generator = world_generator.get();
+	std::vector<JobSystem::JobHandle> generate_jobs(chunks.size());
+	baked_chunks_loaded = 0;
+	const bool use_baked = !baked_chunks.is_empty() && baked_region_seed == seeder;
+	for (const std::pair<float, int> &entry : order) {
+		Chunk *chunk = chunks[entry.second];
+		// Baked chunks are only decoded. load_region() waits for these jobs
+		// before it replaces the file they read.
+		const RegionFileChunk *baked = use_baked ? baked_chunks.getptr(chunk->get_chunk_coord()) : nullptr;
+		const uint8_t *baked_data = baked ? baked_region.data() + baked->offset : nullptr;
+		const uint32_t baked_length = baked ? baked->length : 0;
+		baked_chunks_loaded += baked ? 1 : 0;
+		generate_jobs[entry.second] = job_system->submit([chunk, generator, baked_data, baked_length]() {
+			if (!baked_data || !chunk->deserialize_voxel_bytes(baked_data, baked_length)) {
+				chunk->generate_with(*generator);
+			}
+		}, get_priority(entry.first), {}, chunk_jobs_token);
+		chunk_jobs.push_back(generate_jobs[entry.second]);
+	}
+
+	// Light crosses chunk borders freely, it is computed in one pass once
+	// everything is generated and meshing waits for it
+	JobSystem::JobHandle light_job;
+	if (lighting) {
+		light_engine.set_chunk_lookup([this](const Vector3i &coord) {
+			return get_chunk(coord);
+		});
+		std::vector<Chunk *> chunks_to_light = chunks;
+		light_job = job_system->submit([this, chunks_to_light]() {
+			light_engine.compute_initial(chunks_to_light);
+		}, JobSystem::PRIORITY_HIGH, generate_jobs, chunk_jobs_token);
+		chunk_jobs.push_back(light_job);
+	}
+	std::vector<JobSystem::JobHandle> world_dependencies = generate_jobs;
+	world_dependencies.push_back(light_job);
+	world_ready_job = job_system->submit(std::function<void()>(), JobSystem::PRIORITY_HIGH, world_dependencies, chunk_jobs_token);
+
+	// Meshing reads the neighbors, so it waits for their generation
+	auto get_index = [&](const Vector3i &coord) {
+		if (coord.x < 0 || coord.x >= generate_size || coord.y < 0 || coord.y >= vertical_chunks || coord.z < 0 || coord.z >= generate_size) {
+			return -1;
+		}
+		return (coord.x * vertical_chunks + coord.y) * generate_size + coord.z; // Creation order above
+	};
+	for (const std::pair<float, int> &entry : order) {
+		Chunk *chunk = chunks[entry.second];
+		// Decided up front so far chunks aren't meshed twice
+		chunk->mesh_simplified = mesh_simplification && Math::sqrt(entry.first) * DEFAULT_CHUNK_SIZE > simplification_distance;
+		std::vector<JobSystem::JobHandle> dependencies;
+		if (light_job) {
+			dependencies.push_back(light_job);
+		}
+		for (int dx = -1; dx <= 1; ++dx) {
+			for (int dy = -1; dy <= 1; ++dy) {
+				for (int dz = -1; dz <= 1; ++dz) {
+					const int neighbor = get_index(chunk->get_chunk_coord() + Vector3i(dx, dy, dz));
+					if (neighbor >= 0) {
+						dependencies.push_back(generate_jobs[neighbor]);
+					}
+				}
+			}
+		}
+		submit_mesh_job(chunk, get_priority(entry.first), dependencies);
+	}
+	log_message(String("Queued {0} chunks").format(Array::make((int)chunks.size())), 2);
+
+	// Meshes are applied from _process as the jobs finish
+	set_process(true);
 }
 
-void VoxelGenerator::fill_chunk_with_voxels(Chunk *chunk) {
-	for (int x = 0; x < chunk->get_chunk_size(); ++x) {
-		for (int y = 0; y < chunk->get_chunk_size(); ++y) {
-			for (int z = 0; z < chunk->get_chunk_size(); ++z) {
-				chunk->set_voxel(Vector3i(x, y, z), VoxelType::DIRT);
+Dictionary VoxelGenerator::get_generation_stats() const {
+	Dictionary stats;
+	if (world_generator) {
+		const WorldGenerator::Stats &generator_stats = world_generator->stats;
+		stats["empty_chunks"] = (int64_t)generator_stats.empty_chunks.load();
+		stats["solid_chunks"] = (int64_t)generator_stats.solid_chunks.load();
+		stats["mixed_chunks"] = (int64_t)generator_stats.mixed_chunks.load();
+		stats["noise_samples_3d"] = (int64_t)generator_stats.noise_samples_3d.load();
+	}
+	int64_t storage_bytes = 0;
+	for (const Chunk *chunk : chunks) {
+		storage_bytes += chunk->get_storage_memory_usage();
+	}
+	stats["chunk_storage_bytes"] = storage_bytes;
+	// Last marching cubes pass
+	stats["mc_cells_visited"] = (int64_t)mesher_stats.cells_visited;
+	stats["mc_cells_skipped"] = (int64_t)mesher_stats.cells_skipped;
+	stats["mc_bricks_skipped"] = (int64_t)mesher_stats.bricks_skipped;
+	stats["mc_triangles"] = (int64_t)mesher_stats.triangles;
+	stats["mc_kernel"] = String(MarchingCubesMesher::get_kernel_name());
+	// Shared job system, counts include other users
+	const JobSystem *job_system = JobSystem::get_singleton();
+	stats["job_threads"] = job_system->get_thread_count();
+	stats["jobs_queued"] = job_system->get_queued_job_count();
+	stats["jobs_completions_pending"] = job_system->get_pending_completion_count();
+	stats["chunk_jobs_in_flight"] = (int)chunk_jobs.size();
+	stats["retired_chunk_data"] = EpochReclaimer::get_singleton()->get_retired_count();
+	stats["baked_chunks"] = (int64_t)baked_chunks.size();
+	stats["baked_chunks_loaded"] = baked_chunks_loaded;
+	stats["light_last_update_visits"] = light_engine.get_last_update_visits();
+	stats["fluid_active_cells"] = fluid_simulator.get_active_cell_count();
+	stats["fluid_ticks"] = (int64_t)fluid_simulator.get_tick_count();
+	int simplified_chunks = 0;
+	for (const Chunk *chunk : chunks) {
+		simplified_chunks += chunk->mesh_simplified ? 1 : 0;
+	}
+	stats["simplified_chunks"] = simplified_chunks;
+	stats["simplification_removed_triangles"] = simplification_removed_triangles;
+	stats["edit_journal_chunks"] = (int64_t)edit_journal.get_chunk_count();
+	stats["edit_journal_records"] = (int64_t)edit_journal.get_record_count();
+	stats["edit_journal_snapshot_entries"] = (int64_t)edit_journal.get_snapshot_entry_count();
+	return stats;
+}
+
+int64_t VoxelGenerator::compute_region_hash(Vector3i from_chunk, Vector3i to_chunk, bool threaded) {
+	if (!world_generator) {
+		configure_world_generator();
+	}
+	// Columns are recomputed too, a cache filled by another run proves nothing
+	world_generator->clear_column_cache();
+
+	std::vector<Vector3i> coords;
+	for (int x = from_chunk.x; x <= to_chunk.x; ++x) {
+		for (int y = from_chunk.y; y <= to_chunk.y; ++y) {
+			for (int z = from_chunk.z; z <= to_chunk.z; ++z) {
+				coords.push_back(Vector3i(x, y, z));
 			}
 		}
 	}
+	std::vector<uint64_t> hashes(coords.size());
+	const WorldGenerator *generator = world_generator.get();
+	auto generate_and_hash = [generator, &coords, &hashes](size_t i) {
+		VoxelBuffer buffer;
+		generator->generate_chunk(coords[i], DEFAULT_CHUNK_SIZE, buffer);
+		hashes[i] = hash_chunk_voxels(coords[i], buffer);
+	};
+
+	if (threaded) {
+		// Reverse order on purpose, the result must not depend on it
+		JobSystem *job_system = JobSystem::get_singleton();
+		std::vector<JobSystem::JobHandle> jobs;
+		for (size_t i = coords.size(); i-- > 0;) {
+			jobs.push_back(job_system->submit([&generate_and_hash, i]() {
+				generate_and_hash(i);
+			}));
+		}
+		job_system->wait_all(jobs);
+	} else {
+		for (size_t i = 0; i < coords.size(); ++i) {
+			generate_and_hash(i);
+		}
+	}
+
+	return (int64_t)hash_region(hashes);
+}
+
+uint64_t VoxelGenerator::hash_chunk_voxels(const Vector3i &chunk_coord, const VoxelBuffer &buffer) {
+	uint64_t hash = hash_coords(0, chunk_coord.x, chunk_coord.y, chunk_coord.z);
+	const uint8_t *voxels = buffer.ptr();
+	const int count = DEFAULT_CHUNK_SIZE * DEFAULT_CHUNK_SIZE * DEFAULT_CHUNK_SIZE;
+	for (int v = 0; v < count; v += 8) {
+		uint64_t word;
+		memcpy(&word, voxels + v, sizeof(word));
+		hash = hash_mix64(hash ^ word);
+	}
+	return hash;
+}
+
+uint64_t VoxelGenerator::hash_region(const std::vector<uint64_t> &chunk_hashes) {
+	uint64_t region_hash = hash_mix64((uint64_t)chunk_hashes.size());
+	for (uint64_t hash : chunk_hashes) {
+		region_hash = hash_mix64(region_hash ^ hash);
+	}
+	return region_hash;
+}
+
+Dictionary VoxelGenerator::bake_region(Vector3i from_chunk, Vector3i to_chunk, const String &path) {
+	Dictionary result;
+	Ref<FileAccess> file = FileAccess::open(path, FileAccess::WRITE);
+	ERR_FAIL_COND_V_MSG(file.is_null(), result, "Can't open " + path + " for writing.");
+
+	// A generator of its own, live chunk jobs keep using the current one
+	const WorldGenerator generator(get_world_generator_settings());
+	std::vector<Vector3i> coords;
+	for (int x = from_chunk.x; x <= to_chunk.x; ++x) {
+		for (int y = from_chunk.y; y <= to_chunk.y; ++y) {
+			for (int z = from_chunk.z; z <= to_chunk.z; ++z) {
+				coords.push_back(Vector3i(x, y, z));
+			}
+		}
+	}
+
+	const uint64_t start_usec = Time::get_singleton()->get_ticks_usec();
+	std::vector<uint8_t> bytes;
+	RegionFileHeader header;
+	header.chunk_size = DEFAULT_CHUNK_SIZE;
+	header.seed = seeder;
+	header.chunk_count = (uint32_t)coords.size();
+	write_region_header(header, bytes);
+	int64_t total_bytes = 0;
+
+	// Batches bound the memory held by serialized chunks waiting to be written
+	const size_t BATCH_SIZE = 4096;
+	JobSystem *job_system = JobSystem::get_singleton();
+	std::vector<std::vector<uint8_t>> serialized;
+	for (size_t batch_start = 0; batch_start < coords.size(); batch_start += BATCH_SIZE) {
+		const size_t batch_end = MIN(batch_start + BATCH_SIZE, coords.size());
+		serialized.assign(batch_end - batch_start, std::vector<uint8_t>());
+		std::vector<JobSystem::JobHandle> jobs;
+		for (size_t i = batch_start; i < batch_end; ++i) {
+			jobs.push_back(job_system->submit([&generator, &coords, &serialized, batch_start, i]() {
+				VoxelBuffer buffer;
+				generator.generate_chunk(coords[i], DEFAULT_CHUNK_SIZE, buffer);
+				VoxelOctree tree;
+				tree.from_buffer(buffer);
+				serialized[i - batch_start] = tree.serialize();
+			}, JobSystem::PRIORITY_LOW));
+		}
+		job_system->wait_all(jobs);
+
+		for (size_t i = batch_start; i < batch_end; ++i) {
+			write_region_chunk(coords[i], serialized[i - batch_start], bytes);
+		}
+		PackedByteArray data;
+		data.resize(bytes.size());
+		memcpy(data.ptrw(), bytes.data(), bytes.size());
+		file->store_buffer(data);
+		total_bytes += (int64_t)bytes.size();
+		bytes.clear();
+	}
+	file->close();
+
+	const double seconds = MAX((Time::get_singleton()->get_ticks_usec() - start_usec) / 1000000.0, 1e-6);
+	result["chunks"] = (int64_t)coords.size();
+	result["bytes"] = total_bytes;
+	result["seconds"] = seconds;
+	result["chunks_per_second"] = coords.size() / seconds;
+	result["mb_per_second"] = total_bytes / (1024.0 * 1024.0) / seconds;
+	// Raw voxel volume generated, before the octree compression
+	result["voxel_mb_per_second"] = coords.size() * (double)(DEFAULT_CHUNK_SIZE * DEFAULT_CHUNK_SIZE * DEFAULT_CHUNK_SIZE) / (1024.0 * 1024.0) / seconds;
+	log_message(String("Baked {0} chunks to {1} in {2} s").format(Array::make((int64_t)coords.size(), path, seconds)), 1);
+	return result;
+}
+
+Dictionary VoxelGenerator::load_region(const String &path) {
+	Dictionary result;
+	const PackedByteArray file = FileAccess::get_file_as_bytes(path);
+	ERR_FAIL_COND_V_MSG(file.is_empty(), result, "Can't read " + path + ".");
+	const uint64_t start_usec = Time::get_singleton()->get_ticks_usec();
+
+	std::vector<uint8_t> bytes(file.size());
+	memcpy(bytes.data(), file.ptr(), bytes.size());
+	RegionFileHeader header;
+	std::vector<RegionFileChunk> index;
+	ERR_FAIL_COND_V_MSG(!read_region_file(bytes.data(), bytes.size(), header, index), result, path + " is not a region file this version can read.");
+	ERR_FAIL_COND_V_MSG(header.chunk_size != DEFAULT_CHUNK_SIZE, result, "Region file chunks don't match the chunk size.");
+	ERR_FAIL_COND_V_MSG(header.seed != seeder, result, String("Region file was baked with seed {0}, not {1}.").format(Array::make(header.seed, seeder)));
+
+	// Every chunk must decode, and its voxels are hashed the way
+	// compute_region_hash() does, in file order
+	std::vector<uint64_t> hashes(index.size());
+	std::vector<uint8_t> valid(index.size(), 0);
+	JobSystem *job_system = JobSystem::get_singleton();
+	std::vector<JobSystem::JobHandle> jobs;
+	const uint8_t *data = bytes.data();
+	for (size_t i = 0; i < index.size(); ++i) {
+		jobs.push_back(job_system->submit([data, &index, &hashes, &valid, i]() {
+			VoxelOctree tree;
+			if (!tree.deserialize(data + index[i].offset, index[i].length, DEFAULT_CHUNK_SIZE)) {
+				return;
+			}
+			VoxelBuffer buffer;
+			tree.to_buffer(buffer);
+			hashes[i] = hash_chunk_voxels(index[i].coord, buffer);
+			valid[i] = 1;
+		}));
+	}
+	job_system->wait_all(jobs);
+	for (size_t i = 0; i < index.size(); ++i) {
+		ERR_FAIL_COND_V_MSG(!valid[i], result, String("Chunk {0} of the region file is invalid.").format(Array::make(index[i].coord)));
+	}
+
+	// Generation jobs may still be reading the previous file
+	wait_for_world();
+	baked_region = std::move(bytes);
+	baked_chunks.clear();
+	for (const RegionFileChunk &chunk : index) {
+		baked_chunks.insert(chunk.coord, chunk);
+	}
+	baked_region_seed = header.seed;
+	tracked_baked_region.set((int64_t)baked_region.size());
+
+	result["chunks"] = (int64_t)index.size();
+	result["bytes"] = (int64_t)baked_region.size();
+	result["hash"] = (int64_t)hash_region(hashes);
+	result["seconds"] = MAX((Time::get_singleton()->get_ticks_usec() - start_usec) / 1000000.0, 1e-6);
+	log_message(String("Loaded {0} baked chunks from {1}").format(Array::make((int64_t)index.size(), path)), 1);
+	return result;
+}
+
+JobSystem::JobHandle VoxelGenerator::submit_mesh_job(Chunk *chunk, JobSystem::Priority priority, const std::vector<JobSystem::JobHandle> &dependencies) {
+	struct Result {
+		MeshData mesh;
+		FaceConnectivity connectivity;
+		MeshSimplifier::Stats simplifier_stats;
+	};
+	std::shared_ptr<Result> result = std::make_shared<Result>();
+	const uint32_t revision = ++chunk->mesh_revision;
+	// Negative skips the simplification
+	const float max_error = chunk->mesh_simplified ? simplification_error : -1.0f;
+
+	// Looked up now: the job only sees ChunkData, never the nodes, the chunk
+	// map or the generator, so none of them has to outlive it
+	std::array<const ChunkData *, 27> neighborhood;
+	for (int i = 0; i < 27; ++i) {
+		const Chunk *neighbor = i == 13 ? chunk : get_chunk(chunk->get_chunk_coord() + Vector3i(i / 9 - 1, (i / 3) % 3 - 1, i % 3 - 1));
+		neighborhood[i] = neighbor ? neighbor->voxel_data : nullptr;
+	}
+	const int size = chunk->get_chunk_size();
+	const bool light = lighting;
+	const bool ao = ambient_occlusion;
+	const bool compact = chunk->compact_vertices;
+	const JobSystem::CancellationToken token = chunk_jobs_token;
+
+	JobSystem::JobHandle job = JobSystem::get_singleton()->submit(
+			[neighborhood, size, light, ao, compact, token, result, max_error]() {
+				// Pinned before looking at the token: chunks unloaded from now on
+				// cancel it first, those unloaded before keep their data for us
+				EpochReclaimer::Guard guard;
+				if (token && token->load()) {
+					return;
+				}
+				VoxelBuffer padded;
+				VoxelBuffer padded_light;
+				fill_chunk_padding(neighborhood, size, padded, light ? &padded_light : nullptr);
+				Chunk::build_mesh_data(padded, light ? &padded_light : nullptr, ao, compact, result->mesh, result->connectivity);
+				if (max_error >= 0.0f) {
+					// Border vertices stay, whatever detail the neighbors are meshed at
+					MeshSimplifier::simplify(result->mesh, max_error, AABB(Vector3(), Vector3(size, size, size)), &result->simplifier_stats);
+				}
+			},
+			priority, dependencies, chunk_jobs_token,
+			[this, chunk, result, revision]() {
+				if (chunk->mesh_revision != revision) {
+					return; // A newer rebuild of this chunk is on its way
+				}
+				simplification_removed_triangles += result->simplifier_stats.triangles_before - result->simplifier_stats.triangles_after;
+				chunk->set_face_connectivity(result->connectivity);
+				submit_chunk_mesh(chunk, result->mesh);
+				chunk->mesh_evicted = false;
+			});
+	chunk_jobs.push_back(job);
+	return job;
+}
+
+void VoxelGenerator::cancel_chunk_jobs() {
+	if (chunk_jobs_token) {
+		// Queued jobs are skipped, the running ones have to finish: generation
+		// jobs write through a raw Chunk pointer, light jobs through the light
+		// engine. Callers free chunks right after this returns.
+		chunk_jobs_token->store(true);
+		JobSystem::get_singleton()->wait_all(chunk_jobs);
+		if (world_ready_job) {
+			JobSystem::get_singleton()->wait(world_ready_job);
+		}
+	}
+	chunk_jobs.clear();
+	chunk_jobs_token = JobSystem::make_token();
+}
+
+void VoxelGenerator::fill_chunk_padding(const std::array<const ChunkData *, 27> &neighborhood, int size, VoxelBuffer &r_padded, VoxelBuffer *r_padded_light) {
+	const ChunkData *center = neighborhood[13];
+	{
+		RWSpinLock::ReadGuard guard(center->lock);
+		center->fill_padded_buffer(size, r_padded);
+		if (r_padded_light) {
+			center->fill_padded_light(size, *r_padded_light);
+		}
+	}
+
+	// The shell, one box per neighbor: along each axis the last layer of the
+	// chunk below, the whole chunk or the first layer of the one above
+	for (int i = 0; i < 27; ++i) {
+		const ChunkData *neighbor = neighborhood[i];
+		if (i == 13 || neighbor == nullptr) {
+			continue;
+		}
+		const Vector3i n(i / 9, (i / 3) % 3, i % 3);
+		Vector3i from;
+		Vector3i to;
+		for (int axis = 0; axis < 3; ++axis) {
+			from[axis] = n[axis] == 0 ? 0 : (n[axis] == 1 ? 1 : size + 1);
+			to[axis] = n[axis] == 0 ? 0 : (n[axis] == 1 ? size : size + 1);
+		}
+		// Padded position minus this, the neighbor's local position
+		const Vector3i offset = Vector3i(1, 1, 1) + (n - Vector3i(1, 1, 1)) * size;
+
+		RWSpinLock::ReadGuard guard(neighbor->lock);
+		for (int y = from.y; y <= to.y; ++y) {
+			for (int z = from.z; z <= to.z; ++z) {
+				for (int x = from.x; x <= to.x; ++x) {
+					const Vector3i local = Vector3i(x, y, z) - offset;
+					r_padded.set(x, y, z, (uint8_t)neighbor->get_voxel_type(local));
+					if (r_padded_light) {
+						r_padded_light->set(x, y, z, neighbor->light.get(local.x, local.y, local.z));
+					}
+				}
+			}
+		}
+	}
+}
+
+void VoxelGenerator::update_dirty_chunks() {
+	// A remesh while the world is generating would mesh air, and its newer
+	// revision would discard the mesh create_chunks() queued
+	std::vector<JobSystem::JobHandle> dependencies;
+	if (!dirty_chunks.is_empty() && world_ready_job && !JobSystem::get_singleton()->is_finished(world_ready_job)) {
+		dependencies.push_back(world_ready_job);
+	}
+	for (const Vector3i &coord : dirty_chunks) {
+		Chunk *chunk = get_chunk(coord);
+		if (chunk) {
+			// Octrees grow with edits, fluid levels appear
+			chunk->update_memory_tracking();
+			// Edits are what the player looks at, they go first
+			submit_mesh_job(chunk, JobSystem::PRIORITY_HIGH, dependencies);
+		}
+	}
+	dirty_chunks.clear();
+	// Only the regions of the remeshed chunks are merged again
+	region_batcher.flush();
+
+	chunk_jobs.erase(std::remove_if(chunk_jobs.begin(), chunk_jobs.end(), [](const JobSystem::JobHandle &job) {
+		return JobSystem::get_singleton()->is_finished(job);
+	}),
+			chunk_jobs.end());
+}
+
+void VoxelGenerator::update_fluids(double delta) {
+	// Chunks are still being written by the generation jobs until this is done
+	if (!fluid_simulation || !world_ready_job || !JobSystem::get_singleton()->is_finished(world_ready_job)) {
+		return;
+	}
+	const double step = 1.0 / fluid_tick_rate;
+	// A long frame catches up a little, not with a burst of ticks
+	fluid_time = MIN(fluid_time + delta, step * 2.0);
+	while (fluid_time >= step) {
+		fluid_time -= step;
+		std::vector<FluidSimulator::Change> changes;
+		fluid_simulator.tick(changes, dirty_chunks);
+		if (lighting) {
+			for (const FluidSimulator::Change &change : changes) {
+				light_engine.on_voxel_changed(change.world_pos, change.old_type, change.new_type);
+			}
+			light_engine.take_changed_chunks(dirty_chunks);
+		}
+	}
+}
+
+void VoxelGenerator::wait_for_world() const {
+	if (world_ready_job && !JobSystem::get_singleton()->is_finished(world_ready_job)) {
+		JobSystem::get_singleton()->wait(world_ready_job);
+	}
+}
+
+void VoxelGenerator::set_voxel_at(Vector3i world_pos, int type) {
+	ERR_FAIL_INDEX(type, VOXEL_TYPE_COUNT);
+	wait_for_world();
+	int old_type = 0;
+	if (apply_voxel_edit(world_pos, type, old_type)) {
+		edit_journal.record_voxel(world_to_chunk_coord(world_pos, DEFAULT_CHUNK_SIZE),
+				EditJournal::get_voxel_index(world_to_local_pos(world_pos, DEFAULT_CHUNK_SIZE), DEFAULT_CHUNK_SIZE),
+				(uint8_t)old_type, (uint8_t)type);
+		tracked_edit_journal.set(edit_journal.get_memory_usage());
+	}
+}
+
+bool VoxelGenerator::apply_voxel_edit(const Vector3i &world_pos, int type, int &r_old_type) {
+	const Vector3i coord = world_to_chunk_coord(world_pos, DEFAULT_CHUNK_SIZE);
+	Chunk *chunk = get_chunk(coord);
+	if (!chunk) {
+		return false;
+	}
+	const Vector3i local = world_to_local_pos(world_pos, DEFAULT_CHUNK_SIZE);
+	const int old_type = chunk->get_voxel_type(local);
+	r_old_type = old_type;
+	chunk->set_voxel(local, type);
+	dirty_chunks.insert(coord);
+
+	if (lighting && old_type != type) {
+		light_engine.on_voxel_changed(world_pos, old_type, type);
+		light_engine.take_changed_chunks(dirty_chunks);
+	}
+	if (old_type != type) {
+		fluid_simulator.on_voxel_set(world_pos);
+	}
+
+	// Neighbors sharing the edited border also see it through their padding
+	for (int axis = 0; axis < 3; ++axis) {
+		if (local[axis] == 0 || local[axis] == DEFAULT_CHUNK_SIZE - 1) {
+			Vector3i offset;
+			offset[axis] = local[axis] == 0 ? -1 : 1;
+			if (get_chunk(coord + offset)) {
+				dirty_chunks.insert(coord + offset);
+			}
+		}
+	}
+	return old_type != type;
+}
+
+int VoxelGenerator::get_edit_version(Vector3i chunk_coord) const {
+	return (int)edit_journal.get_version(chunk_coord);
+}
+
+Dictionary VoxelGenerator::get_edit_versions() const {
+	HashMap<Vector3i, uint32_t> versions;
+	edit_journal.get_versions(versions);
+	Dictionary result;
+	for (const KeyValue<Vector3i, uint32_t> &entry : versions) {
+		result[entry.key] = (int64_t)entry.value;
+	}
+	return result;
+}
+
+PackedByteArray VoxelGenerator::serialize_edits_since(const Dictionary &known_versions) const {
+	HashMap<Vector3i, uint32_t> known;
+	const Array keys = known_versions.keys();
+	for (int i = 0; i < keys.size(); ++i) {
+		if (keys[i].get_type() == Variant::VECTOR3I) {
+			known.insert(keys[i], (uint32_t)MAX((int64_t)known_versions[keys[i]], (int64_t)0));
+		}
+	}
+	std::vector<uint8_t> bytes;
+	edit_journal.serialize_since(known, bytes);
+
+	PackedByteArray result;
+	result.resize((int64_t)bytes.size());
+	memcpy(result.ptrw(), bytes.data(), bytes.size());
+	return result;
+}
+
+Dictionary VoxelGenerator::apply_edit_delta(const PackedByteArray &delta) {
+	std::vector<EditJournal::ChunkDelta> chunk_deltas;
+	if (!EditJournal::deserialize(delta.ptr(), (size_t)delta.size(), DEFAULT_CHUNK_SIZE, chunk_deltas)) {
+		log_message("apply_edit_delta: malformed delta", 1);
+		return Dictionary();
+	}
+	wait_for_world();
+
+	int chunk_count = 0;
+	int voxel_count = 0;
+	int brush_count = 0;
+	TypedArray<Vector3i> gaps;
+	std::vector<EditJournal::Record> records;
+	for (const EditJournal::ChunkDelta &chunk_delta : chunk_deltas) {
+		records.clear();
+		if (!edit_journal.merge(chunk_delta, records)) {
+			gaps.push_back(chunk_delta.coord);
+			continue;
+		}
+		chunk_count += records.empty() ? 0 : 1;
+		const Vector3i origin = chunk_delta.coord * DEFAULT_CHUNK_SIZE;
+		for (const EditJournal::Record &record : records) {
+			if (record.type == EditJournal::RECORD_VOXEL) {
+				int old_type = 0;
+				apply_voxel_edit(origin + EditJournal::get_voxel_position(record.index, DEFAULT_CHUNK_SIZE), record.new_type, old_type);
+				voxel_count++;
+			} else if (apply_brush(record.point, record.strength, record.radius)) {
+				brush_count++;
+			}
+		}
+	}
+	tracked_edit_journal.set(edit_journal.get_memory_usage());
+
+	// One remesh for all the brushes
+	if (brush_count > 0) {
+		rebuild_terrain_mesh();
+		if (show_centers || show_grid) {
+			rebuild_debug_meshes();
+		}
+		if (noise_slice.is_visible()) {
+			visualize_noise_field();
+		}
+	}
+
+	Dictionary result;
+	result["chunks"] = chunk_count;
+	result["voxels"] = voxel_count;
+	result["brushes"] = brush_count;
+	result["gaps"] = gaps;
+	return result;
+}
+
+void VoxelGenerator::compact_edit_journal() {
+	edit_journal.compact();
+	tracked_edit_journal.set(edit_journal.get_memory_usage());
 }
+
+Ref<VoxelSnapshot> VoxelGenerator::take_snapshot() {
+	wait_for_world();
+	Ref<VoxelSnapshot> snapshot;
+	snapshot.instantiate();
+	for (const Chunk *chunk : chunks) {
+		snapshot->capture(*chunk);
+	}
+	return snapshot;
+}
+
+void VoxelGenerator::restore_snapshot(const Ref<VoxelSnapshot> &snapshot) {
+	ERR_FAIL_COND(snapshot.is_null());
+	wait_for_world();
+	std::vector<std::pair<Vector3i, uint8_t>> changes;
+	for (const KeyValue<Vector3i, VoxelSnapshot::ChunkState> &entry : snapshot->get_chunks()) {
+		Chunk *chunk = get_chunk(entry.key);
+		if (!chunk || chunk->get_chunk_size() != DEFAULT_CHUNK_SIZE) {
+			continue;
+		}
+		changes.clear();
+		VoxelSnapshot::for_each_difference(entry.value, *chunk, [&changes](const Vector3i &local_pos, uint8_t type) {
+			changes.push_back(std::make_pair(local_pos, type));
+		});
+		const Vector3i origin = entry.key * DEFAULT_CHUNK_SIZE;
+		for (const std::pair<Vector3i, uint8_t> &change : changes) {
+			set_voxel_at(origin + change.first, change.second);
+		}
+		// Same voxels as the snapshot again: share its buffer rather than keep a copy
+		if (!entry.value.sparse && chunk->get_storage_mode() == Chunk::STORAGE_DENSE) {
+			RWSpinLock::WriteGuard guard(chunk->voxel_data->lock);
+			chunk->buffer = entry.value.buffer;
+		}
+	}
+}
+
+void VoxelGenerator::commit_undo_action(Object *undo_redo, const String &action_name, const Ref<VoxelSnapshot> &before) {
+	ERR_FAIL_COND(before.is_null());
+	const Ref<VoxelSnapshot> after = take_snapshot();
+	before->remove_unchanged(*after.ptr());
+	if (after->get_chunk_count() == 0) {
+		return;
+	}
+
+	// The edits are already made, committing doesn't run them again
+	if (UndoRedo *runtime_undo_redo = Object::cast_to<UndoRedo>(undo_redo)) {
+		runtime_undo_redo->create_action(action_name);
+		runtime_undo_redo->add_do_method(callable_mp(this, &VoxelGenerator::restore_snapshot).bind(after));
+		runtime_undo_redo->add_undo_method(callable_mp(this, &VoxelGenerator::restore_snapshot).bind(before));
+		runtime_undo_redo->commit_action(false);
+	} else if (EditorUndoRedoManager *editor_undo_redo = Object::cast_to<EditorUndoRedoManager>(undo_redo)) {
+		editor_undo_redo->create_action(action_name, UndoRedo::MERGE_DISABLE, this);
+		editor_undo_redo->add_do_method(this, "restore_snapshot", after);
+		editor_undo_redo->add_undo_method(this, "restore_snapshot", before);
+		editor_undo_redo->commit_action(false);
+	} else {
+		ERR_FAIL_MSG("commit_undo_action() needs an UndoRedo or an EditorUndoRedoManager.");
+	}
+}
+
+// Set in Chunk::cull_entered_faces above the 6 face bits
+static const uint8_t CULL_OUTSIDE_FRUSTUM = 1 << Direction::COUNT;
+
+void VoxelGenerator::update_chunk_visibility(Camera3D *camera) {
+	if (!camera || chunks.empty()) {
+		return;
+	}
+	cull_frame++;
+
+	const TypedArray<Plane> frustum = camera->get_frustum();
+	Plane planes[6];
+	const int plane_count = MIN((int)frustum.size(), 6);
+	for (int i = 0; i < plane_count; ++i) {
+		planes[i] = frustum[i];
+	}
+	const Transform3D transform = get_global_transform();
+	auto in_frustum = [&](const Chunk *chunk) {
+		if (!frustum_culling) {
+			return true;
+		}
+		const int size = chunk->get_chunk_size();
+		const AABB box = transform.xform(AABB(Vector3(chunk->get_chunk_coord() * size), Vector3(size, size, size)));
+		return !is_aabb_outside_planes(box, planes, plane_count);
+	};
+
+	const Vector3 camera_local = to_local(camera->get_global_position());
+	update_mesh_simplification(camera_local);
+	Chunk *start = get_chunk(world_to_chunk_coord(world_to_voxel(camera_local), DEFAULT_CHUNK_SIZE));
+
+	visible_chunk_count = 0;
+	frustum_culled_count = 0;
+
+	// Outside the loaded area there is no chunk to flood from, fall back to frustum only
+	if (!occlusion_culling || !start) {
+		region_batcher.begin_visibility_pass();
+		for (Chunk *chunk : chunks) {
+			const bool visible = in_frustum(chunk);
+			apply_chunk_visibility(chunk, visible);
+			frustum_culled_count += visible ? 0 : 1;
+		}
+		region_batcher.end_visibility_pass();
+		return;
+	}
+
+	// Breadth first walk away from the camera. A chunk is entered through one
+	// face and may only be left through faces its connectivity links to it.
+	// Steps never go back toward the camera, which keeps the walk conservative
+	// without looping. Chunks reached through a new face are walked again.
+	struct Step {
+		Chunk *chunk;
+		int entry_face; // -1 for the camera chunk
+		uint8_t directions; // Directions taken so far
+	};
+	std::vector<Step> queue;
+	queue.push_back({ start, -1, 0 });
+	start->cull_frame = cull_frame;
+	start->cull_entered_faces = 0x3F;
+
+	for (size_t head = 0; head < queue.size(); ++head) {
+		const Step step = queue[head];
+		const FaceConnectivity &connectivity = step.chunk->get_face_connectivity();
+		for (int d = 0; d < Direction::COUNT; ++d) {
+			const Direction::Value direction = Direction::Value(d);
+			if (step.directions & (1 << Direction::get_opposite(direction))) {
+				continue;
+			}
+			if (step.entry_face >= 0 && !connectivity.connects(step.entry_face, d)) {
+				continue;
+			}
+			Chunk *next = get_chunk(step.chunk->get_chunk_coord() + Direction::get_direction_vector(direction));
+			if (!next) {
+				continue;
+			}
+			const int entry_face = Direction::get_opposite(direction);
+			if (next->cull_frame != cull_frame) {
+				if (!in_frustum(next)) {
+					frustum_culled_count++;
+					// Remember the test, the chunk stays hidden this frame
+					next->cull_frame = cull_frame;
+					next->cull_entered_faces = CULL_OUTSIDE_FRUSTUM;
+					continue;
+				}
+				next->cull_frame = cull_frame;
+				next->cull_entered_faces = 0;
+			}
+			if (next->cull_entered_faces & (CULL_OUTSIDE_FRUSTUM | (1 << entry_face))) {
+				continue;
+			}
+			next->cull_entered_faces |= 1 << entry_face;
+			queue.push_back({ next, entry_face, (uint8_t)(step.directions | (1 << d)) });
+		}
+	}
+
+	region_batcher.begin_visibility_pass();
+	for (Chunk *chunk : chunks) {
+		apply_chunk_visibility(chunk, chunk->cull_frame == cull_frame && !(chunk->cull_entered_faces & CULL_OUTSIDE_FRUSTUM));
+	}
+	region_batcher.end_visibility_pass();
+}
+
+void VoxelGenerator::apply_chunk_visibility(Chunk *chunk, bool visible) {
+	if (!visible && chunk->is_cull_visible()) {
+		// Its mesh can be evicted now
+		memory_budget_stalled = false;
+	}
+	chunk->set_cull_visible(visible);
+	if (visible) {
+		chunk->last_visible_frame = cull_frame;
+		visible_chunk_count++;
+		if (chunk->mesh_evicted) {
+			chunk->mesh_evicted = false;
+			dirty_chunks.insert(chunk->get_chunk_coord());
+		}
+		region_batcher.mark_chunk_visible(chunk->get_chunk_coord());
+	}
+}
+
+void VoxelGenerator::update_mesh_simplification(const Vector3 &camera_local) {
+	if (!mesh_simplification) {
+		return;
+	}
+	for (Chunk *chunk : chunks) {
+		const int size = chunk->get_chunk_size();
+		const Vector3 center = (Vector3(chunk->get_chunk_coord()) + Vector3(0.5f, 0.5f, 0.5f)) * size;
+		const float distance = center.distance_to(camera_local);
+		// A chunk of slack so one standing on the threshold isn't remeshed every frame
+		const bool simplified = chunk->mesh_simplified ? distance > simplification_distance - size : distance > simplification_distance;
+		if (simplified == chunk->mesh_simplified) {
+			continue;
+		}
+		chunk->mesh_simplified = simplified;
+		// An evicted mesh picks the flag up when it is rebuilt
+		if (!chunk->mesh_evicted) {
+			dirty_chunks.insert(chunk->get_chunk_coord());
+		}
+	}
+}
+
+void VoxelGenerator::enforce_memory_budget() {
+	MemoryTracker *tracker = MemoryTracker::get_singleton();
+	// Waits until no chunk job is in flight. Mesh jobs alone would be fine, they
+	// copy under the shared lock with an epoch pinned, but generation jobs hold
+	// raw Chunk pointers and choose the storage mode before locking: switching
+	// it under them would drop their voxels.
+	if (!tracker->is_over_budget() || !chunk_jobs.empty()) {
+		return;
+	}
+	if (memory_budget_stalled && tracker->get_total() <= memory_budget_stalled_total) {
+		return;
+	}
+	// Stop a little under the budget so it doesn't run again next frame
+	const int64_t target = tracker->get_budget() - tracker->get_budget() / 10;
+
+	Vector3 focus;
+	if (get_viewport() && get_viewport()->get_camera_3d()) {
+		focus = to_local(get_viewport()->get_camera_3d()->get_global_position()) / DEFAULT_CHUNK_SIZE;
+	}
+	// Least recently shown first, farthest first among those
+	std::vector<std::pair<std::pair<uint32_t, float>, Chunk *>> order;
+	order.reserve(chunks.size());
+	for (Chunk *chunk : chunks) {
+		const Vector3 center = Vector3(chunk->get_chunk_coord()) + Vector3(0.5f, 0.5f, 0.5f);
+		order.push_back(std::make_pair(std::make_pair(chunk->last_visible_frame, -center.distance_squared_to(focus)), chunk));
+	}
+	std::sort(order.begin(), order.end(), [](const auto &a, const auto &b) {
+		return a.first < b.first;
+	});
+
+	for (const auto &entry : order) {
+		if (tracker->get_total() <= target) {
+			break;
+		}
+		Chunk *chunk = entry.second;
+		// Hidden chunks give their mesh back, it is rebuilt when they show up again
+		if (!chunk->is_cull_visible() && !chunk->mesh_evicted) {
+			if (region_batching) {
+				region_batcher.remove_chunk(chunk->get_chunk_coord());
+			} else {
+				chunk->apply_mesh(MeshData());
+			}
+			chunk->mesh_evicted = true;
+			evicted_mesh_count++;
+		}
+		if (chunk->get_storage_mode() == Chunk::STORAGE_DENSE) {
+			chunk->set_storage_mode(Chunk::STORAGE_SPARSE);
+			compressed_chunk_count++;
+		}
+	}
+	// Merged regions shrink once rebuilt without the evicted chunks
+	region_batcher.flush();
+
+	// Visible meshes and sparse storage are all that is left, sorting again
+	// next frame would find nothing more
+	memory_budget_stalled = tracker->get_total() > target;
+	memory_budget_stalled_total = tracker->get_total();
+}
+
+void VoxelGenerator::submit_chunk_mesh(Chunk *chunk, const MeshData &mesh) {
+	if (region_batching) {
+		// The region owns the geometry, the chunk keeps no instance of its own
+		region_batcher.set_chunk_mesh(chunk->get_chunk_coord(), chunk->get_material(), mesh);
+		chunk->apply_mesh(MeshData());
+	} else {
+		chunk->apply_mesh(mesh);
+	}
+}
+
+void VoxelGenerator::remesh_all_chunks() {
+	region_batcher.configure(this, region_size, DEFAULT_CHUNK_SIZE);
+	for (Chunk *chunk : chunks) {
+		dirty_chunks.insert(chunk->get_chunk_coord());
+	}
+}
+
+void VoxelGenerator::add_decoration(const Ref<Mesh> &mesh, Transform3D transform) {
+	region_batcher.add_decoration(mesh, transform);
+}
+
+void VoxelGenerator::clear_decorations() {
+	region_batcher.clear_decorations();
+}
+
+Dictionary VoxelGenerator::get_batching_stats() const {
+	Dictionary stats;
+	stats["region_batching"] = region_batching;
+	stats["regions"] = region_batcher.get_region_count();
+	// Without batching every chunk draws itself, the batcher only holds decorations
+	stats["draw_calls"] = region_batcher.get_draw_call_count() + (region_batching ? 0 : (int)chunks.size());
+	stats["decoration_instances"] = region_batcher.get_decoration_instance_count();
+	return stats;
+}
+
+Dictionary VoxelGenerator::get_culling_stats() const {
+	Dictionary stats;
+	stats["chunks"] = (int)chunks.size();
+	stats["visible"] = visible_chunk_count;
+	stats["frustum_culled"] = frustum_culled_count;
+	stats["occlusion_culled"] = (int)chunks.size() - visible_chunk_count - frustum_culled_count;
+	return stats;
+}
+
+Chunk *VoxelGenerator::get_chunk(Vector3i chunk_coord) const {
+	Chunk *const *chunk = chunk_map.getptr(chunk_coord);
+	return chunk ? *chunk : nullptr;
+}
+
+int VoxelGenerator::get_voxel_type_at(Vector3i world_pos) const {
+	wait_for_world();
+	const Chunk *chunk = get_chunk(world_to_chunk_coord(world_pos, DEFAULT_CHUNK_SIZE));
+	if (!chunk) {
+		return VoxelType::AIR;
+	}
+	return chunk->get_voxel_type(world_to_local_pos(world_pos, DEFAULT_CHUNK_SIZE));
+}
+
+float VoxelGenerator::get_density_at(Vector3 position) const {
+	if (density_field.get_point_dims().x <= 0) {
+		return 0.0f;
+	}
+	return density_field.sample_trilinear(position);
+}
+
+Dictionary VoxelGenerator::raycast_voxels(Vector3 origin, Vector3 direction, float max_distance, bool hit_liquids) const {
+	wait_for_world();
+	// Remember the last chunk, consecutive steps almost always stay inside it
+	Vector3i cached_coord;
+	const Chunk *cached_chunk = nullptr;
+	bool cache_valid = false;
+
+	auto sample = [&](const Vector3i &world_pos) -> int {
+		const Vector3i coord = world_to_chunk_coord(world_pos, DEFAULT_CHUNK_SIZE);
+		if (!cache_valid || coord != cached_coord) {
+			cached_coord = coord;
+			cached_chunk = get_chunk(coord);
+			cache_valid = true;
+		}
+		if (!cached_chunk) {
+			return VoxelType::AIR;
+		}
+		return cached_chunk->get_voxel_type(world_pos - coord * DEFAULT_CHUNK_SIZE);
+	};
+	auto is_hit = [hit_liquids](int type) {
+		return type != VoxelType::AIR && (hit_liquids || !is_voxel_type_liquid(type));
+	};
+
+	// Past the loaded chunks there is only air, and the walk would never end
+	// for an infinite max_distance
+	Dictionary result;
+	float enter = 0.0f;
+	float exit = 0.0f;
+	if (!ray_box_range(origin, direction, Vector3(), Vector3(chunk_grid_size * DEFAULT_CHUNK_SIZE), enter, exit)) {
+		result["hit"] = false;
+		return result;
+	}
+	const VoxelRaycastHit hit = voxel_raycast(origin, direction, MIN(max_distance, exit), sample, is_hit);
+
+	result["hit"] = hit.hit;
+	if (hit.hit) {
+		result["position"] = hit.position;
+		result["previous_position"] = hit.previous_position;
+		result["face"] = (int)hit.face;
+		result["normal"] = Direction::get_direction_vector(hit.face);
+		result["distance"] = hit.distance;
+		result["point"] = origin + direction.normalized() * hit.distance;
+		result["type"] = hit.type;
+	}
+	return result;
+}
+
+template <typename F>
+void VoxelGenerator::for_each_voxel_in_box(const Vector3i &from, const Vector3i &to, F &&fn) const {
+	// Walk chunk by chunk so the map lookup happens once per chunk, not per voxel
+	const int size = DEFAULT_CHUNK_SIZE;
+	const Vector3i chunk_from = world_to_chunk_coord(from, size);
+	const Vector3i chunk_to = world_to_chunk_coord(to, size);
+
+	for (int cx = chunk_from.x; cx <= chunk_to.x; ++cx) {
+		for (int cy = chunk_from.y; cy <= chunk_to.y; ++cy) {
+			for (int cz = chunk_from.z; cz <= chunk_to.z; ++cz) {
+				const Chunk *chunk = get_chunk(Vector3i(cx, cy, cz));
+				if (!chunk) {
+					continue;
+				}
+				const Vector3i base = Vector3i(cx, cy, cz) * size;
+				const Vector3i lo(MAX(from.x - base.x, 0), MAX(from.y - base.y, 0), MAX(from.z - base.z, 0));
+				const Vector3i hi(MIN(to.x - base.x, size - 1), MIN(to.y - base.y, size - 1), MIN(to.z - base.z, size - 1));
+
+				// Sparse chunks hand out whole uniform regions without per-voxel lookups
+				chunk->for_each_voxel_in_box(lo, hi, [&](const Vector3i &local, uint8_t type) {
+					fn(base + local, (int)type);
+				});
+			}
+		}
+	}
+}
+
+template <typename F>
+void VoxelGenerator::for_each_voxel_in_sphere(const Vector3 &center, float radius, F &&fn) const {
+	if (radius < 0.0f) {
+		return;
+	}
+	const Vector3 extent(radius, radius, radius);
+	const Vector3i from = world_to_voxel(center - extent);
+	const Vector3i to = world_to_voxel(center + extent);
+	const float radius_squared = radius * radius;
+
+	for_each_voxel_in_box(from, to, [&](const Vector3i &world_pos, int type) {
+		// Voxels count as inside when their center is
+		const Vector3 voxel_center = Vector3(world_pos) + Vector3(0.5f, 0.5f, 0.5f);
+		if ((voxel_center - center).length_squared() <= radius_squared) {
+			fn(world_pos, type);
+		}
+	});
+}
+
+// A type filter of -1 matches every non-air voxel
+static inline bool voxel_type_matches(int type, int filter) {
+	return filter < 0 ? type != VoxelType::AIR : type == filter;
+}
+
+int VoxelGenerator::count_voxels_in_box(AABB box, int type) const {
+	wait_for_world();
+	Vector3i from, to;
+	aabb_to_voxel_range(box, from, to);
+	int count = 0;
+	for_each_voxel_in_box(from, to, [&](const Vector3i &, int voxel_type) {
+		count += voxel_type_matches(voxel_type, type) ? 1 : 0;
+	});
+	return count;
+}
+
+int VoxelGenerator::count_voxels_in_sphere(Vector3 center, float radius, int type) const {
+	wait_for_world();
+	int count = 0;
+	for_each_voxel_in_sphere(center, radius, [&](const Vector3i &, int voxel_type) {
+		count += voxel_type_matches(voxel_type, type) ? 1 : 0;
+	});
+	return count;
+}
+
+TypedArray<Vector3i> VoxelGenerator::get_voxels_in_box(AABB box, int type) const {
+	wait_for_world();
+	Vector3i from, to;
+	aabb_to_voxel_range(box, from, to);
+	TypedArray<Vector3i> result;
+	for_each_voxel_in_box(from, to, [&](const Vector3i &world_pos, int voxel_type) {
+		if (voxel_type_matches(voxel_type, type)) {
+			result.push_back(world_pos);
+		}
+	});
+	return result;
+}
+
+TypedArray<Vector3i> VoxelGenerator::get_voxels_in_sphere(Vector3 center, float radius, int type) const {
+	wait_for_world();
+	TypedArray<Vector3i> result;
+	for_each_voxel_in_sphere(center, radius, [&](const Vector3i &world_pos, int voxel_type) {
+		if (voxel_type_matches(voxel_type, type)) {
+			result.push_back(world_pos);
+		}
+	});
+	return result;
+}
+
+PackedInt32Array VoxelGenerator::count_voxel_types_in_box(AABB box) const {
+	wait_for_world();
+	Vector3i from, to;
+	aabb_to_voxel_range(box, from, to);
+	PackedInt32Array counts;
+	counts.resize(VOXEL_TYPE_COUNT);
+	counts.fill(0);
+	int32_t *counts_ptr = counts.ptrw();
+	for_each_voxel_in_box(from, to, [&](const Vector3i &, int voxel_type) {
+		if (voxel_type >= 0 && voxel_type < VOXEL_TYPE_COUNT) {
+			counts_ptr[voxel_type]++;
+		}
+	});
+	return counts;
+}
+
 } // namespace voxel_engine
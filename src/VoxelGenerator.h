@@ -12,15 +12,45 @@
 #endif
 
 #include "core/chunk.h"
+#include "core/chunk_data.h"
+#include "core/density_field.h"
+#include "core/dual_mesher.h"
+#include "core/edit_journal.h"
+#include "core/field_slice_visualizer.h"
+#include "core/fluid_simulator.h"
+#include "core/marching_cubes_mesher.h"
+#include "core/job_system.h"
+#include "core/light_engine.h"
+#include "core/memory_tracker.h"
+#include "core/mesh_simplifier.h"
+#include "core/mesh_data.h"
+#include "core/region_batcher.h"
+#include "core/region_file.h"
 #include "core/voxel.h"
+#include "core/voxel_snapshot.h"
+#include "core/world_generator.h"
 
+#include <array>
+#include <memory>
+
+#include <godot_cpp/classes/camera3d.hpp>
 #include <godot_cpp/classes/fast_noise_lite.hpp>
 #include <godot_cpp/classes/immediate_mesh.hpp>
 #include <godot_cpp/classes/mesh_instance3d.hpp>
 #include <godot_cpp/classes/node3d.hpp>
+#include <godot_cpp/classes/shader_material.hpp>
+#include <godot_cpp/classes/texture2d_array.hpp>
 #include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/hash_set.hpp>
+#include <godot_cpp/variant/aabb.hpp>
 #include <godot_cpp/variant/color.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
 #include <godot_cpp/variant/vector3.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
 
 using namespace godot;
 
@@ -29,6 +59,14 @@ namespace voxel_engine {
 class VoxelGenerator : public Node3D {
 	GDCLASS(VoxelGenerator, Node3D)
 
+public:
+	// Surface extraction for the density field terrain, see DualMesher
+	enum MesherMode {
+		MESHER_MARCHING_CUBES,
+		MESHER_SURFACE_NETS,
+		MESHER_DUAL_CONTOURING
+	};
+
 private:
 	int generate_size = 1;
 	int resolution = 1;
@@ -36,15 +74,104 @@ private:
 	bool show_centers = false;
 	bool show_grid = false;
 	int seeder = 1;
+	bool randomizer = false; // Pick a new seed on ready and reset, off keeps worlds reproducible
 	bool auto_generate = false;
 
+	// World generation properties
+	int world_height = DEFAULT_WORLD_HEIGHT;
+	int sea_level = 64;
+	float terrain_height = 32.0f;
+	bool sparse_chunks = false; // Octree storage for chunks, see Chunk::StorageMode
+	std::unique_ptr<WorldGenerator> world_generator;
+
 	// Debug properties
 	bool debug_mode = true;
 	bool visualize_noise_values = true;
 	int debug_verbosity = 1;
+	// Slice of the density field shown by visualize_noise_values
+	int noise_slice_axis = Vector3::AXIS_Y;
+	float noise_slice_position = 0.0f;
+	float noise_slice_sweep_speed = 0.0f; // Units per second, bouncing across the field
+	float noise_slice_sweep_direction = 1.0f;
+	FieldSliceVisualizer noise_slice;
+
+	// Sampled noise behind the terrain mesh, kept for edits
+	DensityField density_field;
+	MesherMode mesher_mode = MESHER_MARCHING_CUBES;
+	MarchingCubesMesher::Stats mesher_stats;
+	std::vector<Vector3> active_cells;
+	MeshInstance3D *terrain_instance = nullptr;
+	Ref<ShaderMaterial> terrain_material; // Textured terrain, see voxel_textures
+	TrackedBytes tracked_density_field{ MemoryTracker::CATEGORY_VOXELS };
+	TrackedBytes tracked_terrain_mesh{ MemoryTracker::CATEGORY_MESHES };
+
+	// Chunk culling, run every frame once chunks exist
+	bool frustum_culling = true;
+	bool occlusion_culling = true;
+	uint32_t cull_frame = 0;
+	int visible_chunk_count = 0;
+	int frustum_culled_count = 0;
+	Ref<Material> chunk_material;
+	// Merges static chunk meshes into region_size^3 batches when enabled
+	bool region_batching = false;
+	int region_size = 4;
+	RegionBatcher region_batcher;
+	HashSet<Vector3i> dirty_chunks;
+	// Chunk generation and meshing jobs in flight, all cancelled together
+	// before the chunks they point to are freed
+	JobSystem::CancellationToken chunk_jobs_token;
+	std::vector<JobSystem::JobHandle> chunk_jobs;
+	float main_thread_budget_msec = 4.0f;
+	// Chunks farther than the distance (in voxels) from the camera get their
+	// mesh decimated in the mesh job, see MeshSimplifier
+	bool mesh_simplification = false;
+	float simplification_distance = 96.0f;
+	float simplification_error = 0.05f;
+	int64_t simplification_removed_triangles = 0;
+	// Sky and block light baked into the chunk vertex colors
+	bool lighting = true;
+	// Per vertex AO from the neighboring voxels (blocky) or the field (marching cubes)
+	bool ambient_occlusion = true;
+	// Chunk meshes in the packed vertex format, drawn with VoxelMaterial
+	bool compact_vertices = true;
+	// One layer per voxel type, for VoxelMaterial. Also textures the density
+	// field terrain, which is colored by position without it.
+	Ref<Texture2DArray> voxel_textures;
+	LightEngine light_engine;
+	// Water and lava flow at a fixed rate once the world is generated
+	bool fluid_simulation = true;
+	float fluid_tick_rate = 8.0f;
+	double fluid_time = 0.0;
+	FluidSimulator fluid_simulator;
+	JobSystem::JobHandle world_ready_job; // Finishes with generation and the initial light
+	// Over the budget, far and long unseen chunks get compressed and lose
+	// their meshes. 0 means no budget. Shared by every generator.
+	int memory_budget_mb = 0;
+	int evicted_mesh_count = 0;
+	int compressed_chunk_count = 0;
+	// Nothing left to evict at this total: the budget isn't enforced again
+	// until memory grows past it or a chunk gets hidden
+	bool memory_budget_stalled = false;
+	int64_t memory_budget_stalled_total = 0;
+	// Voxel edits and terrain brushes since the world was generated, for
+	// sending to peers, see EditJournal
+	EditJournal edit_journal;
+	TrackedBytes tracked_edit_journal{ MemoryTracker::CATEGORY_VOXELS };
+	// Region file read by load_region() and its chunks by coordinate, for the
+	// seed it was baked with
+	std::vector<uint8_t> baked_region;
+	HashMap<Vector3i, RegionFileChunk> baked_chunks;
+	int baked_region_seed = 0;
+	int baked_chunks_loaded = 0; // By the last create_chunks()
+	TrackedBytes tracked_baked_region{ MemoryTracker::CATEGORY_VOXELS };
 
 	// Add a container for chunks, e.g.:
 	std::vector<Chunk *> chunks; 
+	// Chunk lookup by grid coordinate, used by voxel queries
+	HashMap<Vector3i, Chunk *> chunk_map;
+	// Size of the chunk grid create_chunks() fills from (0, 0, 0), zero when
+	// there are no chunks. Bounds ray walks, nothing is loaded outside.
+	Vector3i chunk_grid_size;
 
 	const bool object_instance_binding_set_by_parent_constructor;
 	bool has_object_instance_binding() const;
@@ -67,6 +194,9 @@ public:
 	void set_cutoff(float value);
 	float get_cutoff() const;
 
+	void set_mesher_mode(MesherMode value);
+	MesherMode get_mesher_mode() const;
+
 	void set_randomizer(bool value);
 	bool get_randomizer() const;
 
@@ -82,9 +212,134 @@ public:
 	void set_auto_generate(bool value);
 	bool get_auto_generate() const;
 
+	void set_world_height(int value);
+	int get_world_height() const;
+
+	void set_sea_level(int value);
+	int get_sea_level() const;
+
+	void set_terrain_height(float value);
+	float get_terrain_height() const;
+
+	void set_sparse_chunks(bool value);
+	bool get_sparse_chunks() const;
+
+	void set_frustum_culling(bool value);
+	bool get_frustum_culling() const;
+
+	void set_occlusion_culling(bool value);
+	bool get_occlusion_culling() const;
+
+	void set_region_batching(bool value);
+	bool get_region_batching() const;
+
+	void set_region_size(int value);
+	int get_region_size() const;
+
+	void set_ambient_occlusion(bool value);
+	bool get_ambient_occlusion() const;
+
+	// Switches the default chunk material along with the format
+	void set_compact_vertices(bool value);
+	bool get_compact_vertices() const;
+
+	void set_voxel_textures(const Ref<Texture2DArray> &value);
+	Ref<Texture2DArray> get_voxel_textures() const;
+
+	void set_mesh_simplification(bool value);
+	bool get_mesh_simplification() const;
+
+	void set_simplification_distance(float value);
+	float get_simplification_distance() const;
+
+	void set_simplification_error(float value);
+	float get_simplification_error() const;
+
+	// Takes effect on the next create_chunks()
+	void set_lighting(bool value);
+	bool get_lighting() const;
+
+	void set_fluid_simulation(bool value);
+	bool get_fluid_simulation() const;
+
+	// Fluid steps per second
+	void set_fluid_tick_rate(float value);
+	float get_fluid_tick_rate() const;
+
+	void set_memory_budget_mb(int value);
+	int get_memory_budget_mb() const;
+	// Bytes per MemoryTracker category, total, peak, budget and eviction counts
+	Dictionary get_memory_stats() const;
+
+	// Time the main thread may spend per frame applying finished jobs
+	void set_main_thread_budget_msec(float value);
+	float get_main_thread_budget_msec() const;
+
 	void reset();
 
 	void generate();
+	// Adds `strength` (fading out to `radius`) to the field around `point`, in
+	// local space, and remeshes. Only the touched bricks' bounds are recomputed.
+	void modify_terrain(Vector3 point, float strength, float radius = 1.5f);
+
+	// Create the chunk nodes and run the generation pipeline on them in parallel
+	void create_chunks();
+	Dictionary get_generation_stats() const;
+	// Generates the chunks from `from_chunk` to `to_chunk` (inclusive) into
+	// scratch buffers and hashes their voxels in coordinate order. Threaded and
+	// single threaded runs must agree, that is what makes chunks cacheable.
+	int64_t compute_region_hash(Vector3i from_chunk, Vector3i to_chunk, bool threaded = true);
+	// Generates the chunks from `from_chunk` to `to_chunk` (inclusive) on every
+	// core and writes them to a region file (see region_file.h). Needs no chunk
+	// nodes, so it runs headless. Returns the throughput.
+	Dictionary bake_region(Vector3i from_chunk, Vector3i to_chunk, const String &path);
+	// Reads a region file written by bake_region() with this seed. From then
+	// on create_chunks() loads the chunks it holds instead of generating them.
+	// Returns the chunk count and a hash of the stored voxels, which matches
+	// compute_region_hash() over the baked range when the other world
+	// settings match too. Empty when the file can't be used.
+	Dictionary load_region(const String &path);
+	// What compute_region_hash() and load_region() hash per chunk, and over
+	// the chunks in coordinate order
+	static uint64_t hash_chunk_voxels(const Vector3i &chunk_coord, const VoxelBuffer &buffer);
+	static uint64_t hash_region(const std::vector<uint64_t> &chunk_hashes);
+
+	// Sets a voxel in the loaded chunks and queues the affected meshes for rebuild
+	void set_voxel_at(Vector3i world_pos, int type);
+
+	// Edit sync between peers generating the same world. Versions are per chunk,
+	// a delta holds the edits of every chunk newer than in `known_versions`
+	// (chunk coord -> version, missing chunks count as 0).
+	int get_edit_version(Vector3i chunk_coord) const;
+	Dictionary get_edit_versions() const;
+	PackedByteArray serialize_edits_since(const Dictionary &known_versions) const;
+	// Applies the edits this generator doesn't have yet. Returns the applied
+	// counts and, under "gaps", the chunks the delta started too late for,
+	// which have to be requested again. Empty on a malformed delta.
+	Dictionary apply_edit_delta(const PackedByteArray &delta);
+	// Folds every chunk's history into the latest type per edited voxel
+	void compact_edit_journal();
+
+	// Undo for voxel edits. A snapshot shares every chunk's voxels (copy on
+	// write), restoring it applies the differences as regular edits, so light,
+	// fluids and the edit journal follow.
+	Ref<VoxelSnapshot> take_snapshot();
+	void restore_snapshot(const Ref<VoxelSnapshot> &snapshot);
+	// Registers the edits made since `before` as one action of `undo_redo`, an
+	// UndoRedo or the editor's EditorUndoRedoManager. `before` and the state
+	// after are trimmed to the chunks that changed, so each undo level costs
+	// memory in proportion to its edit.
+	void commit_undo_action(Object *undo_redo, const String &action_name, const Ref<VoxelSnapshot> &before);
+	// Shows the chunks the camera can see: frustum test plus a flood fill through
+	// the chunks' face connectivity, starting from the camera's chunk
+	void update_chunk_visibility(Camera3D *camera);
+	Dictionary get_culling_stats() const;
+
+	// Instances of a repeated mesh, drawn through one MultiMesh per mesh. They
+	// stay across create_chunks() and batching changes until clear_decorations()
+	void add_decoration(const Ref<Mesh> &mesh, Transform3D transform);
+	void clear_decorations();
+	Dictionary get_batching_stats() const;
 
 	// Debug methods
 	void set_debug_mode(bool p_enabled);
@@ -96,32 +351,83 @@ public:
 	void set_debug_verbosity(int p_level);
 	int get_debug_verbosity() const;
 
+	void set_noise_slice_axis(int p_axis);
+	int get_noise_slice_axis() const;
+
+	void set_noise_slice_position(float p_position);
+	float get_noise_slice_position() const;
+
+	// Animates the slice across the field, 0 stops it
+	void set_noise_slice_sweep_speed(float p_speed);
+	float get_noise_slice_sweep_speed() const;
+
 	void debug_print_state();
+	// Shows the horizontal slice at `y_level`, see noise_slice_axis for others
 	void debug_draw_noise_slice(float y_level);
 	void log_message(const String &message, int verbosity_level = 1);
 
 	bool is_object_binding_set_by_parent_constructor() const;
 
+	// Voxel queries over the loaded chunks, in the generator's local space
+	Chunk *get_chunk(Vector3i chunk_coord) const;
+	int get_voxel_type_at(Vector3i world_pos) const;
+	// Density field interpolated at `position`, 0 before generate()
+	float get_density_at(Vector3 position) const;
+	Dictionary raycast_voxels(Vector3 origin, Vector3 direction, float max_distance, bool hit_liquids = false) const;
+	int count_voxels_in_box(AABB box, int type = -1) const;
+	int count_voxels_in_sphere(Vector3 center, float radius, int type = -1) const;
+	TypedArray<Vector3i> get_voxels_in_box(AABB box, int type = -1) const;
+	TypedArray<Vector3i> get_voxels_in_sphere(Vector3 center, float radius, int type = -1) const;
+	PackedInt32Array count_voxel_types_in_box(AABB box) const;
+
 private:
 	void remove_children();
 	void randomize_seed();
+	void rebuild_terrain_mesh();
+	void rebuild_debug_meshes();
 	Vector<Vector3> create_cube_vertices(const Vector3 &pos);
 	void add_cubes_vertices(Ref<ImmediateMesh> mesh, const Vector<Vector3> &vertices);
-	std::vector<float> get_cube_values(Ref<FastNoiseLite> noise, const Vector<Vector3> &cube_vertices);
-	int get_lookup_index(const std::vector<float> &cube_values, float cutoff);
-	Vector3 interpolate(const Vector3 &vertex_1, float value_1, const Vector3 &vertex_2, float value_2);
 	void add_cube_edges(Ref<ImmediateMesh> mesh, const std::vector<Vector3> &v);
 
 	// Debug helpers
 	void create_debug_visualization();
 	void visualize_noise_field();
+	void update_noise_slice_sweep(double delta);
 
 	// Optionally, add helpers to manage chunks/voxels
-	void create_chunks();
-	void fill_chunk_with_voxels(Chunk *chunk);
+	WorldGeneratorSettings get_world_generator_settings() const;
+	void configure_world_generator();
+	Ref<Material> create_chunk_material() const;
+	// Fills padded buffers from a chunk's data, at index 13, and its 26
+	// neighbors' (null when not loaded), at (dx * 3 + dy) * 3 + dz for offsets
+	// from -1 to 1. Copies under each one's shared lock, meant for jobs.
+	static void fill_chunk_padding(const std::array<const ChunkData *, 27> &neighborhood, int size, VoxelBuffer &r_padded, VoxelBuffer *r_padded_light);
+	JobSystem::JobHandle submit_mesh_job(Chunk *chunk, JobSystem::Priority priority, const std::vector<JobSystem::JobHandle> &dependencies);
+	void cancel_chunk_jobs();
+	void update_dirty_chunks();
+	void update_fluids(double delta);
+	// Edits must land on generated voxels, not be overwritten by the generation
+	// jobs, and queries must not read chunks the jobs are still writing
+	void wait_for_world() const;
+	// Both return whether anything changed, without touching the journal
+	bool apply_voxel_edit(const Vector3i &world_pos, int type, int &r_old_type);
+	bool apply_brush(const Vector3 &point, float strength, float radius);
+	void enforce_memory_budget();
+	void submit_chunk_mesh(Chunk *chunk, const MeshData &mesh);
+	void remesh_all_chunks();
+	void apply_chunk_visibility(Chunk *chunk, bool visible);
+	// Flags chunks that crossed the simplification distance for a remesh
+	void update_mesh_simplification(const Vector3 &camera_local);
 
 	bool is_instance_valid(Chunk *chunk) const;
+
+	template <typename F>
+	void for_each_voxel_in_box(const Vector3i &from, const Vector3i &to, F &&fn) const;
+	template <typename F>
+	void for_each_voxel_in_sphere(const Vector3 &center, float radius, F &&fn) const;
 };
 } // namespace voxel_engine
 
+VARIANT_ENUM_CAST(voxel_engine::VoxelGenerator::MesherMode);
+
 #endif // VOXEL_GENERATOR_H
\ No newline at end of file
@@ -1,8 +1,17 @@
 #include "chunk.h"
+#include "chunk_mesher.h"
+#include "epoch_reclaimer.h"
 #include "voxel.h"
 #include "voxel_constants.h"
+#include "voxel_material.h"
+#include "voxel_math.h"
+#include "world_generator.h"
+
+#include <cstring>
 
 // Godot includes
+#include <godot_cpp/classes/array_mesh.hpp>
+#include <godot_cpp/classes/standard_material3d.hpp>
 #include <godot_cpp/core/class_db.hpp>
 
 namespace voxel_engine {
@@ -11,60 +20,104 @@ void Chunk::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("generate"), &Chunk::generate);
 	ClassDB::bind_method(D_METHOD("set_voxel", "local_pos", "type"), &Chunk::set_voxel);
 	ClassDB::bind_method(D_METHOD("get_voxel", "local_pos"), &Chunk::get_voxel);
+	ClassDB::bind_method(D_METHOD("get_voxel_type", "local_pos"), &Chunk::get_voxel_type);
+	ClassDB::bind_method(D_METHOD("set_chunk_coord", "chunk_coord"), &Chunk::set_chunk_coord);
+	ClassDB::bind_method(D_METHOD("get_chunk_coord"), &Chunk::get_chunk_coord);
 	ClassDB::bind_method(D_METHOD("set_chunk_size", "lod_level"), &Chunk::set_chunk_size);
 	ClassDB::bind_method(D_METHOD("get_chunk_size"), &Chunk::get_chunk_size);
 	ClassDB::bind_method(D_METHOD("rebuild_mesh"), &Chunk::rebuild_mesh);
+	ClassDB::bind_method(D_METHOD("set_material", "material"), &Chunk::set_material);
+	ClassDB::bind_method(D_METHOD("get_material"), &Chunk::get_material);
 	ClassDB::bind_method(D_METHOD("update_lod", "camera_position"), &Chunk::update_lod);
 	ClassDB::bind_method(D_METHOD("is_voxel_solid", "local_pos"), &Chunk::is_voxel_solid);
 	ClassDB::bind_method(D_METHOD("notify_neighbor_chunks_if_on_border", "local_pos"), &Chunk::notify_neighbor_chunks_if_on_border);
 	ClassDB::bind_method(D_METHOD("get_voxel_material_category_id", "local_pos"), &Chunk::get_voxel_material_category_id);
+	ClassDB::bind_method(D_METHOD("get_voxels_in_box", "box"), &Chunk::get_voxels_in_box);
+	ClassDB::bind_method(D_METHOD("set_voxels_in_box", "box", "data"), &Chunk::set_voxels_in_box);
+	ClassDB::bind_method(D_METHOD("fill_box", "box", "type"), &Chunk::fill_box);
+	ClassDB::bind_method(D_METHOD("replace_in_box", "box", "old_type", "new_type"), &Chunk::replace_in_box);
+	ClassDB::bind_method(D_METHOD("fill", "type"), &Chunk::fill);
+	ClassDB::bind_method(D_METHOD("get_voxel_data"), &Chunk::get_voxel_data);
+	ClassDB::bind_method(D_METHOD("set_voxel_data", "data"), &Chunk::set_voxel_data);
+	ClassDB::bind_method(D_METHOD("set_storage_mode", "mode"), &Chunk::set_storage_mode);
+	ClassDB::bind_method(D_METHOD("get_storage_mode"), &Chunk::get_storage_mode);
+	ClassDB::bind_method(D_METHOD("get_storage_memory_usage"), &Chunk::get_storage_memory_usage);
+	ClassDB::bind_method(D_METHOD("serialize_voxels"), &Chunk::serialize_voxels);
+	ClassDB::bind_method(D_METHOD("deserialize_voxels", "data"), &Chunk::deserialize_voxels);
 
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "chunk_size", PROPERTY_HINT_RANGE, "8,64,8"), "set_chunk_size", "get_chunk_size");
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR3I, "chunk_coord"), "set_chunk_coord", "get_chunk_coord");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "storage_mode", PROPERTY_HINT_ENUM, "Dense,Sparse"), "set_storage_mode", "get_storage_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "material", PROPERTY_HINT_RESOURCE_TYPE, "Material"), "set_material", "get_material");
+
+	BIND_ENUM_CONSTANT(STORAGE_DENSE);
+	BIND_ENUM_CONSTANT(STORAGE_SPARSE);
 
 }
 
-Chunk::Chunk() {
+Chunk::Chunk() :
+		voxel_data(new ChunkData),
+		buffer(voxel_data->buffer),
+		octree(voxel_data->octree),
+		light(voxel_data->light),
+		fluid_levels(voxel_data->fluid_levels) {
 	position = Vector3();
 	current_lod_level = 0;
-	// Initialize all voxels to air
-	for (int x = 0; x < chunk_size; ++x) {
-		for (int y = 0; y < chunk_size; ++y) {
-			for (int z = 0; z < chunk_size; ++z) {
-				voxels[x][y][z].instantiate();
-				voxels[x][y][z]->set_type(VoxelType::AIR);
-				voxels[x][y][z]->set_position(Vector3(x, y, z));
-				UtilityFunctions::print("Voxel initialized at position: " + String::num_int64(x) + ", " + String::num_int64(y) + ", " + String::num_int64(z) +
-							" with type: " + String::num_int64(voxels[x][y][z]->get_type()));
-			}
-		}
-	}
+	buffer.create(chunk_size, VoxelType::AIR);
+	light.create(chunk_size, make_light(MAX_LIGHT, 0));
+	// Until meshed, a chunk must not hide what is behind it
+	face_connectivity.connect_all();
+	update_memory_tracking();
 }
 
 Chunk::~Chunk() {
+	// Mesh jobs may still be reading it
+	EpochReclaimer *reclaimer = EpochReclaimer::get_singleton();
+	if (reclaimer) {
+		reclaimer->retire(voxel_data);
+	} else {
+		delete voxel_data;
+	}
 }
 
 void Chunk::generate() {
-	// Basic chunk generation - fill with dirt
-	for (int x = 0; x < chunk_size; ++x) {
-		for (int y = 0; y < chunk_size; ++y) {
-			for (int z = 0; z < chunk_size; ++z) {
-				if (y < chunk_size / 2) {
-					voxels[x][y][z]->set_type(VoxelType::DIRT);
-				} else {
-					voxels[x][y][z]->set_type(VoxelType::AIR);
-				}
-				UtilityFunctions::print("Voxel at position: " + String::num_int64(x) + ", " + String::num_int64(y) + ", " + String::num_int64(z) +
-	   " set to type: " + String::num_int64(voxels[x][y][z]->get_type()));
-			}
-		}
-	}
+	const WorldGenerator generator(generator_settings);
+	generate_with(generator);
 	 // Rebuild the mesh after generation
 	rebuild_mesh();
 }
 
+void Chunk::generate_with(const WorldGenerator &generator) {
+	// Stages write into a dense buffer, sparse chunks convert once at the end.
+	// Built aside, the lock is only held to swap it in.
+	VoxelBuffer generated;
+	generator.generate_chunk(chunk_coord, chunk_size, generated);
+	VoxelOctree tree;
+	if (voxel_data->sparse) {
+		tree.from_buffer(generated);
+		generated.create(0);
+	}
+	{
+		RWSpinLock::WriteGuard guard(voxel_data->lock);
+		if (voxel_data->sparse) {
+			octree = std::move(tree);
+		}
+		buffer = generated;
+	}
+	update_memory_tracking();
+}
+
 void Chunk::set_chunk_size(int p_chunk_size) {
-	if (p_chunk_size > 0 && p_chunk_size <= 64) {
+	if (p_chunk_size > 0 && p_chunk_size <= 64 && p_chunk_size != chunk_size) {
+		// Resizing discards the current contents
+		RWSpinLock::WriteGuard guard(voxel_data->lock);
 		chunk_size = p_chunk_size;
+		light.create(chunk_size, make_light(MAX_LIGHT, 0));
+		if (voxel_data->sparse) {
+			octree.create(chunk_size, VoxelType::AIR);
+		} else {
+			buffer.create(chunk_size, VoxelType::AIR);
+		}
 	}
 }
 
@@ -73,18 +126,22 @@ int Chunk::get_chunk_size() const {
 }
 
 void Chunk::set_voxel(Vector3i local_pos, int type) {
-	if (local_pos.x >= 0 && local_pos.x < chunk_size &&
-			local_pos.y >= 0 && local_pos.y < chunk_size &&
-			local_pos.z >= 0 && local_pos.z < chunk_size) {
-		voxels[local_pos.x][local_pos.y][local_pos.z]->set_type(type);
+	ERR_FAIL_INDEX(type, VOXEL_TYPE_COUNT);
+	RWSpinLock::WriteGuard guard(voxel_data->lock);
+	if (voxel_data->sparse) {
+		octree.set(local_pos.x, local_pos.y, local_pos.z, (uint8_t)type);
+	} else if (buffer.is_in_bounds(local_pos)) {
+		buffer.set(local_pos.x, local_pos.y, local_pos.z, (uint8_t)type);
 	}
 }
 
 Ref<Voxel> Chunk::get_voxel(Vector3i local_pos) {
-	if (local_pos.x >= 0 && local_pos.x < chunk_size &&
-			local_pos.y >= 0 && local_pos.y < chunk_size &&
-			local_pos.z >= 0 && local_pos.z < chunk_size) {
-		return voxels[local_pos.x][local_pos.y][local_pos.z];
+	if (local_pos.x >= 0 && local_pos.x < chunk_size && local_pos.y >= 0 && local_pos.y < chunk_size && local_pos.z >= 0 && local_pos.z < chunk_size) {
+		// Holds no voxel data, so views of the same voxel always agree
+		Ref<Voxel> view;
+		view.instantiate();
+		view->bind_to_chunk(get_instance_id(), (uint32_t)(local_pos.x + chunk_size * (local_pos.z + chunk_size * local_pos.y)), chunk_size, get_voxel_type(local_pos));
+		return view;
 	}
 
 	// Return empty voxel (air) if out of bounds
@@ -94,14 +151,104 @@ Ref<Voxel> Chunk::get_voxel(Vector3i local_pos) {
 	return empty_voxel;
 }
 
+int Chunk::get_voxel_type(Vector3i local_pos) const {
+	// Unlike get_voxel(), never allocates: out of bounds reads are simply air.
+	// Locked, scripts may call it while a generation job swaps the storage.
+	RWSpinLock::ReadGuard guard(voxel_data->lock);
+	return voxel_data->get_voxel_type(local_pos);
+}
+
+void Chunk::set_chunk_coord(Vector3i p_chunk_coord) {
+	chunk_coord = p_chunk_coord;
+	position = Vector3(chunk_coord * chunk_size);
+	set_position(position);
+}
+
+Vector3i Chunk::get_chunk_coord() const {
+	return chunk_coord;
+}
+
 void Chunk::rebuild_mesh() {
-	// Basic mesh rebuilding - placeholder
 	rebuild_mesh_with_lod(current_lod_level);
 }
 
 void Chunk::rebuild_mesh_with_lod(int lod_level) {
-	// Placeholder for LOD mesh building
+	// LOD levels are not meshed differently yet
 	current_lod_level = lod_level;
+
+	// Standalone rebuild: no neighbors known here, the shell reads as air
+	VoxelBuffer padded;
+	fill_padded_buffer(padded);
+	VoxelBuffer padded_light;
+	fill_padded_light(padded_light);
+	MeshData mesh;
+	build_mesh_data(padded, &padded_light, true, compact_vertices, mesh, face_connectivity);
+	apply_mesh(mesh);
+}
+
+void Chunk::fill_padded_buffer(VoxelBuffer &r_padded) const {
+	voxel_data->fill_padded_buffer(chunk_size, r_padded);
+}
+
+void Chunk::fill_padded_light(VoxelBuffer &r_padded_light) const {
+	voxel_data->fill_padded_light(chunk_size, r_padded_light);
+}
+
+void Chunk::build_mesh_data(const VoxelBuffer &padded, const VoxelBuffer *padded_light, bool ambient_occlusion, bool compact, MeshData &r_mesh, FaceConnectivity &r_connectivity) {
+	ChunkMesher::build(padded, padded_light, ambient_occlusion, compact, r_mesh);
+	r_connectivity = compute_face_connectivity(padded);
+}
+
+void Chunk::apply_mesh(const MeshData &mesh) {
+	tracked_mesh.set(mesh.get_memory_usage());
+	if (mesh.is_empty()) {
+		if (mesh_instance) {
+			mesh_instance->set_mesh(Ref<Mesh>());
+		}
+		return;
+	}
+
+	if (material.is_null() && mesh.is_compact()) {
+		material = VoxelMaterial::create();
+	} else if (material.is_null()) {
+		Ref<StandardMaterial3D> default_material;
+		default_material.instantiate();
+		default_material->set_flag(BaseMaterial3D::FLAG_ALBEDO_FROM_VERTEX_COLOR, true);
+		material = default_material;
+	}
+
+	Ref<ArrayMesh> array_mesh;
+	array_mesh.instantiate();
+	array_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, mesh.to_surface_arrays(), TypedArray<Array>(), Dictionary(), mesh.get_surface_flags());
+	array_mesh->surface_set_material(0, material);
+
+	if (mesh_instance == nullptr) {
+		mesh_instance = memnew(MeshInstance3D);
+		mesh_instance->set_name("ChunkMesh");
+		add_child(mesh_instance);
+	}
+	mesh_instance->set_mesh(array_mesh);
+}
+
+void Chunk::set_material(const Ref<Material> &p_material) {
+	material = p_material;
+	if (mesh_instance) {
+		Ref<ArrayMesh> array_mesh = mesh_instance->get_mesh();
+		if (array_mesh.is_valid() && array_mesh->get_surface_count() > 0) {
+			array_mesh->surface_set_material(0, material);
+		}
+	}
+}
+
+Ref<Material> Chunk::get_material() const {
+	return material;
+}
+
+void Chunk::set_cull_visible(bool p_visible) {
+	if (p_visible != cull_visible) {
+		cull_visible = p_visible;
+		set_visible(p_visible);
+	}
 }
 
 void Chunk::update_lod(Vector3 camera_position) {
@@ -121,12 +268,7 @@ void Chunk::update_lod(Vector3 camera_position) {
 }
 
 bool Chunk::is_voxel_solid(Vector3i local_pos) {
-	if (local_pos.x >= 0 && local_pos.x < chunk_size &&
-			local_pos.y >= 0 && local_pos.y < chunk_size &&
-			local_pos.z >= 0 && local_pos.z < chunk_size) {
-		return voxels[local_pos.x][local_pos.y][local_pos.z]->is_solid();
-	}
-	return false;
+	return get_voxel_type(local_pos) != VoxelType::AIR;
 }
 
 void Chunk::notify_neighbor_chunks_if_on_border(Vector3i local_pos) {
@@ -135,12 +277,175 @@ void Chunk::notify_neighbor_chunks_if_on_border(Vector3i local_pos) {
 }
 
 int Chunk::get_voxel_material_category_id(Vector3i local_pos) {
-	if (local_pos.x >= 0 && local_pos.x < chunk_size &&
-			local_pos.y >= 0 && local_pos.y < chunk_size &&
-			local_pos.z >= 0 && local_pos.z < chunk_size) {
-		return voxels[local_pos.x][local_pos.y][local_pos.z]->get_type();
+	return get_voxel_type(local_pos);
+}
+
+PackedByteArray Chunk::get_voxels_in_box(AABB box) const {
+	Vector3i from, to;
+	aabb_to_voxel_range(box, from, to);
+	const Vector3i box_size = to - from + Vector3i(1, 1, 1);
+
+	PackedByteArray data;
+	if (box_size.x <= 0 || box_size.y <= 0 || box_size.z <= 0) {
+		return data;
+	}
+	data.resize((int64_t)box_size.x * box_size.y * box_size.z);
+	// Voxels outside the chunk read as air
+	data.fill(VoxelType::AIR);
+	RWSpinLock::ReadGuard guard(voxel_data->lock);
+	if (voxel_data->sparse) {
+		octree.copy_box_to(from, to, data.ptrw());
+	} else {
+		buffer.copy_box_to(from, to, data.ptrw());
+	}
+	return data;
+}
+
+void Chunk::set_voxels_in_box(AABB box, const PackedByteArray &data) {
+	Vector3i from, to;
+	aabb_to_voxel_range(box, from, to);
+	const Vector3i box_size = to - from + Vector3i(1, 1, 1);
+	if (box_size.x <= 0 || box_size.y <= 0 || box_size.z <= 0) {
+		return;
+	}
+	ERR_FAIL_COND_MSG(data.size() != (int64_t)box_size.x * box_size.y * box_size.z, "Voxel data size doesn't match the box volume.");
+	RWSpinLock::WriteGuard guard(voxel_data->lock);
+	if (voxel_data->sparse) {
+		octree.copy_box_from(from, to, data.ptr());
+	} else {
+		buffer.copy_box_from(from, to, data.ptr());
+	}
+}
+
+void Chunk::fill_box(AABB box, int type) {
+	ERR_FAIL_INDEX(type, VOXEL_TYPE_COUNT);
+	Vector3i from, to;
+	aabb_to_voxel_range(box, from, to);
+	RWSpinLock::WriteGuard guard(voxel_data->lock);
+	if (voxel_data->sparse) {
+		octree.fill_box(from, to, (uint8_t)type);
+	} else {
+		buffer.fill_box(from, to, (uint8_t)type);
+	}
+}
+
+int Chunk::replace_in_box(AABB box, int old_type, int new_type) {
+	ERR_FAIL_INDEX_V(new_type, VOXEL_TYPE_COUNT, 0);
+	Vector3i from, to;
+	aabb_to_voxel_range(box, from, to);
+	RWSpinLock::WriteGuard guard(voxel_data->lock);
+	if (voxel_data->sparse) {
+		return octree.replace_in_box(from, to, (uint8_t)old_type, (uint8_t)new_type);
+	}
+	return buffer.replace_in_box(from, to, (uint8_t)old_type, (uint8_t)new_type);
+}
+
+void Chunk::fill(int type) {
+	ERR_FAIL_INDEX(type, VOXEL_TYPE_COUNT);
+	RWSpinLock::WriteGuard guard(voxel_data->lock);
+	if (voxel_data->sparse) {
+		octree.fill((uint8_t)type);
+	} else {
+		buffer.fill((uint8_t)type);
+	}
+}
+
+PackedByteArray Chunk::get_voxel_data() const {
+	const int64_t volume = (int64_t)chunk_size * chunk_size * chunk_size;
+	PackedByteArray data;
+	data.resize(volume);
+	RWSpinLock::ReadGuard guard(voxel_data->lock);
+	if (voxel_data->sparse) {
+		octree.copy_box_to(Vector3i(), Vector3i(chunk_size - 1, chunk_size - 1, chunk_size - 1), data.ptrw());
+	} else {
+		memcpy(data.ptrw(), buffer.ptr(), volume);
+	}
+	return data;
+}
+
+void Chunk::set_voxel_data(const PackedByteArray &data) {
+	ERR_FAIL_COND_MSG(data.size() != (int64_t)chunk_size * chunk_size * chunk_size, "Voxel data size doesn't match the chunk volume.");
+	RWSpinLock::WriteGuard guard(voxel_data->lock);
+	if (voxel_data->sparse) {
+		// Same layout as the dense buffer, build through it so the tree comes out minimal
+		VoxelBuffer dense;
+		dense.create(chunk_size);
+		memcpy(dense.ptrw(), data.ptr(), dense.get_volume());
+		octree.from_buffer(dense);
+	} else {
+		memcpy(buffer.ptrw(), data.ptr(), buffer.get_volume());
+	}
+}
+
+void Chunk::set_storage_mode(StorageMode p_mode) {
+	if ((p_mode == STORAGE_SPARSE) == voxel_data->sparse) {
+		return;
+	}
+	// Contents are kept across the switch, the old storage is released
+	RWSpinLock::WriteGuard guard(voxel_data->lock);
+	if (p_mode == STORAGE_SPARSE) {
+		octree.from_buffer(buffer);
+		buffer.create(0);
+	} else {
+		octree.to_buffer(buffer);
+		octree.create(0);
+	}
+	voxel_data->sparse = p_mode == STORAGE_SPARSE;
+	update_memory_tracking();
+}
+
+Chunk::StorageMode Chunk::get_storage_mode() const {
+	return voxel_data->sparse ? STORAGE_SPARSE : STORAGE_DENSE;
+}
+
+int64_t Chunk::get_storage_memory_usage() const {
+	if (voxel_data->sparse) {
+		return (int64_t)octree.get_memory_usage();
+	}
+	return buffer.get_volume();
+}
+
+void Chunk::update_memory_tracking() {
+	tracked_voxels.set(get_storage_memory_usage() + fluid_levels.get_volume());
+	tracked_light.set(light.get_volume());
+}
+
+PackedByteArray Chunk::serialize_voxels() const {
+	std::vector<uint8_t> bytes;
+	RWSpinLock::ReadGuard guard(voxel_data->lock);
+	if (voxel_data->sparse) {
+		bytes = octree.serialize();
+	} else {
+		VoxelOctree tree;
+		tree.from_buffer(buffer);
+		bytes = tree.serialize();
+	}
+
+	PackedByteArray data;
+	data.resize(bytes.size());
+	memcpy(data.ptrw(), bytes.data(), bytes.size());
+	return data;
+}
+
+void Chunk::deserialize_voxels(const PackedByteArray &data) {
+	ERR_FAIL_COND_MSG(!deserialize_voxel_bytes(data.ptr(), data.size()), "Invalid serialized voxel data.");
+}
+
+bool Chunk::deserialize_voxel_bytes(const uint8_t *data, size_t length) {
+	VoxelOctree tree;
+	if (!tree.deserialize(data, length, chunk_size)) {
+		return false;
+	}
+	{
+		RWSpinLock::WriteGuard guard(voxel_data->lock);
+		if (voxel_data->sparse) {
+			octree = std::move(tree);
+		} else {
+			tree.to_buffer(buffer);
+		}
 	}
-	return VoxelType::AIR;
+	update_memory_tracking();
+	return true;
 }
 
 } // namespace voxel_engine
\ No newline at end of file
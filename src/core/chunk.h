@@ -3,15 +3,27 @@
 #ifndef CHUNK_H
 #define CHUNK_H
 
+#include "chunk_data.h"
+#include "chunk_visibility.h"
 #include "direction.h"
+#include "light_engine.h"
+#include "memory_tracker.h"
+#include "mesh_data.h"
 #include "voxel.h"
+#include "voxel_buffer.h"
+#include "voxel_octree.h"
+#include "world_generator.h"
 
 // Godot includes
+#include <godot_cpp/classes/material.hpp>
+#include <godot_cpp/classes/mesh_instance3d.hpp>
 #include <godot_cpp/classes/node3d.hpp>
 #include <godot_cpp/classes/ref_counted.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/godot.hpp>
+#include <godot_cpp/variant/aabb.hpp>
 #include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
 #include <godot_cpp/variant/vector3.hpp>
 #include <godot_cpp/variant/vector3i.hpp>
 
@@ -26,36 +38,151 @@ protected:
 	static void _bind_methods();
 
 public:
+	// How voxel types are stored. DENSE keeps one byte per voxel, SPARSE an
+	// octree whose size follows the surface complexity of the chunk.
+	enum StorageMode {
+		STORAGE_DENSE,
+		STORAGE_SPARSE
+	};
+
 	int chunk_size = 8;
 	inline static const Vector3i WORLD_SIZE = Vector3i(0, 0, 0);
 
 	int chunk_id = 0; // Unique identifier for the chunk
-	Ref<Voxel> voxels[8][8][8];
+	// Voxel state, apart from the node so that jobs can outlive it. Retired to
+	// the EpochReclaimer on destruction, see ChunkData for the threading rules.
+	ChunkData *voxel_data;
+	VoxelBuffer &buffer;
+	VoxelOctree &octree;
+	VoxelBuffer &light;
+	VoxelBuffer &fluid_levels;
 	Vector3 position;
+	Vector3i chunk_coord; // Position in the chunk grid (world voxel position / chunk_size)
+
+	// Culling pass bookkeeping, owned by the generator
+	uint32_t cull_frame = 0;
+	uint8_t cull_entered_faces = 0;
+	// Last culling pass that showed the chunk, whichever culling is on. The
+	// memory budget evicts the least recently shown first.
+	uint32_t last_visible_frame = 0;
+	// Bumped for each mesh job, results of older jobs are dropped
+	uint32_t mesh_revision = 0;
+	// Mesh dropped to stay within the memory budget, rebuilt once visible
+	bool mesh_evicted = false;
+	// Far enough to be meshed through MeshSimplifier, read by the next mesh job
+	bool mesh_simplified = false;
+	// Vertex format the material expects: compact for the voxel shader (see
+	// VoxelMaterial), plain normals and colors otherwise
+	bool compact_vertices = false;
+	// Seed and world settings generate() runs with. The owning VoxelGenerator
+	// sets them when creating the chunk, a standalone chunk keeps the defaults.
+	WorldGeneratorSettings generator_settings;
 
 	Chunk();
 	~Chunk();
 
 	void generate();
+	// Runs `generator` on this chunk only, safe to call from a worker thread
+	void generate_with(const WorldGenerator &generator);
 	void set_voxel(Vector3i local_pos, int type);
+	// A new view over the voxel (see Voxel), for scripts. C++ code should use
+	// get_voxel_type(), which never allocates.
 	Ref<Voxel> get_voxel(Vector3i local_pos);
+	int get_voxel_type(Vector3i local_pos) const;
+	void set_chunk_coord(Vector3i p_chunk_coord);
+	Vector3i get_chunk_coord() const;
 	void set_chunk_size(int p_chunk_size);
 	int get_chunk_size() const;
 	void rebuild_mesh();
+
+	// Meshing in two steps so the expensive part can run on a worker thread.
+	// The padded buffer is (chunk_size + 2)^3: this chunk's voxels plus a one
+	// voxel shell from the neighbors, see fill_padded_buffer(). Jobs go through
+	// `voxel_data` instead, under its lock.
+	void fill_padded_buffer(VoxelBuffer &r_padded) const;
+	// Same layout for the light, the shell defaults to open sky
+	void fill_padded_light(VoxelBuffer &r_padded_light) const;
+	// Only reads the padded buffers, the connectivity is applied with the mesh.
+	// Without light every face is fully lit. See ChunkMesher for `compact`.
+	static void build_mesh_data(const VoxelBuffer &padded, const VoxelBuffer *padded_light, bool ambient_occlusion, bool compact, MeshData &r_mesh, FaceConnectivity &r_connectivity);
+	void apply_mesh(const MeshData &mesh);
+	const FaceConnectivity &get_face_connectivity() const { return face_connectivity; }
+	void set_face_connectivity(const FaceConnectivity &p_connectivity) { face_connectivity = p_connectivity; }
+
+	void set_material(const Ref<Material> &p_material);
+	Ref<Material> get_material() const;
+	// Only touches the node when the state changes
+	void set_cull_visible(bool p_visible);
+	bool is_cull_visible() const { return cull_visible; }
 	void update_lod(Vector3 camera_position);
 	bool is_voxel_solid(Vector3i local_pos);
 	void notify_neighbor_chunks_if_on_border(Vector3i local_pos);
 	int get_voxel_material_category_id(Vector3i local_pos);
 
+	// Bulk access. Boxes are in local voxel coordinates, data is packed one byte
+	// per voxel with X varying fastest, then Z, then Y.
+	PackedByteArray get_voxels_in_box(AABB box) const;
+	void set_voxels_in_box(AABB box, const PackedByteArray &data);
+	void fill_box(AABB box, int type);
+	int replace_in_box(AABB box, int old_type, int new_type);
+	void fill(int type);
+	PackedByteArray get_voxel_data() const;
+	void set_voxel_data(const PackedByteArray &data);
+
+	void set_storage_mode(StorageMode p_mode);
+	StorageMode get_storage_mode() const;
+	int64_t get_storage_memory_usage() const;
+	// Reports storage and light to the MemoryTracker. Meshes are reported by
+	// apply_mesh(), Voxel views by themselves.
+	void update_memory_tracking();
+	int64_t get_mesh_memory_usage() const { return tracked_mesh.get(); }
+	// Compact form in either mode: the octree with identical subtrees shared
+	PackedByteArray serialize_voxels() const;
+	void deserialize_voxels(const PackedByteArray &data);
+	// Same without the Variant copy, callable from jobs. False when the data is
+	// invalid or for another chunk size, the voxels are left as they were.
+	bool deserialize_voxel_bytes(const uint8_t *data, size_t length);
+
+	// Calls `fn(const Vector3i &local_pos, uint8_t type)` for every voxel in the
+	// inclusive local range, clipped to the chunk
+	template <typename F>
+	void for_each_voxel_in_box(const Vector3i &from, const Vector3i &to, F &&fn) const;
+
 private:
 	// Private helper methods can be added here if needed
 	int current_lod_level = 0; // Current LOD level
+	MeshInstance3D *mesh_instance = nullptr;
+	Ref<Material> material;
+	FaceConnectivity face_connectivity;
+	bool cull_visible = true;
+	TrackedBytes tracked_voxels{ MemoryTracker::CATEGORY_VOXELS };
+	TrackedBytes tracked_light{ MemoryTracker::CATEGORY_LIGHT };
+	TrackedBytes tracked_mesh{ MemoryTracker::CATEGORY_MESHES };
 	void rebuild_mesh_with_lod(int lod_level);
 
 private:
 	//BiomeGenerator *biome_generator = nullptr;
 };
 
+template <typename F>
+void Chunk::for_each_voxel_in_box(const Vector3i &from, const Vector3i &to, F &&fn) const {
+	if (voxel_data->sparse) {
+		octree.for_each_in_box(from, to, fn);
+		return;
+	}
+	const Vector3i lo(MAX(from.x, 0), MAX(from.y, 0), MAX(from.z, 0));
+	const Vector3i hi(MIN(to.x, chunk_size - 1), MIN(to.y, chunk_size - 1), MIN(to.z, chunk_size - 1));
+	for (int y = lo.y; y <= hi.y; ++y) {
+		for (int z = lo.z; z <= hi.z; ++z) {
+			for (int x = lo.x; x <= hi.x; ++x) {
+				fn(Vector3i(x, y, z), buffer.get(x, y, z));
+			}
+		}
+	}
+}
+
 } // namespace voxel_engine
 
+VARIANT_ENUM_CAST(voxel_engine::Chunk::StorageMode);
+
 #endif // CHUNK_H
\ No newline at end of file
@@ -0,0 +1,25 @@
+#include "chunk_data.h"
+
+#include <vector>
+
+namespace voxel_engine {
+
+void ChunkData::fill_padded_buffer(int size, VoxelBuffer &r_padded) const {
+	r_padded.create(size + 2, VoxelType::AIR);
+	const Vector3i last(size - 1, size - 1, size - 1);
+	if (sparse) {
+		std::vector<uint8_t> dense(size * size * size);
+		octree.copy_box_to(Vector3i(), last, dense.data());
+		r_padded.copy_box_from(Vector3i(1, 1, 1), last + Vector3i(1, 1, 1), dense.data());
+	} else {
+		r_padded.copy_box_from(Vector3i(1, 1, 1), last + Vector3i(1, 1, 1), buffer.ptr());
+	}
+}
+
+void ChunkData::fill_padded_light(int size, VoxelBuffer &r_padded_light) const {
+	r_padded_light.create(size + 2, make_light(MAX_LIGHT, 0));
+	const Vector3i last(size - 1, size - 1, size - 1);
+	r_padded_light.copy_box_from(Vector3i(1, 1, 1), last + Vector3i(1, 1, 1), light.ptr());
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,126 @@
+// chunk_data.h
+
+#ifndef CHUNK_DATA_H
+#define CHUNK_DATA_H
+
+#include "light_engine.h"
+#include "voxel.h"
+#include "voxel_buffer.h"
+#include "voxel_octree.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+// Godot includes
+#include <godot_cpp/variant/vector3i.hpp>
+
+using namespace godot;
+
+namespace voxel_engine {
+
+// Reader/writer spin lock for short critical sections. Writers set the
+// writer bit, which holds off new readers, then wait for the current ones to
+// leave. No fairness beyond that, and not reentrant.
+class RWSpinLock {
+public:
+	void lock_shared() {
+		while (true) {
+			uint32_t current = state.load(std::memory_order_relaxed);
+			if ((current & WRITER) == 0 && state.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+				return;
+			}
+			std::this_thread::yield();
+		}
+	}
+	void unlock_shared() { state.fetch_sub(1, std::memory_order_release); }
+
+	void lock() {
+		uint32_t current = state.load(std::memory_order_relaxed);
+		while ((current & WRITER) != 0 || !state.compare_exchange_weak(current, current | WRITER, std::memory_order_acquire, std::memory_order_relaxed)) {
+			std::this_thread::yield();
+			current = state.load(std::memory_order_relaxed);
+		}
+		while ((state.load(std::memory_order_acquire) & ~WRITER) != 0) {
+			std::this_thread::yield();
+		}
+	}
+	void unlock() { state.fetch_and(~WRITER, std::memory_order_release); }
+
+	class ReadGuard {
+	public:
+		explicit ReadGuard(RWSpinLock &p_lock) :
+				lock(p_lock) { lock.lock_shared(); }
+		~ReadGuard() { lock.unlock_shared(); }
+
+	private:
+		RWSpinLock &lock;
+	};
+	class WriteGuard {
+	public:
+		explicit WriteGuard(RWSpinLock &p_lock) :
+				lock(p_lock) { lock.lock(); }
+		~WriteGuard() { lock.unlock(); }
+
+	private:
+		RWSpinLock &lock;
+	};
+
+private:
+	static constexpr uint32_t WRITER = 0x80000000u;
+	std::atomic<uint32_t> state{ 0 }; // Writer bit and reader count
+};
+
+// The voxels, light and fluid levels of a chunk, apart from its node so that
+// jobs can keep reading them after the chunk is unloaded.
+//
+// Concurrency model:
+// - The main thread owns chunks. It writes through Chunk, which takes `lock`
+//   exclusively, and reads without locking: the only other writers are the
+//   generation and initial light jobs, which it waits for
+//   (VoxelGenerator::wait_for_world) before touching the voxels, and the
+//   fluid jobs, which only run while it waits for them (see below). Every
+//   public VoxelGenerator query waits for the world first; the voxel reads
+//   Chunk binds for scripts take the shared lock, since a script can reach a
+//   chunk before its generation job is done.
+// - Mesh jobs never touch Chunk nodes. A mesh job gets the ChunkData of its
+//   chunk and the 26 neighbors, copies what it needs under each one's shared
+//   lock into its own padded buffers, and meshes from that immutable copy
+//   without locks. Dense buffers are copy on write, so copying a whole chunk
+//   only takes a reference.
+// - Fluid jobs do go through Chunk nodes, see FluidSimulator::tick. The first
+//   phase looks chunks up in the generator's chunk map and reads voxel types
+//   and fluid levels around the active cells. The second has one job per
+//   chunk, writing that chunk's voxels (through set_voxel, so under `lock`)
+//   and fluid levels. The main thread waits for each phase inside tick(), so
+//   nothing is edited or unloaded meanwhile and no two jobs write the same
+//   chunk. Mesh jobs may run alongside but only read voxels, under the shared
+//   lock, and never fluid levels.
+// - Unloading a chunk retires its ChunkData to the EpochReclaimer instead of
+//   deleting it: jobs pin an epoch while they run, so the data is freed once
+//   the jobs that could still see it are done.
+class ChunkData {
+public:
+	VoxelBuffer buffer; // Packed voxel types, the authoritative storage in dense mode
+	VoxelOctree octree; // Authoritative storage in sparse mode
+	VoxelBuffer light; // Sky and block light per voxel (see light_engine.h), written by LightEngine
+	VoxelBuffer fluid_levels; // Levels of flowing liquid, empty until FluidSimulator moves some here
+	bool sparse = false;
+	mutable RWSpinLock lock;
+
+	inline int get_voxel_type(const Vector3i &local_pos) const {
+		if (sparse) {
+			return octree.is_in_bounds(local_pos) ? octree.get(local_pos.x, local_pos.y, local_pos.z) : (int)VoxelType::AIR;
+		}
+		return buffer.is_in_bounds(local_pos) ? buffer.get(local_pos.x, local_pos.y, local_pos.z) : (int)VoxelType::AIR;
+	}
+
+	// Voxels (or light) into the interior of a (size + 2)^3 buffer, the shell
+	// is left at air (or open sky). Callers off the main thread lock first.
+	void fill_padded_buffer(int size, VoxelBuffer &r_padded) const;
+	void fill_padded_light(int size, VoxelBuffer &r_padded_light) const;
+};
+
+} // namespace voxel_engine
+
+#endif // CHUNK_DATA_H
@@ -0,0 +1,120 @@
+#include "chunk_mesher.h"
+#include "direction.h"
+#include "light_engine.h"
+#include "voxel.h"
+
+namespace voxel_engine {
+
+namespace {
+
+// Quad corners per face, clockwise seen from outside (Godot's front face winding)
+const Vector3 FACE_CORNERS[Direction::COUNT][4] = {
+	{ Vector3(0, 0, 0), Vector3(0, 1, 0), Vector3(0, 1, 1), Vector3(0, 0, 1) }, // NEGATIVE_X
+	{ Vector3(1, 0, 0), Vector3(1, 0, 1), Vector3(1, 1, 1), Vector3(1, 1, 0) }, // POSITIVE_X
+	{ Vector3(0, 0, 0), Vector3(0, 0, 1), Vector3(1, 0, 1), Vector3(1, 0, 0) }, // NEGATIVE_Y
+	{ Vector3(0, 1, 0), Vector3(1, 1, 0), Vector3(1, 1, 1), Vector3(0, 1, 1) }, // POSITIVE_Y
+	{ Vector3(0, 0, 0), Vector3(1, 0, 0), Vector3(1, 1, 0), Vector3(0, 1, 0) }, // NEGATIVE_Z
+	{ Vector3(0, 0, 1), Vector3(0, 1, 1), Vector3(1, 1, 1), Vector3(1, 0, 1) } // POSITIVE_Z
+};
+
+} // namespace
+
+void ChunkMesher::build(const VoxelBuffer &padded, const VoxelBuffer *padded_light, bool ambient_occlusion, bool compact, MeshData &r_mesh) {
+	const int size = padded.get_size() - 2;
+	const int base = padded.get_index(0, 0, 0);
+
+	// Index offsets of the 6 neighbors in the padded buffer, in Direction order
+	int neighbor_offsets[Direction::COUNT];
+	// For each face corner, the two voxels beside it and the diagonal one, all
+	// in the layer in front of the face
+	int ao_offsets[Direction::COUNT][4][3];
+	for (int d = 0; d < Direction::COUNT; ++d) {
+		const Vector3i normal = Direction::get_direction_vector(Direction::Value(d));
+		neighbor_offsets[d] = padded.get_index(normal.x, normal.y, normal.z) - base;
+
+		const int axis = d / 2;
+		const int axis_u = (axis + 1) % 3;
+		const int axis_v = (axis + 2) % 3;
+		for (int corner = 0; corner < 4; ++corner) {
+			const Vector3 &position = FACE_CORNERS[d][corner];
+			Vector3i side_u;
+			Vector3i side_v;
+			side_u[axis_u] = position[axis_u] > 0.5f ? 1 : -1;
+			side_v[axis_v] = position[axis_v] > 0.5f ? 1 : -1;
+			const Vector3i offsets[3] = { normal + side_u, normal + side_v, normal + side_u + side_v };
+			for (int i = 0; i < 3; ++i) {
+				ao_offsets[d][corner][i] = padded.get_index(offsets[i].x, offsets[i].y, offsets[i].z) - base;
+			}
+		}
+	}
+
+	for (int y = 0; y < size; ++y) {
+		for (int z = 0; z < size; ++z) {
+			for (int x = 0; x < size; ++x) {
+				const int index = padded.get_index(x + 1, y + 1, z + 1);
+				const uint8_t type = padded.get_at_index(index);
+				if (type == AIR) {
+					continue;
+				}
+
+				const Vector3 origin(x, y, z);
+				const Color base_color = get_voxel_type_color(type);
+				const bool emissive = get_voxel_type_emission(type) > 0;
+				for (int d = 0; d < Direction::COUNT; ++d) {
+					const uint8_t neighbor = padded.get_at_index(index + neighbor_offsets[d]);
+					if (neighbor == type || is_voxel_type_opaque(neighbor)) {
+						continue;
+					}
+
+					// Without light data every face is fully lit
+					const uint8_t light = padded_light ? padded_light->get_at_index(index + neighbor_offsets[d]) : make_light(MAX_LIGHT, 0);
+					Color color = base_color;
+					if (!compact && padded_light && !emissive) {
+						const float brightness = get_light_brightness(light);
+						color = Color(color.r * brightness, color.g * brightness, color.b * brightness, color.a);
+					}
+
+					// Classic 3 neighbor corner AO: two solid sides hide the corner
+					// whatever the diagonal is
+					int ao[4] = { 3, 3, 3, 3 };
+					if (ambient_occlusion) {
+						for (int corner = 0; corner < 4; ++corner) {
+							const int *offsets = ao_offsets[d][corner];
+							const int side_u = is_voxel_type_opaque(padded.get_at_index(index + offsets[0])) ? 1 : 0;
+							const int side_v = is_voxel_type_opaque(padded.get_at_index(index + offsets[1])) ? 1 : 0;
+							const int diagonal = is_voxel_type_opaque(padded.get_at_index(index + offsets[2])) ? 1 : 0;
+							ao[corner] = side_u && side_v ? 0 : 3 - (side_u + side_v + diagonal);
+						}
+					}
+
+					const int32_t first = (int32_t)r_mesh.vertices.size();
+					const Vector3 normal = Vector3(Direction::get_direction_vector(Direction::Value(d)));
+					for (int corner = 0; corner < 4; ++corner) {
+						r_mesh.vertices.push_back(origin + FACE_CORNERS[d][corner]);
+						if (compact) {
+							r_mesh.voxel_attributes.push_back(pack_voxel_vertex(type, light, normal, ao[corner], emissive));
+							continue;
+						}
+						const float occlusion = AO_CURVE[ao[corner]];
+						r_mesh.normals.push_back(normal);
+						r_mesh.colors.push_back(Color(color.r * occlusion, color.g * occlusion, color.b * occlusion, color.a));
+					}
+					// Split along the brighter diagonal so a dark corner fades
+					// within one triangle instead of streaking across the quad
+					const int32_t pivot = ao[0] + ao[2] < ao[1] + ao[3] ? first + 1 : first;
+					const int32_t next = pivot == first ? first + 1 : first + 2;
+					const int32_t opposite = pivot == first ? first + 2 : first + 3;
+					const int32_t last = pivot == first ? first + 3 : first;
+					r_mesh.indices.push_back(pivot);
+					r_mesh.indices.push_back(next);
+					r_mesh.indices.push_back(opposite);
+					r_mesh.indices.push_back(pivot);
+					r_mesh.indices.push_back(opposite);
+					r_mesh.indices.push_back(last);
+				}
+			}
+		}
+	}
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,30 @@
+// chunk_mesher.h
+
+#ifndef CHUNK_MESHER_H
+#define CHUNK_MESHER_H
+
+#include "mesh_data.h"
+#include "voxel_buffer.h"
+
+namespace voxel_engine {
+
+// Blocky mesher: one quad per voxel face that borders a non-opaque voxel of
+// another type. Works on a padded buffer, the chunk plus a one voxel shell
+// copied from its neighbors, so border faces are culled against real data.
+class ChunkMesher {
+public:
+	// `padded` is (chunk_size + 2)^3, chunk voxel (x, y, z) sits at (x + 1, y + 1, z + 1).
+	// `padded_light` has the same layout; a face takes the light of the voxel
+	// in front of it. Null leaves every face fully lit. `ambient_occlusion`
+	// darkens face corners next to opaque voxels, which needs the edges and
+	// corners of the padding too. `compact` writes MeshData::voxel_attributes
+	// instead of normals and colors, for the voxel shader to decode.
+	static void build(const VoxelBuffer &padded, const VoxelBuffer *padded_light, bool ambient_occlusion, bool compact, MeshData &r_mesh);
+
+	// Brightness per corner AO level, 0 = both sides and the diagonal solid
+	static constexpr float AO_CURVE[4] = { 0.5f, 0.7f, 0.85f, 1.0f };
+};
+
+} // namespace voxel_engine
+
+#endif // CHUNK_MESHER_H
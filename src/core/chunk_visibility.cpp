@@ -0,0 +1,83 @@
+#include "chunk_visibility.h"
+#include "voxel.h"
+
+#include <vector>
+
+namespace voxel_engine {
+
+FaceConnectivity compute_face_connectivity(const VoxelBuffer &padded) {
+	const int size = padded.get_size() - 2;
+	const int volume = size * size * size;
+	FaceConnectivity connectivity;
+
+	// Local index is x + size * (z + size * y), same order as VoxelBuffer
+	std::vector<uint8_t> visited(volume, 0);
+	int open_count = 0;
+	for (int y = 0; y < size; ++y) {
+		for (int z = 0; z < size; ++z) {
+			for (int x = 0; x < size; ++x) {
+				if (is_voxel_type_opaque(padded.get(x + 1, y + 1, z + 1))) {
+					visited[x + size * (z + size * y)] = 1;
+				} else {
+					open_count++;
+				}
+			}
+		}
+	}
+	if (open_count == 0) {
+		return connectivity;
+	}
+	if (open_count == volume) {
+		connectivity.connect_all();
+		return connectivity;
+	}
+
+	std::vector<int> stack;
+	for (int start = 0; start < volume; ++start) {
+		if (visited[start]) {
+			continue;
+		}
+
+		// Collect the faces this region touches
+		uint8_t faces = 0;
+		visited[start] = 1;
+		stack.push_back(start);
+		while (!stack.empty()) {
+			const int index = stack.back();
+			stack.pop_back();
+			const int x = index % size;
+			const int z = (index / size) % size;
+			const int y = index / (size * size);
+
+			faces |= (x == 0 ? 1 << Direction::NEGATIVE_X : 0) | (x == size - 1 ? 1 << Direction::POSITIVE_X : 0);
+			faces |= (y == 0 ? 1 << Direction::NEGATIVE_Y : 0) | (y == size - 1 ? 1 << Direction::POSITIVE_Y : 0);
+			faces |= (z == 0 ? 1 << Direction::NEGATIVE_Z : 0) | (z == size - 1 ? 1 << Direction::POSITIVE_Z : 0);
+
+			const int neighbors[Direction::COUNT] = {
+				x > 0 ? index - 1 : -1,
+				x < size - 1 ? index + 1 : -1,
+				y > 0 ? index - size * size : -1,
+				y < size - 1 ? index + size * size : -1,
+				z > 0 ? index - size : -1,
+				z < size - 1 ? index + size : -1
+			};
+			for (int neighbor : neighbors) {
+				if (neighbor >= 0 && !visited[neighbor]) {
+					visited[neighbor] = 1;
+					stack.push_back(neighbor);
+				}
+			}
+		}
+
+		for (int a = 0; a < Direction::COUNT; ++a) {
+			for (int b = a; b < Direction::COUNT; ++b) {
+				if ((faces & (1 << a)) && (faces & (1 << b))) {
+					connectivity.connect(a, b);
+				}
+			}
+		}
+	}
+	return connectivity;
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,61 @@
+// chunk_visibility.h
+
+#ifndef CHUNK_VISIBILITY_H
+#define CHUNK_VISIBILITY_H
+
+#include "direction.h"
+#include "voxel_buffer.h"
+
+#include <cstdint>
+
+// Godot includes
+#include <godot_cpp/variant/aabb.hpp>
+#include <godot_cpp/variant/plane.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+using namespace godot;
+
+namespace voxel_engine {
+
+// Which faces of a chunk can see each other through the chunk. Two faces are
+// connected when one connected region of non-opaque voxels touches both.
+// Conservative: it never reports two faces as separated when they aren't.
+struct FaceConnectivity {
+	uint64_t bits = 0; // Bit a * 6 + b set when faces a and b are connected
+
+	inline void connect(int a, int b) {
+		bits |= (1ull << (a * Direction::COUNT + b)) | (1ull << (b * Direction::COUNT + a));
+	}
+	inline bool connects(int a, int b) const {
+		return (bits >> (a * Direction::COUNT + b)) & 1;
+	}
+	void connect_all() {
+		bits = (1ull << (Direction::COUNT * Direction::COUNT)) - 1;
+	}
+};
+
+// Flood fills the non-opaque voxels of the chunk inside a padded buffer
+// (chunk voxel (x, y, z) at (x + 1, y + 1, z + 1), as for ChunkMesher)
+FaceConnectivity compute_face_connectivity(const VoxelBuffer &padded);
+
+// True when the box is entirely outside one of the planes. Planes are the
+// ones returned by Camera3D::get_frustum(), normals pointing out of the frustum.
+inline bool is_aabb_outside_planes(const AABB &box, const Plane *planes, int plane_count) {
+	const Vector3 end = box.position + box.size;
+	for (int i = 0; i < plane_count; ++i) {
+		const Plane &plane = planes[i];
+		// Corner furthest inside the plane
+		const Vector3 corner(
+				plane.normal.x > 0.0f ? box.position.x : end.x,
+				plane.normal.y > 0.0f ? box.position.y : end.y,
+				plane.normal.z > 0.0f ? box.position.z : end.z);
+		if (plane.distance_to(corner) > 0.0f) {
+			return true;
+		}
+	}
+	return false;
+}
+
+} // namespace voxel_engine
+
+#endif // CHUNK_VISIBILITY_H
@@ -0,0 +1,152 @@
+#include "density_field.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace voxel_engine {
+
+void DensityField::create(const Vector3i &p_point_dims, const Vector3 &p_origin, float p_spacing) {
+	point_dims = Vector3i(MAX(p_point_dims.x, 2), MAX(p_point_dims.y, 2), MAX(p_point_dims.z, 2));
+	origin = p_origin;
+	spacing = p_spacing;
+	values.assign((size_t)point_dims.x * point_dims.y * point_dims.z, 0.0f);
+	init_levels();
+}
+
+int64_t DensityField::get_memory_usage() const {
+	int64_t bytes = (int64_t)(values.capacity() * sizeof(float));
+	for (const Level &level : levels) {
+		bytes += (int64_t)((level.min_values.capacity() + level.max_values.capacity()) * sizeof(float));
+	}
+	return bytes;
+}
+
+float DensityField::sample_trilinear(const Vector3 &position) const {
+	const Vector3 grid = (position - origin) / spacing;
+	const Vector3i last = point_dims - Vector3i(1, 1, 1);
+	const float gx = CLAMP(grid.x, 0.0f, (float)last.x);
+	const float gy = CLAMP(grid.y, 0.0f, (float)last.y);
+	const float gz = CLAMP(grid.z, 0.0f, (float)last.z);
+	const int x0 = MIN((int)gx, last.x - 1);
+	const int y0 = MIN((int)gy, last.y - 1);
+	const int z0 = MIN((int)gz, last.z - 1);
+	const float tx = gx - x0;
+	const float ty = gy - y0;
+	const float tz = gz - z0;
+
+	const float c00 = Math::lerp(get(x0, y0, z0), get(x0 + 1, y0, z0), tx);
+	const float c10 = Math::lerp(get(x0, y0 + 1, z0), get(x0 + 1, y0 + 1, z0), tx);
+	const float c01 = Math::lerp(get(x0, y0, z0 + 1), get(x0 + 1, y0, z0 + 1), tx);
+	const float c11 = Math::lerp(get(x0, y0 + 1, z0 + 1), get(x0 + 1, y0 + 1, z0 + 1), tx);
+	return Math::lerp(Math::lerp(c00, c10, ty), Math::lerp(c01, c11, ty), tz);
+}
+
+void DensityField::init_levels() {
+	levels.clear();
+
+	const Vector3i cells = get_cell_dims();
+	Vector3i dims(
+			(cells.x + BRICK_SIZE - 1) / BRICK_SIZE,
+			(cells.y + BRICK_SIZE - 1) / BRICK_SIZE,
+			(cells.z + BRICK_SIZE - 1) / BRICK_SIZE);
+
+	// Halve until a single brick covers the whole field
+	while (true) {
+		Level level;
+		level.dims = dims;
+		const size_t count = (size_t)dims.x * dims.y * dims.z;
+		level.min_values.assign(count, std::numeric_limits<float>::max());
+		level.max_values.assign(count, std::numeric_limits<float>::lowest());
+		levels.push_back(std::move(level));
+
+		if (dims.x == 1 && dims.y == 1 && dims.z == 1) {
+			break;
+		}
+		dims = Vector3i((dims.x + 1) / 2, (dims.y + 1) / 2, (dims.z + 1) / 2);
+	}
+}
+
+void DensityField::compute_brick(int x, int y, int z) {
+	const Vector3i from(x * BRICK_SIZE, y * BRICK_SIZE, z * BRICK_SIZE);
+	const Vector3i to(
+			MIN(from.x + BRICK_SIZE, point_dims.x - 1),
+			MIN(from.y + BRICK_SIZE, point_dims.y - 1),
+			MIN(from.z + BRICK_SIZE, point_dims.z - 1));
+
+	float min_value = std::numeric_limits<float>::max();
+	float max_value = std::numeric_limits<float>::lowest();
+	for (int pz = from.z; pz <= to.z; ++pz) {
+		for (int py = from.y; py <= to.y; ++py) {
+			const float *row = values.data() + get_index(from.x, py, pz);
+			for (int px = 0; px <= to.x - from.x; ++px) {
+				min_value = std::min(min_value, row[px]);
+				max_value = std::max(max_value, row[px]);
+			}
+		}
+	}
+
+	Level &base = levels[0];
+	const int index = base.get_index(x, y, z);
+	base.min_values[index] = min_value;
+	base.max_values[index] = max_value;
+}
+
+void DensityField::merge_parent(int level, int x, int y, int z) {
+	const Level &child = levels[level - 1];
+	Level &parent = levels[level];
+
+	float min_value = std::numeric_limits<float>::max();
+	float max_value = std::numeric_limits<float>::lowest();
+	for (int cz = z * 2; cz < MIN(z * 2 + 2, child.dims.z); ++cz) {
+		for (int cy = y * 2; cy < MIN(y * 2 + 2, child.dims.y); ++cy) {
+			for (int cx = x * 2; cx < MIN(x * 2 + 2, child.dims.x); ++cx) {
+				const int index = child.get_index(cx, cy, cz);
+				min_value = std::min(min_value, child.min_values[index]);
+				max_value = std::max(max_value, child.max_values[index]);
+			}
+		}
+	}
+
+	const int index = parent.get_index(x, y, z);
+	parent.min_values[index] = min_value;
+	parent.max_values[index] = max_value;
+}
+
+void DensityField::update_bounds(const Vector3i &point_from, const Vector3i &point_to) {
+	const Level &base = levels[0];
+	const Vector3i from = point_from.clamp(Vector3i(), point_dims - Vector3i(1, 1, 1));
+	const Vector3i to = point_to.clamp(Vector3i(), point_dims - Vector3i(1, 1, 1));
+
+	// Border points are shared with the previous brick, widen the range by one point
+	Vector3i brick_from(
+			MAX(from.x - 1, 0) / BRICK_SIZE,
+			MAX(from.y - 1, 0) / BRICK_SIZE,
+			MAX(from.z - 1, 0) / BRICK_SIZE);
+	Vector3i brick_to(
+			MIN(to.x / BRICK_SIZE, base.dims.x - 1),
+			MIN(to.y / BRICK_SIZE, base.dims.y - 1),
+			MIN(to.z / BRICK_SIZE, base.dims.z - 1));
+
+	for (int z = brick_from.z; z <= brick_to.z; ++z) {
+		for (int y = brick_from.y; y <= brick_to.y; ++y) {
+			for (int x = brick_from.x; x <= brick_to.x; ++x) {
+				compute_brick(x, y, z);
+			}
+		}
+	}
+
+	// Only the ancestors of the touched bricks change
+	for (int level = 1; level < (int)levels.size(); ++level) {
+		brick_from = Vector3i(brick_from.x / 2, brick_from.y / 2, brick_from.z / 2);
+		brick_to = Vector3i(brick_to.x / 2, brick_to.y / 2, brick_to.z / 2);
+		for (int z = brick_from.z; z <= brick_to.z; ++z) {
+			for (int y = brick_from.y; y <= brick_to.y; ++y) {
+				for (int x = brick_from.x; x <= brick_to.x; ++x) {
+					merge_parent(level, x, y, z);
+				}
+			}
+		}
+	}
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,128 @@
+// density_field.h
+
+#ifndef DENSITY_FIELD_H
+#define DENSITY_FIELD_H
+
+#include <cstdint>
+#include <vector>
+
+// Godot includes
+#include <godot_cpp/variant/vector3.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+using namespace godot;
+
+namespace voxel_engine {
+
+// Scalar field sampled on a regular grid of points, the input of the smooth
+// meshers. Points are stored X-fastest, then Y, then Z.
+//
+// Alongside the samples it keeps a min/max pyramid: level 0 holds the bounds of
+// each BRICK_SIZE^3 block of cells (including the shared border points), every
+// further level merges 2x2x2 bricks of the level below. A brick whose bounds
+// don't straddle the iso value cannot contain any surface and is skipped whole.
+class DensityField {
+public:
+	static constexpr int BRICK_SIZE = 8; // Cells per brick edge at level 0
+
+	struct Level {
+		Vector3i dims; // Bricks per axis
+		std::vector<float> min_values;
+		std::vector<float> max_values;
+
+		inline int get_index(int x, int y, int z) const { return x + dims.x * (y + dims.y * z); }
+	};
+
+	// `p_point_dims` points per axis, i.e. one less cell per axis
+	void create(const Vector3i &p_point_dims, const Vector3 &p_origin, float p_spacing);
+
+	const Vector3i &get_point_dims() const { return point_dims; }
+	Vector3i get_cell_dims() const { return point_dims - Vector3i(1, 1, 1); }
+	const Vector3 &get_origin() const { return origin; }
+	float get_spacing() const { return spacing; }
+
+	inline int get_index(int x, int y, int z) const { return x + point_dims.x * (y + point_dims.y * z); }
+	inline float get(int x, int y, int z) const { return values[get_index(x, y, z)]; }
+	inline Vector3 get_point_position(int x, int y, int z) const { return origin + Vector3(x, y, z) * spacing; }
+	const float *ptr() const { return values.data(); }
+	int64_t get_memory_usage() const;
+	// Trilinear value at a position, clamped to the grid
+	float sample_trilinear(const Vector3 &position) const;
+
+	// Samples every point with `sample(Vector3 position) -> float` and builds the
+	// brick bounds in the same pass.
+	template <typename Sampler>
+	void fill(Sampler &&sample);
+
+	// Edits. Bounds of the touched bricks are refreshed by update_bounds(),
+	// which only revisits those bricks and their parents.
+	inline void set(int x, int y, int z, float value) { values[get_index(x, y, z)] = value; }
+	void update_bounds(const Vector3i &point_from, const Vector3i &point_to);
+
+	int get_level_count() const { return (int)levels.size(); }
+	const Level &get_level(int level) const { return levels[level]; }
+
+	// Whether any cell of brick (x, y, z) at `level` can have corners on both sides of `iso`
+	inline bool brick_may_contain_surface(int level, int x, int y, int z, float iso) const {
+		const Level &l = levels[level];
+		const int index = l.get_index(x, y, z);
+		return l.min_values[index] < iso && l.max_values[index] >= iso;
+	}
+
+private:
+	void init_levels();
+	void compute_brick(int x, int y, int z);
+	void merge_parent(int level, int x, int y, int z);
+
+	Vector3i point_dims;
+	Vector3 origin;
+	float spacing = 1.0f;
+	std::vector<float> values;
+	std::vector<Level> levels;
+};
+
+template <typename Sampler>
+void DensityField::fill(Sampler &&sample) {
+	Level &base = levels[0];
+	for (int z = 0; z < point_dims.z; ++z) {
+		// A point on a brick border belongs to both bricks
+		const int bz1 = MIN(z / BRICK_SIZE, base.dims.z - 1);
+		const int bz0 = (z % BRICK_SIZE == 0 && z > 0) ? bz1 - 1 : bz1;
+		for (int y = 0; y < point_dims.y; ++y) {
+			const int by1 = MIN(y / BRICK_SIZE, base.dims.y - 1);
+			const int by0 = (y % BRICK_SIZE == 0 && y > 0) ? by1 - 1 : by1;
+			for (int x = 0; x < point_dims.x; ++x) {
+				const int bx1 = MIN(x / BRICK_SIZE, base.dims.x - 1);
+				const int bx0 = (x % BRICK_SIZE == 0 && x > 0) ? bx1 - 1 : bx1;
+
+				const float value = sample(get_point_position(x, y, z));
+				values[get_index(x, y, z)] = value;
+
+				for (int bz = bz0; bz <= bz1; ++bz) {
+					for (int by = by0; by <= by1; ++by) {
+						for (int bx = bx0; bx <= bx1; ++bx) {
+							const int index = base.get_index(bx, by, bz);
+							base.min_values[index] = MIN(base.min_values[index], value);
+							base.max_values[index] = MAX(base.max_values[index], value);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	for (int level = 1; level < (int)levels.size(); ++level) {
+		const Level &l = levels[level];
+		for (int z = 0; z < l.dims.z; ++z) {
+			for (int y = 0; y < l.dims.y; ++y) {
+				for (int x = 0; x < l.dims.x; ++x) {
+					merge_parent(level, x, y, z);
+				}
+			}
+		}
+	}
+}
+
+} // namespace voxel_engine
+
+#endif // DENSITY_FIELD_H
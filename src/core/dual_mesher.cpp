@@ -0,0 +1,237 @@
+#include "dual_mesher.h"
+
+#include <cmath>
+
+namespace voxel_engine {
+
+namespace {
+
+const Vector3i CORNER_OFFSETS[8] = {
+	Vector3i(0, 0, 0), Vector3i(1, 0, 0), Vector3i(0, 1, 0), Vector3i(1, 1, 0),
+	Vector3i(0, 0, 1), Vector3i(1, 0, 1), Vector3i(0, 1, 1), Vector3i(1, 1, 1)
+};
+
+// The 12 cell edges as corner pairs, corners indexed by their (x, y, z) bits
+const int EDGE_CORNERS[12][2] = {
+	{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, // Along x
+	{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 }, // Along y
+	{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 } // Along z
+};
+
+// Pulls the QEF solution toward the mass point. Keeps flat and degenerate
+// cells stable without an SVD, barely moves vertices on real features.
+const float QEF_REGULARIZATION = 0.05f;
+
+// Field gradient by central differences, points toward increasing values
+Vector3 get_gradient(const DensityField &field, const Vector3 &position) {
+	const float h = 0.5f * field.get_spacing();
+	return Vector3(
+			field.sample_trilinear(position + Vector3(h, 0, 0)) - field.sample_trilinear(position - Vector3(h, 0, 0)),
+			field.sample_trilinear(position + Vector3(0, h, 0)) - field.sample_trilinear(position - Vector3(0, h, 0)),
+			field.sample_trilinear(position + Vector3(0, 0, h)) - field.sample_trilinear(position - Vector3(0, 0, h)));
+}
+
+// Minimizes sum((n_i . (x - p_i))^2) + w * |x - mass_point|^2 by solving the
+// regularized normal equations, relative to the mass point
+Vector3 solve_qef(const Vector3 *points, const Vector3 *normals, int count, const Vector3 &mass_point, float weight) {
+	float ata[3][3] = {};
+	float atb[3] = {};
+	for (int i = 0; i < count; ++i) {
+		const Vector3 &n = normals[i];
+		const float d = n.dot(points[i] - mass_point);
+		for (int r = 0; r < 3; ++r) {
+			for (int c = 0; c < 3; ++c) {
+				ata[r][c] += n[r] * n[c];
+			}
+			atb[r] += n[r] * d;
+		}
+	}
+	for (int i = 0; i < 3; ++i) {
+		ata[i][i] += weight;
+	}
+
+	// Cramer's rule, the matrix is symmetric positive definite
+	const float det = ata[0][0] * (ata[1][1] * ata[2][2] - ata[1][2] * ata[2][1]) -
+			ata[0][1] * (ata[1][0] * ata[2][2] - ata[1][2] * ata[2][0]) +
+			ata[0][2] * (ata[1][0] * ata[2][1] - ata[1][1] * ata[2][0]);
+	if (std::abs(det) < 1e-12f) {
+		return mass_point;
+	}
+	Vector3 x;
+	for (int k = 0; k < 3; ++k) {
+		float m[3][3];
+		for (int r = 0; r < 3; ++r) {
+			for (int c = 0; c < 3; ++c) {
+				m[r][c] = c == k ? atb[r] : ata[r][c];
+			}
+		}
+		x[k] = (m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+					   m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+					   m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0])) /
+				det;
+	}
+	return mass_point + x;
+}
+
+} // namespace
+
+void DualMesher::build(const DensityField &field, float iso, Mode mode, bool ambient_occlusion, MeshData &r_mesh, Stats *r_stats, std::vector<Vector3> *r_active_cells) {
+	Stats stats;
+	const Vector3i cells = field.get_cell_dims();
+	const float spacing = field.get_spacing();
+	auto get_cell_index = [&cells](int x, int y, int z) {
+		return x + cells.x * (y + cells.y * z);
+	};
+	// Vertex of each cell, -1 where the surface doesn't pass
+	std::vector<int32_t> cell_vertices((size_t)cells.x * cells.y * cells.z, -1);
+	const int32_t base_vertex = (int32_t)r_mesh.vertices.size();
+
+	// Pass 1: a vertex per crossed cell. Bricks whose bounds don't straddle
+	// `iso` are skipped whole, as in the marching cubes path.
+	const DensityField::Level &bricks = field.get_level(0);
+	for (int bz = 0; bz < bricks.dims.z; ++bz) {
+		for (int by = 0; by < bricks.dims.y; ++by) {
+			for (int bx = 0; bx < bricks.dims.x; ++bx) {
+				const Vector3i begin = Vector3i(bx, by, bz) * DensityField::BRICK_SIZE;
+				const Vector3i end(
+						MIN(begin.x + DensityField::BRICK_SIZE, cells.x),
+						MIN(begin.y + DensityField::BRICK_SIZE, cells.y),
+						MIN(begin.z + DensityField::BRICK_SIZE, cells.z));
+				const uint64_t brick_cells = (uint64_t)(end.x - begin.x) * (end.y - begin.y) * (end.z - begin.z);
+				if (!field.brick_may_contain_surface(0, bx, by, bz, iso)) {
+					stats.cells_skipped += brick_cells;
+					stats.bricks_skipped++;
+					continue;
+				}
+				stats.cells_visited += brick_cells;
+
+				for (int z = begin.z; z < end.z; ++z) {
+					for (int y = begin.y; y < end.y; ++y) {
+						for (int x = begin.x; x < end.x; ++x) {
+							float values[8];
+							int mask = 0;
+							for (int i = 0; i < 8; ++i) {
+								values[i] = field.get(x + CORNER_OFFSETS[i].x, y + CORNER_OFFSETS[i].y, z + CORNER_OFFSETS[i].z);
+								if (values[i] < iso) {
+									mask |= 1 << i;
+								}
+							}
+							if (mask == 0 || mask == 255) {
+								continue;
+							}
+
+							Vector3 crossings[12];
+							int crossing_count = 0;
+							Vector3 mass_point;
+							for (int e = 0; e < 12; ++e) {
+								const int a = EDGE_CORNERS[e][0];
+								const int b = EDGE_CORNERS[e][1];
+								if (((mask >> a) & 1) == ((mask >> b) & 1)) {
+									continue;
+								}
+								const float t = (iso - values[a]) / (values[b] - values[a]);
+								const Vector3 pa = field.get_point_position(x + CORNER_OFFSETS[a].x, y + CORNER_OFFSETS[a].y, z + CORNER_OFFSETS[a].z);
+								const Vector3 pb = field.get_point_position(x + CORNER_OFFSETS[b].x, y + CORNER_OFFSETS[b].y, z + CORNER_OFFSETS[b].z);
+								crossings[crossing_count] = pa + (pb - pa) * t;
+								mass_point += crossings[crossing_count];
+								crossing_count++;
+							}
+							mass_point /= (float)crossing_count;
+
+							Vector3 vertex = mass_point;
+							if (mode == DUAL_CONTOURING) {
+								Vector3 normals[12];
+								for (int i = 0; i < crossing_count; ++i) {
+									normals[i] = get_gradient(field, crossings[i]).normalized();
+								}
+								vertex = solve_qef(crossings, normals, crossing_count, mass_point, QEF_REGULARIZATION);
+								// A solution outside the cell folds the mesh, keep it inside
+								const Vector3 cell_min = field.get_point_position(x, y, z);
+								const Vector3 cell_max = cell_min + Vector3(spacing, spacing, spacing);
+								if (vertex.x < cell_min.x || vertex.y < cell_min.y || vertex.z < cell_min.z ||
+										vertex.x > cell_max.x || vertex.y > cell_max.y || vertex.z > cell_max.z) {
+									vertex = mass_point;
+								}
+							}
+
+							// Same facing as the marching cubes output: toward rising values
+							const Vector3 normal = get_gradient(field, vertex).normalized();
+							cell_vertices[get_cell_index(x, y, z)] = (int32_t)r_mesh.vertices.size();
+							r_mesh.vertices.push_back(vertex);
+							r_mesh.normals.push_back(normal);
+							if (ambient_occlusion) {
+								const float brightness = MarchingCubesMesher::compute_occlusion(field, iso, vertex, normal);
+								r_mesh.colors.push_back(Color(brightness, brightness, brightness));
+							}
+							if (r_active_cells) {
+								r_active_cells->push_back(field.get_point_position(x, y, z) + Vector3(0.5f, 0.5f, 0.5f) * spacing);
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Pass 2: a quad per crossed grid edge. The edge from point (x, y, z) along
+	// `axis` is shared by cell (x, y, z) and the three cells below it on the
+	// other two axes; it is emitted once, from cell (x, y, z).
+	if (r_mesh.indices.empty() && base_vertex > 0) {
+		// Appending to a soup, give it indices first
+		for (int32_t i = 0; i < base_vertex; ++i) {
+			r_mesh.indices.push_back(i);
+		}
+	}
+	for (int z = 0; z < cells.z; ++z) {
+		for (int y = 0; y < cells.y; ++y) {
+			for (int x = 0; x < cells.x; ++x) {
+				if (cell_vertices[get_cell_index(x, y, z)] < 0) {
+					continue;
+				}
+				const Vector3i cell(x, y, z);
+				const bool inside = field.get(x, y, z) < iso;
+				for (int axis = 0; axis < 3; ++axis) {
+					const int u = (axis + 1) % 3;
+					const int v = (axis + 2) % 3;
+					if (cell[u] == 0 || cell[v] == 0) {
+						continue;
+					}
+					Vector3i far = cell;
+					far[axis] += 1;
+					if ((field.get(far.x, far.y, far.z) < iso) == inside) {
+						continue;
+					}
+
+					Vector3i du;
+					du[u] = 1;
+					Vector3i dv;
+					dv[v] = 1;
+					const Vector3i around[4] = { cell, cell - du, cell - du - dv, cell - dv };
+					int32_t quad[4];
+					for (int i = 0; i < 4; ++i) {
+						quad[i] = cell_vertices[get_cell_index(around[i].x, around[i].y, around[i].z)];
+					}
+					// Winding follows the crossing direction, so faces agree with the normals
+					if (inside) {
+						std::swap(quad[1], quad[3]);
+					}
+					// Split along the shorter diagonal
+					const float d02 = r_mesh.vertices[quad[0]].distance_squared_to(r_mesh.vertices[quad[2]]);
+					const float d13 = r_mesh.vertices[quad[1]].distance_squared_to(r_mesh.vertices[quad[3]]);
+					if (d02 <= d13) {
+						r_mesh.indices.insert(r_mesh.indices.end(), { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] });
+					} else {
+						r_mesh.indices.insert(r_mesh.indices.end(), { quad[0], quad[1], quad[3], quad[1], quad[2], quad[3] });
+					}
+					stats.triangles += 2;
+				}
+			}
+		}
+	}
+
+	if (r_stats) {
+		*r_stats = stats;
+	}
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,38 @@
+// dual_mesher.h
+
+#ifndef DUAL_MESHER_H
+#define DUAL_MESHER_H
+
+#include "density_field.h"
+#include "marching_cubes_mesher.h"
+#include "mesh_data.h"
+
+#include <vector>
+
+namespace voxel_engine {
+
+// Dual meshers over the same DensityField as MarchingCubesMesher: one vertex
+// per cell crossed by the surface, one quad per grid edge crossed by it,
+// joining the four cells around the edge. That is about half the triangles of
+// marching cubes, with no slivers, and the output is indexed.
+//
+// SURFACE_NETS puts the vertex at the average of the cell's edge crossings,
+// which rounds everything off. DUAL_CONTOURING solves a QEF over the crossings
+// and their field normals instead, so vertices land on creases and corners
+// and sharp features survive.
+class DualMesher {
+public:
+	enum Mode {
+		SURFACE_NETS,
+		DUAL_CONTOURING
+	};
+	using Stats = MarchingCubesMesher::Stats;
+
+	// Same contract as MarchingCubesMesher::build(). Vertices get smooth
+	// normals from the field gradient.
+	static void build(const DensityField &field, float iso, Mode mode, bool ambient_occlusion, MeshData &r_mesh, Stats *r_stats = nullptr, std::vector<Vector3> *r_active_cells = nullptr);
+};
+
+} // namespace voxel_engine
+
+#endif // DUAL_MESHER_H
@@ -0,0 +1,380 @@
+#include "edit_journal.h"
+#include "voxel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace voxel_engine {
+
+namespace {
+
+const uint8_t MAGIC[4] = { 'V', 'X', 'E', 'D' };
+constexpr uint32_t FORMAT_VERSION = 1;
+
+void write_u32(uint32_t value, std::vector<uint8_t> &r_bytes) {
+	for (int i = 0; i < 4; ++i) {
+		r_bytes.push_back((uint8_t)(value >> (i * 8)));
+	}
+}
+
+void write_varint(uint32_t value, std::vector<uint8_t> &r_bytes) {
+	while (value >= 0x80) {
+		r_bytes.push_back((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	r_bytes.push_back((uint8_t)value);
+}
+
+// Small negative coordinates stay small
+void write_zigzag(int32_t value, std::vector<uint8_t> &r_bytes) {
+	write_varint(((uint32_t)value << 1) ^ (uint32_t)(value >> 31), r_bytes);
+}
+
+void write_float(float value, std::vector<uint8_t> &r_bytes) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	write_u32(bits, r_bytes);
+}
+
+// Reads stop at the end of the data and report it instead of overrunning
+struct Reader {
+	const uint8_t *data;
+	size_t length;
+	size_t offset = 0;
+	bool failed = false;
+
+	uint8_t read_u8() {
+		if (offset >= length) {
+			failed = true;
+			return 0;
+		}
+		return data[offset++];
+	}
+	uint32_t read_u32() {
+		uint32_t value = 0;
+		for (int i = 0; i < 4; ++i) {
+			value |= (uint32_t)read_u8() << (i * 8);
+		}
+		return value;
+	}
+	uint32_t read_varint() {
+		uint32_t value = 0;
+		for (int shift = 0; shift < 35; shift += 7) {
+			const uint8_t byte = read_u8();
+			value |= (uint32_t)(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) {
+				return value;
+			}
+		}
+		failed = true;
+		return 0;
+	}
+	int32_t read_zigzag() {
+		const uint32_t value = read_varint();
+		return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+	}
+	float read_float() {
+		const uint32_t bits = read_u32();
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+};
+
+void write_record(const EditJournal::Record &record, uint32_t from_version, std::vector<uint8_t> &r_bytes) {
+	r_bytes.push_back(record.type);
+	write_varint(record.version - from_version, r_bytes);
+	if (record.type == EditJournal::RECORD_VOXEL) {
+		write_varint(record.index, r_bytes);
+		r_bytes.push_back(record.old_type);
+		r_bytes.push_back(record.new_type);
+	} else {
+		write_float(record.point.x, r_bytes);
+		write_float(record.point.y, r_bytes);
+		write_float(record.point.z, r_bytes);
+		write_float(record.strength, r_bytes);
+		write_float(record.radius, r_bytes);
+	}
+}
+
+bool is_version_less(const EditJournal::Record &a, const EditJournal::Record &b) {
+	return a.version < b.version;
+}
+
+} // namespace
+
+EditJournal::ChunkJournal &EditJournal::get_or_create(const Vector3i &chunk_coord) {
+	ChunkJournal *journal = chunks.getptr(chunk_coord);
+	if (!journal) {
+		journal = &chunks.insert(chunk_coord, ChunkJournal())->value;
+	}
+	return *journal;
+}
+
+uint32_t EditJournal::record_voxel(const Vector3i &chunk_coord, uint16_t index, uint8_t old_type, uint8_t new_type) {
+	ChunkJournal &journal = get_or_create(chunk_coord);
+	Record record;
+	record.version = ++journal.version;
+	record.type = RECORD_VOXEL;
+	record.index = index;
+	record.old_type = old_type;
+	record.new_type = new_type;
+	journal.records.push_back(record);
+	if (journal.records.size() >= COMPACTION_THRESHOLD) {
+		compact(journal);
+	}
+	return journal.version;
+}
+
+uint32_t EditJournal::record_brush(const Vector3i &chunk_coord, const Vector3 &point, float strength, float radius) {
+	ChunkJournal &journal = get_or_create(chunk_coord);
+	Record record;
+	record.version = ++journal.version;
+	record.type = RECORD_BRUSH;
+	record.point = point;
+	record.strength = strength;
+	record.radius = radius;
+	journal.records.push_back(record);
+	if (journal.records.size() >= COMPACTION_THRESHOLD) {
+		compact(journal);
+	}
+	return journal.version;
+}
+
+uint32_t EditJournal::get_version(const Vector3i &chunk_coord) const {
+	const ChunkJournal *journal = chunks.getptr(chunk_coord);
+	return journal ? journal->version : 0;
+}
+
+void EditJournal::get_versions(HashMap<Vector3i, uint32_t> &r_versions) const {
+	for (const KeyValue<Vector3i, ChunkJournal> &entry : chunks) {
+		r_versions.insert(entry.key, entry.value.version);
+	}
+}
+
+void EditJournal::serialize_since(const HashMap<Vector3i, uint32_t> &known_versions, std::vector<uint8_t> &r_bytes) const {
+	r_bytes.insert(r_bytes.end(), MAGIC, MAGIC + 4);
+	write_u32(FORMAT_VERSION, r_bytes);
+
+	std::vector<const KeyValue<Vector3i, ChunkJournal> *> changed;
+	for (const KeyValue<Vector3i, ChunkJournal> &entry : chunks) {
+		const uint32_t *known = known_versions.getptr(entry.key);
+		if (entry.value.version > (known ? *known : 0)) {
+			changed.push_back(&entry);
+		}
+	}
+	write_varint((uint32_t)changed.size(), r_bytes);
+
+	std::vector<const Record *> records;
+	for (const KeyValue<Vector3i, ChunkJournal> *entry : changed) {
+		const ChunkJournal &journal = entry->value;
+		const uint32_t *known = known_versions.getptr(entry->key);
+		const uint32_t from_version = known ? *known : 0;
+
+		records.clear();
+		for (const Record &record : journal.snapshot_voxels) {
+			// Starting from the generated world, voxels edited back to their
+			// original type have nothing to say
+			if (record.version > from_version && (from_version > 0 || record.new_type != record.old_type)) {
+				records.push_back(&record);
+			}
+		}
+		for (const std::vector<Record> *list : { &journal.snapshot_brushes, &journal.records }) {
+			for (const Record &record : *list) {
+				if (record.version > from_version) {
+					records.push_back(&record);
+				}
+			}
+		}
+
+		write_zigzag(entry->key.x, r_bytes);
+		write_zigzag(entry->key.y, r_bytes);
+		write_zigzag(entry->key.z, r_bytes);
+		write_varint(from_version, r_bytes);
+		write_varint(journal.version, r_bytes);
+		write_varint((uint32_t)records.size(), r_bytes);
+		for (const Record *record : records) {
+			write_record(*record, from_version, r_bytes);
+		}
+	}
+}
+
+bool EditJournal::is_valid_brush(const Vector3 &point, float strength, float radius) {
+	return std::isfinite(point.x) && std::isfinite(point.y) && std::isfinite(point.z) &&
+			std::isfinite(strength) && std::abs(strength) <= MAX_BRUSH_STRENGTH &&
+			radius > 0.0f && radius <= MAX_BRUSH_RADIUS;
+}
+
+bool EditJournal::deserialize(const uint8_t *data, size_t length, int chunk_size, std::vector<ChunkDelta> &r_deltas) {
+	r_deltas.clear();
+	if (length < 8 || memcmp(data, MAGIC, 4) != 0) {
+		return false;
+	}
+	Reader reader{ data, length, 4 };
+	if (reader.read_u32() > FORMAT_VERSION) {
+		return false;
+	}
+
+	const uint32_t chunk_count = reader.read_varint();
+	for (uint32_t i = 0; i < chunk_count && !reader.failed; ++i) {
+		ChunkDelta delta;
+		delta.coord.x = reader.read_zigzag();
+		delta.coord.y = reader.read_zigzag();
+		delta.coord.z = reader.read_zigzag();
+		delta.from_version = reader.read_varint();
+		delta.to_version = reader.read_varint();
+		const uint32_t record_count = reader.read_varint();
+		// Every record takes at least 3 bytes, a bogus count fails here
+		// instead of reserving gigabytes
+		if (reader.failed || record_count > (length - reader.offset) / 3) {
+			return false;
+		}
+		delta.records.resize(record_count);
+		// Records that don't fit in this chunk would land in a neighbor without
+		// bumping its version
+		const uint32_t volume = (uint32_t)(chunk_size * chunk_size * chunk_size);
+		const Vector3 chunk_from = Vector3(delta.coord) * (float)chunk_size;
+		const Vector3 chunk_to = chunk_from + Vector3(chunk_size, chunk_size, chunk_size);
+		for (Record &record : delta.records) {
+			const uint8_t type = reader.read_u8();
+			record.version = delta.from_version + reader.read_varint();
+			if (type == RECORD_VOXEL) {
+				record.type = RECORD_VOXEL;
+				const uint32_t index = reader.read_varint();
+				record.index = (uint16_t)index;
+				record.old_type = reader.read_u8();
+				record.new_type = reader.read_u8();
+				if (index >= volume || record.old_type >= VOXEL_TYPE_COUNT || record.new_type >= VOXEL_TYPE_COUNT) {
+					return false;
+				}
+			} else if (type == RECORD_BRUSH) {
+				record.type = RECORD_BRUSH;
+				record.point.x = reader.read_float();
+				record.point.y = reader.read_float();
+				record.point.z = reader.read_float();
+				record.strength = reader.read_float();
+				record.radius = reader.read_float();
+				const Vector3 &point = record.point;
+				if (!is_valid_brush(point, record.strength, record.radius) ||
+						point.x < chunk_from.x || point.y < chunk_from.y || point.z < chunk_from.z ||
+						point.x >= chunk_to.x || point.y >= chunk_to.y || point.z >= chunk_to.z) {
+					return false;
+				}
+			} else {
+				return false;
+			}
+			if (record.version <= delta.from_version || record.version > delta.to_version) {
+				return false;
+			}
+		}
+		r_deltas.push_back(std::move(delta));
+	}
+	return !reader.failed;
+}
+
+bool EditJournal::merge(const ChunkDelta &delta, std::vector<Record> &r_new_records) {
+	const uint32_t local_version = get_version(delta.coord);
+	if (local_version >= delta.to_version) {
+		return true;
+	}
+	if (local_version < delta.from_version) {
+		return false;
+	}
+
+	const size_t first_new = r_new_records.size();
+	for (const Record &record : delta.records) {
+		if (record.version > local_version) {
+			r_new_records.push_back(record);
+		}
+	}
+	// Snapshot entries arrive sorted by index, replay goes by version
+	std::stable_sort(r_new_records.begin() + first_new, r_new_records.end(), is_version_less);
+
+	ChunkJournal &journal = get_or_create(delta.coord);
+	journal.records.insert(journal.records.end(), r_new_records.begin() + first_new, r_new_records.end());
+	journal.version = delta.to_version;
+	if (journal.records.size() >= COMPACTION_THRESHOLD) {
+		compact(journal);
+	}
+	return true;
+}
+
+void EditJournal::compact(ChunkJournal &journal) {
+	for (const Record &record : journal.records) {
+		if (record.type == RECORD_BRUSH) {
+			journal.snapshot_brushes.push_back(record);
+			continue;
+		}
+		std::vector<Record>::iterator it = std::lower_bound(journal.snapshot_voxels.begin(), journal.snapshot_voxels.end(), record,
+				[](const Record &a, const Record &b) { return a.index < b.index; });
+		if (it != journal.snapshot_voxels.end() && it->index == record.index) {
+			// Keeps the type from before the first edit
+			it->new_type = record.new_type;
+			it->version = record.version;
+		} else {
+			journal.snapshot_voxels.insert(it, record);
+		}
+	}
+	journal.records.clear();
+}
+
+void EditJournal::compact() {
+	for (KeyValue<Vector3i, ChunkJournal> &entry : chunks) {
+		compact(entry.value);
+	}
+}
+
+void EditJournal::compact_chunk(const Vector3i &chunk_coord) {
+	ChunkJournal *journal = chunks.getptr(chunk_coord);
+	if (journal) {
+		compact(*journal);
+	}
+}
+
+void EditJournal::clear_records(RecordType type) {
+	auto has_type = [type](const Record &record) {
+		return record.type == type;
+	};
+	for (KeyValue<Vector3i, ChunkJournal> &entry : chunks) {
+		ChunkJournal &journal = entry.value;
+		journal.records.erase(std::remove_if(journal.records.begin(), journal.records.end(), has_type), journal.records.end());
+		if (type == RECORD_VOXEL) {
+			journal.snapshot_voxels.clear();
+		} else {
+			journal.snapshot_brushes.clear();
+		}
+	}
+}
+
+void EditJournal::clear() {
+	chunks.clear();
+}
+
+uint32_t EditJournal::get_record_count() const {
+	uint32_t count = 0;
+	for (const KeyValue<Vector3i, ChunkJournal> &entry : chunks) {
+		count += (uint32_t)entry.value.records.size();
+	}
+	return count;
+}
+
+uint32_t EditJournal::get_snapshot_entry_count() const {
+	uint32_t count = 0;
+	for (const KeyValue<Vector3i, ChunkJournal> &entry : chunks) {
+		count += (uint32_t)(entry.value.snapshot_voxels.size() + entry.value.snapshot_brushes.size());
+	}
+	return count;
+}
+
+int64_t EditJournal::get_memory_usage() const {
+	int64_t bytes = 0;
+	for (const KeyValue<Vector3i, ChunkJournal> &entry : chunks) {
+		const ChunkJournal &journal = entry.value;
+		bytes += sizeof(ChunkJournal) + sizeof(Vector3i);
+		bytes += (int64_t)(journal.snapshot_voxels.capacity() + journal.snapshot_brushes.capacity() + journal.records.capacity()) * sizeof(Record);
+	}
+	return bytes;
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,133 @@
+// edit_journal.h
+
+#ifndef EDIT_JOURNAL_H
+#define EDIT_JOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Godot includes
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+using namespace godot;
+
+namespace voxel_engine {
+
+// Edits made on top of the generated world. Generation is deterministic, so a
+// peer with the same seed only needs these to catch up, and what it receives
+// grows with the number of edits instead of the size of the chunks.
+//
+// Every chunk has its own version, bumped by each edit, and each record keeps
+// the version it created. A delta "since version N" holds the records above N.
+// Versions are only comparable between peers that take them from one
+// authority: clients send their edits to the host, which applies them and
+// sends back the result in its own delta.
+//
+// Compaction folds a chunk's records into a snapshot holding the latest type
+// of each edited voxel, so repeated edits of one voxel cost one entry. Snapshot
+// entries keep their version, which lets a peer at any version still get an
+// exact delta once the history is gone.
+class EditJournal {
+public:
+	enum RecordType : uint8_t {
+		RECORD_VOXEL, // Voxel type change in a chunk
+		RECORD_BRUSH // VoxelGenerator::modify_terrain() on the density field
+	};
+
+	struct Record {
+		uint32_t version = 0;
+		RecordType type = RECORD_VOXEL;
+		// Voxel
+		uint16_t index = 0; // VoxelBuffer index in the chunk, see get_voxel_index()
+		uint8_t old_type = 0; // Before the edit, or before the first one once compacted
+		uint8_t new_type = 0;
+		// Brush, in the generator's local space
+		Vector3 point;
+		float strength = 0.0f;
+		float radius = 0.0f;
+	};
+
+	// What a serialized delta holds for one chunk
+	struct ChunkDelta {
+		Vector3i coord;
+		uint32_t from_version = 0; // Version the sender assumed the receiver had
+		uint32_t to_version = 0;
+		std::vector<Record> records;
+	};
+
+	// A chunk's records are compacted once there are this many
+	static constexpr uint32_t COMPACTION_THRESHOLD = 256;
+	// Largest brush a journal takes, local or received
+	static constexpr float MAX_BRUSH_RADIUS = 64.0f;
+	static constexpr float MAX_BRUSH_STRENGTH = 64.0f;
+
+	static inline uint16_t get_voxel_index(const Vector3i &local_pos, int chunk_size) {
+		return (uint16_t)(local_pos.x + chunk_size * (local_pos.z + chunk_size * local_pos.y));
+	}
+	static inline Vector3i get_voxel_position(uint16_t index, int chunk_size) {
+		return Vector3i(index % chunk_size, index / (chunk_size * chunk_size), (index / chunk_size) % chunk_size);
+	}
+	// Finite, with a radius in (0, MAX_BRUSH_RADIUS] and |strength| up to MAX_BRUSH_STRENGTH
+	static bool is_valid_brush(const Vector3 &point, float strength, float radius);
+
+	// Both return the chunk's new version
+	uint32_t record_voxel(const Vector3i &chunk_coord, uint16_t index, uint8_t old_type, uint8_t new_type);
+	uint32_t record_brush(const Vector3i &chunk_coord, const Vector3 &point, float strength, float radius);
+
+	uint32_t get_version(const Vector3i &chunk_coord) const;
+	void get_versions(HashMap<Vector3i, uint32_t> &r_versions) const;
+
+	// Appends everything above `known_versions` (missing chunks count as 0).
+	// Format, little endian, "varint" being unsigned LEB128:
+	//
+	//   "VXED", u32 format version, varint chunk_count
+	//   per chunk: 3 zigzag varint coord, varint from_version, varint to_version,
+	//   varint record_count, then per record a u8 type, varint version - from_version and
+	//     voxel: varint index, u8 old_type, u8 new_type
+	//     brush: f32 x, f32 y, f32 z, f32 strength, f32 radius
+	void serialize_since(const HashMap<Vector3i, uint32_t> &known_versions, std::vector<uint8_t> &r_bytes) const;
+	// False on a foreign, newer or truncated delta, and on any record that
+	// doesn't fit in its chunk: an index past chunk_size³, an unknown voxel
+	// type, a brush outside the chunk or failing is_valid_brush(). Nothing of
+	// such a delta is applied.
+	static bool deserialize(const uint8_t *data, size_t length, int chunk_size, std::vector<ChunkDelta> &r_deltas);
+
+	// Takes in a received delta. Records this journal doesn't have yet are kept
+	// and appended to `r_new_records` in version order, for the caller to apply
+	// to the world. False when the delta starts after the local version: edits
+	// in between are missing and the chunk has to be requested again.
+	bool merge(const ChunkDelta &delta, std::vector<Record> &r_new_records);
+
+	void compact();
+	void compact_chunk(const Vector3i &chunk_coord);
+
+	// Drops one kind of record, for when the world it applies to is generated
+	// again. Versions keep counting so peers never see one go back.
+	void clear_records(RecordType type);
+	void clear();
+
+	uint32_t get_chunk_count() const { return chunks.size(); }
+	uint32_t get_record_count() const;
+	uint32_t get_snapshot_entry_count() const;
+	int64_t get_memory_usage() const;
+
+private:
+	struct ChunkJournal {
+		uint32_t version = 0;
+		std::vector<Record> snapshot_voxels; // Sorted by index, one per voxel
+		std::vector<Record> snapshot_brushes; // Brushes add up, they can't be folded
+		std::vector<Record> records; // Since the last compaction, in version order
+	};
+
+	ChunkJournal &get_or_create(const Vector3i &chunk_coord);
+	static void compact(ChunkJournal &journal);
+
+	HashMap<Vector3i, ChunkJournal> chunks;
+};
+
+} // namespace voxel_engine
+
+#endif // EDIT_JOURNAL_H
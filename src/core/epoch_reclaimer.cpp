@@ -0,0 +1,138 @@
+#include "epoch_reclaimer.h"
+
+#include <thread>
+
+namespace voxel_engine {
+
+namespace {
+
+// Enough for the workers, the main thread and whatever else pins
+constexpr int MAX_THREADS = 256;
+
+// One cache line per thread, pinned by its owner and scanned by collect()
+struct alignas(64) EpochSlot {
+	std::atomic<uint64_t> pinned{ 0 }; // 0 when not pinned
+	std::atomic<bool> taken{ false };
+};
+
+// Outside the reclaimer: threads release their slot when they exit, which
+// can be after destroy()
+EpochSlot slots[MAX_THREADS];
+std::atomic<int> slot_high_water{ 0 };
+
+struct ThreadSlot {
+	int index = -1;
+	int depth = 0;
+
+	~ThreadSlot() {
+		if (index >= 0) {
+			slots[index].pinned.store(0);
+			slots[index].taken.store(false, std::memory_order_release);
+		}
+	}
+
+	EpochSlot &get() {
+		while (index < 0) {
+			for (int i = 0; i < MAX_THREADS; ++i) {
+				bool expected = false;
+				if (!slots[i].taken.load(std::memory_order_relaxed) && slots[i].taken.compare_exchange_strong(expected, true)) {
+					index = i;
+					int high_water = slot_high_water.load();
+					while (high_water < i + 1 && !slot_high_water.compare_exchange_weak(high_water, i + 1)) {
+					}
+					break;
+				}
+			}
+			if (index < 0) {
+				// Every slot taken, wait for a thread to exit
+				std::this_thread::yield();
+			}
+		}
+		return slots[index];
+	}
+};
+
+thread_local ThreadSlot thread_slot;
+
+} // namespace
+
+EpochReclaimer *EpochReclaimer::singleton = nullptr;
+
+void EpochReclaimer::create() {
+	if (!singleton) {
+		singleton = new EpochReclaimer();
+	}
+}
+
+void EpochReclaimer::destroy() {
+	delete singleton;
+	singleton = nullptr;
+}
+
+EpochReclaimer::~EpochReclaimer() {
+	for (Retired &entry : retired) {
+		entry.free_fn();
+	}
+}
+
+EpochReclaimer::Guard::Guard() {
+	if (thread_slot.depth++ == 0 && singleton) {
+		// Sequentially consistent: the pin is visible to collect() before
+		// this thread reads anything it protects
+		thread_slot.get().pinned.store(singleton->epoch.load());
+	}
+}
+
+EpochReclaimer::Guard::~Guard() {
+	if (--thread_slot.depth == 0 && thread_slot.index >= 0) {
+		slots[thread_slot.index].pinned.store(0, std::memory_order_release);
+	}
+}
+
+void EpochReclaimer::retire(std::function<void()> free_fn) {
+	const uint64_t retire_epoch = epoch.load();
+	std::lock_guard<std::mutex> lock(retired_mutex);
+	retired.push_back(Retired{ retire_epoch, std::move(free_fn) });
+	retired_count.store((int)retired.size(), std::memory_order_relaxed);
+}
+
+uint64_t EpochReclaimer::get_oldest_pinned_epoch() const {
+	uint64_t oldest = 0;
+	const int count = slot_high_water.load();
+	for (int i = 0; i < count; ++i) {
+		const uint64_t pinned = slots[i].pinned.load();
+		if (pinned != 0 && (oldest == 0 || pinned < oldest)) {
+			oldest = pinned;
+		}
+	}
+	return oldest;
+}
+
+int EpochReclaimer::collect() {
+	// Threads pinning from now on can't reach anything retired so far
+	const uint64_t current = epoch.fetch_add(1) + 1;
+	const uint64_t oldest = get_oldest_pinned_epoch();
+	const uint64_t safe_before = oldest != 0 ? oldest : current;
+
+	std::vector<Retired> to_free;
+	{
+		std::lock_guard<std::mutex> lock(retired_mutex);
+		for (size_t i = 0; i < retired.size();) {
+			if (retired[i].epoch < safe_before) {
+				to_free.push_back(std::move(retired[i]));
+				retired[i] = std::move(retired.back());
+				retired.pop_back();
+			} else {
+				++i;
+			}
+		}
+		retired_count.store((int)retired.size(), std::memory_order_relaxed);
+	}
+	// Outside the lock, freeing may retire more
+	for (Retired &entry : to_free) {
+		entry.free_fn();
+	}
+	return (int)to_free.size();
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,77 @@
+// epoch_reclaimer.h
+
+#ifndef EPOCH_RECLAIMER_H
+#define EPOCH_RECLAIMER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace voxel_engine {
+
+// Epoch based reclamation: objects that jobs may still be reading are retired
+// instead of deleted, and freed once every thread that could have seen them
+// has moved on.
+//
+// A job reading shared objects holds a Guard for as long as it uses them,
+// which pins the current epoch on its thread. retire() stamps the object with
+// the epoch at the time it was unlinked, collect() advances the epoch and
+// frees the objects retired before the oldest pinned epoch. An object must be
+// unreachable to new readers before it is retired: jobs pin first and only
+// then look at their cancellation token (see VoxelGenerator::submit_mesh_job),
+// so a job either sees the token cancelled or keeps what it reads alive.
+class EpochReclaimer {
+public:
+	// Owned by the extension, see register_types.cpp. Destroying frees
+	// everything still retired, the workers must be stopped by then.
+	static void create();
+	static void destroy();
+	static EpochReclaimer *get_singleton() { return singleton; }
+
+	// Pins the current epoch on this thread. Nests.
+	class Guard {
+	public:
+		Guard();
+		~Guard();
+		Guard(const Guard &) = delete;
+		Guard &operator=(const Guard &) = delete;
+	};
+
+	// Any thread
+	void retire(std::function<void()> free_fn);
+	template <typename T>
+	void retire(T *object) {
+		retire([object]() { delete object; });
+	}
+
+	// Advances the epoch and frees what no pinned thread can still see.
+	// Returns the number of objects freed. Main thread, once per frame.
+	int collect();
+	int get_retired_count() const { return retired_count.load(std::memory_order_relaxed); }
+	uint64_t get_epoch() const { return epoch.load(); }
+
+private:
+	static EpochReclaimer *singleton;
+
+	struct Retired {
+		uint64_t epoch;
+		std::function<void()> free_fn;
+	};
+
+	std::atomic<uint64_t> epoch{ 1 };
+	std::mutex retired_mutex;
+	std::vector<Retired> retired;
+	std::atomic<int> retired_count{ 0 };
+
+	EpochReclaimer() = default;
+	~EpochReclaimer();
+	// 0 when no thread is pinned
+	uint64_t get_oldest_pinned_epoch() const;
+};
+
+} // namespace voxel_engine
+
+#endif // EPOCH_RECLAIMER_H
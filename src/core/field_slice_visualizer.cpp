@@ -0,0 +1,146 @@
+#include "field_slice_visualizer.h"
+#include "job_system.h"
+
+#include <cstring>
+
+// Godot includes
+#include <godot_cpp/classes/shader.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+
+namespace voxel_engine {
+
+namespace {
+
+const char *SHADER_CODE = R"(
+shader_type spatial;
+render_mode unshaded, cull_disabled, shadows_disabled;
+
+uniform sampler2D field : filter_linear, repeat_disable;
+uniform float iso = 0.1;
+uniform float opacity = 0.85;
+
+void fragment() {
+	float value = texture(field, UV).r;
+	// Blue to cyan below the iso level, yellow to red above
+	vec3 color = value < iso
+			? vec3(0.0, (value + 1.0) * 0.5, 1.0)
+			: vec3(1.0, 1.0 - (value - iso) / max(1.0 - iso, 1e-4), 0.0);
+	// The iso contour, about a pixel wide at any distance
+	float contour = 1.0 - smoothstep(0.0, fwidth(value) * 1.5, abs(value - iso));
+	ALBEDO = mix(color, vec3(1.0), contour);
+	ALPHA = opacity;
+}
+)";
+
+// Small enough to spread a few hundred rows over every worker
+constexpr int ROWS_PER_JOB = 16;
+
+} // namespace
+
+void FieldSliceVisualizer::update(Node3D *parent, const DensityField &field, int axis, float position, float iso) {
+	const Vector3i dims = field.get_point_dims();
+	if (!parent || dims.x <= 0 || axis < 0 || axis > 2) {
+		return;
+	}
+	// The in-plane axes follow the slice axis cyclically, so the quad's basis
+	// stays right handed
+	const int u_axis = (axis + 1) % 3;
+	const int v_axis = (axis + 2) % 3;
+	const int width = dims[u_axis];
+	const int height = dims[v_axis];
+
+	// Between two layers of points along the axis
+	const float spacing = field.get_spacing();
+	const float layer = CLAMP((position - field.get_origin()[axis]) / spacing, 0.0f, (float)(dims[axis] - 1));
+	const int layer0 = MIN((int)layer, MAX(dims[axis] - 2, 0));
+	const int layer1 = MIN(layer0 + 1, dims[axis] - 1);
+	const float t = layer - (float)layer0;
+
+	samples.resize((size_t)width * height);
+	float *out = samples.data();
+	const DensityField *source = &field;
+	JobSystem *job_system = JobSystem::get_singleton();
+	std::vector<JobSystem::JobHandle> jobs;
+	for (int row_from = 0; row_from < height; row_from += ROWS_PER_JOB) {
+		const int row_to = MIN(row_from + ROWS_PER_JOB, height);
+		jobs.push_back(job_system->submit([=]() {
+			Vector3i p0;
+			p0[axis] = layer0;
+			Vector3i p1;
+			p1[axis] = layer1;
+			for (int row = row_from; row < row_to; ++row) {
+				// Image rows go down, v goes up
+				p0[v_axis] = p1[v_axis] = height - 1 - row;
+				for (int i = 0; i < width; ++i) {
+					p0[u_axis] = p1[u_axis] = i;
+					const float a = source->get(p0.x, p0.y, p0.z);
+					out[(size_t)row * width + i] = a + (source->get(p1.x, p1.y, p1.z) - a) * t;
+				}
+			}
+		}, JobSystem::PRIORITY_HIGH));
+	}
+	// Runs jobs meanwhile, and the field can't be edited before it's done
+	job_system->wait_all(jobs);
+
+	PackedByteArray bytes;
+	bytes.resize((int64_t)samples.size() * sizeof(float));
+	memcpy(bytes.ptrw(), samples.data(), samples.size() * sizeof(float));
+	const Ref<Image> image = Image::create_from_data(width, height, false, Image::FORMAT_RF, bytes);
+
+	if (material.is_null()) {
+		Ref<Shader> shader;
+		shader.instantiate();
+		shader->set_code(SHADER_CODE);
+		material.instantiate();
+		material->set_shader(shader);
+		quad.instantiate();
+	}
+	// Same size: the texture is updated in place
+	if (texture.is_valid() && texture_size == Vector2i(width, height)) {
+		texture->update(image);
+	} else {
+		texture = ImageTexture::create_from_image(image);
+		texture_size = Vector2i(width, height);
+		material->set_shader_parameter("field", texture);
+	}
+	material->set_shader_parameter("iso", iso);
+	// Texel centers land on the field points
+	const Vector2 quad_size(width * spacing, height * spacing);
+	if (quad->get_size() != quad_size) {
+		quad->set_size(quad_size);
+	}
+
+	if (!instance) {
+		instance = memnew(MeshInstance3D);
+		instance->set_name("NoiseSlice");
+		instance->set_mesh(quad);
+		instance->set_material_override(material);
+		instance->set_cast_shadows_setting(GeometryInstance3D::SHADOW_CASTING_SETTING_OFF);
+		parent->add_child(instance);
+	}
+	Vector3 u_direction;
+	u_direction[u_axis] = 1.0f;
+	Vector3 v_direction;
+	v_direction[v_axis] = 1.0f;
+	Vector3 normal;
+	normal[axis] = 1.0f;
+	Vector3 center = field.get_origin() + Vector3(dims - Vector3i(1, 1, 1)) * (spacing * 0.5f);
+	center[axis] = field.get_origin()[axis] + layer * spacing;
+	instance->set_transform(Transform3D(Basis(u_direction, v_direction, normal), center));
+}
+
+void FieldSliceVisualizer::set_iso(float iso) {
+	if (material.is_valid()) {
+		material->set_shader_parameter("iso", iso);
+	}
+}
+
+void FieldSliceVisualizer::remove() {
+	if (instance) {
+		instance->queue_free();
+		instance = nullptr;
+	}
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,52 @@
+// field_slice_visualizer.h
+
+#ifndef FIELD_SLICE_VISUALIZER_H
+#define FIELD_SLICE_VISUALIZER_H
+
+#include "density_field.h"
+
+#include <vector>
+
+// Godot includes
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/image_texture.hpp>
+#include <godot_cpp/classes/mesh_instance3d.hpp>
+#include <godot_cpp/classes/node3d.hpp>
+#include <godot_cpp/classes/quad_mesh.hpp>
+#include <godot_cpp/classes/shader_material.hpp>
+#include <godot_cpp/variant/vector2i.hpp>
+
+using namespace godot;
+
+namespace voxel_engine {
+
+// Shows an axis aligned slice of a DensityField as a float texture on one
+// quad. Rows are sampled in parallel on the JobSystem, one texel per field
+// point: texture filtering does the in-plane interpolation, so the picture
+// matches what the mesher sees. The shader colors values around the iso
+// level, changing it only sets a uniform. Moving the slice costs one texture
+// upload, the quad and material are reused.
+class FieldSliceVisualizer {
+public:
+	// Samples the slice at `position` along `axis` (Vector3::Axis), in the
+	// field's space, and shows it under `parent`
+	void update(Node3D *parent, const DensityField &field, int axis, float position, float iso);
+	void set_iso(float iso);
+	// Frees the quad
+	void remove();
+	// The quad was freed with the parent's children
+	void forget() { instance = nullptr; }
+	bool is_visible() const { return instance != nullptr; }
+
+private:
+	MeshInstance3D *instance = nullptr;
+	Ref<QuadMesh> quad;
+	Ref<ShaderMaterial> material;
+	Ref<ImageTexture> texture;
+	Vector2i texture_size;
+	std::vector<float> samples;
+};
+
+} // namespace voxel_engine
+
+#endif // FIELD_SLICE_VISUALIZER_H
@@ -0,0 +1,292 @@
+#include "fluid_simulator.h"
+#include "chunk.h"
+#include "direction.h"
+#include "voxel.h"
+#include "voxel_math.h"
+
+#include <algorithm>
+
+namespace voxel_engine {
+
+namespace {
+
+const Vector3i HORIZONTAL[4] = { Vector3i(-1, 0, 0), Vector3i(1, 0, 0), Vector3i(0, 0, -1), Vector3i(0, 0, 1) };
+
+// Solid results (liquids meeting) win over any level
+inline int get_write_priority(uint8_t type, uint8_t level) {
+	return type != VoxelType::AIR && !is_voxel_type_liquid(type) ? FluidSimulator::LEVEL_SOURCE + 1 : level;
+}
+
+inline int get_decay(int type) {
+	// Lava only crawls a few voxels
+	return type == VoxelType::LAVA ? 2 : 1;
+}
+
+} // namespace
+
+void FluidSimulator::clear() {
+	active_cells.clear();
+	tick_count = 0;
+}
+
+Chunk *FluidSimulator::get_chunk_at(const Vector3i &world_pos, Vector3i &r_local) const {
+	r_local = world_to_local_pos(world_pos, DEFAULT_CHUNK_SIZE);
+	return lookup ? lookup(world_to_chunk_coord(world_pos, DEFAULT_CHUNK_SIZE)) : nullptr;
+}
+
+void FluidSimulator::read_cell(const Vector3i &world_pos, int &r_type, int &r_level, bool &r_loaded) const {
+	Vector3i local;
+	const Chunk *chunk = get_chunk_at(world_pos, local);
+	r_loaded = chunk != nullptr;
+	r_type = chunk ? chunk->get_voxel_type(local) : VoxelType::AIR;
+	r_level = 0;
+	if (is_voxel_type_liquid(r_type)) {
+		// Liquid without a stored level is a source: generated or placed
+		const int stored = chunk->fluid_levels.get_size() > 0 ? chunk->fluid_levels.get(local.x, local.y, local.z) : 0;
+		r_level = stored == 0 ? LEVEL_SOURCE : stored;
+	}
+}
+
+void FluidSimulator::activate(const Vector3i &world_pos) {
+	Vector3i local;
+	const Chunk *chunk = get_chunk_at(world_pos, local);
+	if (chunk == nullptr) {
+		return;
+	}
+	active_cells[chunk->get_chunk_coord()].push_back(chunk->buffer.get_index(local.x, local.y, local.z));
+}
+
+void FluidSimulator::on_voxel_set(const Vector3i &world_pos) {
+	Vector3i local;
+	Chunk *chunk = get_chunk_at(world_pos, local);
+	if (chunk && chunk->fluid_levels.get_size() > 0) {
+		// Placed liquid is a source again
+		chunk->fluid_levels.set(local.x, local.y, local.z, 0);
+	}
+	activate(world_pos);
+	for (int d = 0; d < Direction::COUNT; ++d) {
+		activate(world_pos + Direction::get_direction_vector(Direction::Value(d)));
+	}
+}
+
+int FluidSimulator::get_active_cell_count() const {
+	int count = 0;
+	for (const KeyValue<Vector3i, std::vector<int>> &kv : active_cells) {
+		count += (int)kv.value.size();
+	}
+	return count;
+}
+
+void FluidSimulator::compute_chunk(const Vector3i &chunk_coord, const std::vector<int> &cells, std::vector<Write> &r_writes) const {
+	const int size = DEFAULT_CHUNK_SIZE;
+	const Vector3i origin = chunk_coord * size;
+	for (int index : cells) {
+		// Inverse of VoxelBuffer::get_index
+		const Vector3i pos = origin + Vector3i(index % size, index / (size * size), (index / size) % size);
+		int type;
+		int level;
+		bool loaded;
+		read_cell(pos, type, level, loaded);
+		if (!loaded || !is_voxel_type_liquid(type)) {
+			continue;
+		}
+		const int decay = get_decay(type);
+
+		// Flowing cells take their level from whatever feeds them, or dry up
+		if (level < LEVEL_SOURCE) {
+			int above_type;
+			int above_level;
+			bool above_loaded;
+			read_cell(pos + Vector3i(0, 1, 0), above_type, above_level, above_loaded);
+			int target = 0;
+			if (above_type == type) {
+				target = LEVEL_FALLING;
+			} else {
+				for (const Vector3i &offset : HORIZONTAL) {
+					int side_type;
+					int side_level;
+					bool side_loaded;
+					read_cell(pos + offset, side_type, side_level, side_loaded);
+					if (side_type == type) {
+						target = MAX(target, side_level - decay);
+					}
+				}
+			}
+			if (target != level) {
+				if (target <= 0) {
+					r_writes.push_back({ pos, (uint8_t)VoxelType::AIR, 0 });
+				} else {
+					r_writes.push_back({ pos, (uint8_t)type, (uint8_t)target });
+				}
+				// Spreads with its new level next tick
+				continue;
+			}
+		}
+
+		// Falling comes before spreading
+		const Vector3i below = pos + Vector3i(0, -1, 0);
+		int below_type;
+		int below_level;
+		bool below_loaded;
+		read_cell(below, below_type, below_level, below_loaded);
+		if (below_loaded) {
+			if (below_type == VoxelType::AIR || (below_type == type && below_level < LEVEL_FALLING)) {
+				r_writes.push_back({ below, (uint8_t)type, LEVEL_FALLING });
+				continue;
+			}
+			if (is_voxel_type_liquid(below_type) && below_type != type) {
+				r_writes.push_back({ below, (uint8_t)VoxelType::STONE, 0 });
+				continue;
+			}
+		}
+
+		// Only spreads sideways when resting on something, not on flowing liquid
+		if (below_type == type && below_level < LEVEL_SOURCE) {
+			continue;
+		}
+		const int spread = level - decay;
+		if (spread <= 0) {
+			continue;
+		}
+		for (const Vector3i &offset : HORIZONTAL) {
+			int side_type;
+			int side_level;
+			bool side_loaded;
+			read_cell(pos + offset, side_type, side_level, side_loaded);
+			if (!side_loaded) {
+				continue;
+			}
+			if (side_type == VoxelType::AIR || (side_type == type && side_level < spread)) {
+				r_writes.push_back({ pos + offset, (uint8_t)type, (uint8_t)spread });
+			} else if (is_voxel_type_liquid(side_type) && side_type != type) {
+				r_writes.push_back({ pos + offset, (uint8_t)VoxelType::STONE, 0 });
+			}
+		}
+	}
+}
+
+void FluidSimulator::apply_chunk(Chunk *chunk, std::vector<Write> &writes, std::vector<Change> &r_changes, std::vector<Vector3i> &r_touched) {
+	const int size = chunk->get_chunk_size();
+	// Several cells may write the same target, keep the strongest write
+	std::sort(writes.begin(), writes.end(), [](const Write &a, const Write &b) {
+		if (a.world_pos != b.world_pos) {
+			return a.world_pos < b.world_pos;
+		}
+		return get_write_priority(a.type, a.level) > get_write_priority(b.type, b.level);
+	});
+
+	for (size_t i = 0; i < writes.size(); ++i) {
+		if (i > 0 && writes[i].world_pos == writes[i - 1].world_pos) {
+			continue;
+		}
+		const Write &write = writes[i];
+		const Vector3i local = world_to_local_pos(write.world_pos, size);
+		const int old_type = chunk->get_voxel_type(local);
+		const bool liquid = is_voxel_type_liquid(write.type);
+		const uint8_t stored_level = liquid && write.level < LEVEL_SOURCE ? write.level : 0;
+		const uint8_t old_level = chunk->fluid_levels.get_size() > 0 ? chunk->fluid_levels.get(local.x, local.y, local.z) : 0;
+		if (old_type == write.type && old_level == stored_level) {
+			continue;
+		}
+
+		if (chunk->fluid_levels.get_size() == 0) {
+			chunk->fluid_levels.create(size, 0);
+		}
+		chunk->fluid_levels.set(local.x, local.y, local.z, stored_level);
+		if (old_type != write.type) {
+			chunk->set_voxel(local, write.type);
+			r_changes.push_back({ write.world_pos, (uint8_t)old_type, write.type });
+		}
+		r_touched.push_back(write.world_pos);
+	}
+}
+
+void FluidSimulator::tick(std::vector<Change> &r_changes, HashSet<Vector3i> &r_changed_chunks) {
+	tick_count++;
+	if (active_cells.is_empty()) {
+		return;
+	}
+
+	// Take the active set, activations from this tick go to the next one
+	std::vector<Vector3i> coords;
+	std::vector<std::vector<int>> cells;
+	for (KeyValue<Vector3i, std::vector<int>> &kv : active_cells) {
+		std::vector<int> &list = kv.value;
+		std::sort(list.begin(), list.end());
+		list.erase(std::unique(list.begin(), list.end()), list.end());
+		coords.push_back(kv.key);
+		cells.push_back(std::move(list));
+	}
+	active_cells.clear();
+
+	// Phase 1: read only, one job per chunk with active cells
+	JobSystem *job_system = JobSystem::get_singleton();
+	std::vector<std::vector<Write>> writes(coords.size());
+	std::vector<JobSystem::JobHandle> jobs;
+	for (size_t i = 0; i < coords.size(); ++i) {
+		jobs.push_back(job_system->submit([this, &coords, &cells, &writes, i]() {
+			compute_chunk(coords[i], cells[i], writes[i]);
+		}, JobSystem::PRIORITY_HIGH));
+	}
+	job_system->wait_all(jobs);
+	jobs.clear();
+
+	// Route the writes to the chunk they land in
+	HashMap<Vector3i, int> target_indices;
+	std::vector<Chunk *> targets;
+	std::vector<std::vector<Write>> target_writes;
+	for (const std::vector<Write> &list : writes) {
+		for (const Write &write : list) {
+			const Vector3i coord = world_to_chunk_coord(write.world_pos, DEFAULT_CHUNK_SIZE);
+			const int *found = target_indices.getptr(coord);
+			int index;
+			if (found) {
+				index = *found;
+			} else {
+				Chunk *chunk = lookup ? lookup(coord) : nullptr;
+				if (chunk == nullptr) {
+					continue;
+				}
+				index = (int)targets.size();
+				target_indices.insert(coord, index);
+				targets.push_back(chunk);
+				target_writes.push_back(std::vector<Write>());
+			}
+			target_writes[index].push_back(write);
+		}
+	}
+
+	// Phase 2: each chunk applies its own writes
+	std::vector<std::vector<Change>> changes(targets.size());
+	std::vector<std::vector<Vector3i>> touched(targets.size());
+	for (size_t i = 0; i < targets.size(); ++i) {
+		jobs.push_back(job_system->submit([&targets, &target_writes, &changes, &touched, i]() {
+			apply_chunk(targets[i], target_writes[i], changes[i], touched[i]);
+		}, JobSystem::PRIORITY_HIGH));
+	}
+	job_system->wait_all(jobs);
+
+	for (size_t i = 0; i < targets.size(); ++i) {
+		for (const Vector3i &pos : touched[i]) {
+			activate(pos);
+			for (int d = 0; d < Direction::COUNT; ++d) {
+				activate(pos + Direction::get_direction_vector(Direction::Value(d)));
+			}
+		}
+		for (const Change &change : changes[i]) {
+			r_changes.push_back(change);
+			const Vector3i coord = targets[i]->get_chunk_coord();
+			const Vector3i local = world_to_local_pos(change.world_pos, DEFAULT_CHUNK_SIZE);
+			r_changed_chunks.insert(coord);
+			for (int axis = 0; axis < 3; ++axis) {
+				if (local[axis] == 0 || local[axis] == DEFAULT_CHUNK_SIZE - 1) {
+					Vector3i offset;
+					offset[axis] = local[axis] == 0 ? -1 : 1;
+					r_changed_chunks.insert(coord + offset);
+				}
+			}
+		}
+	}
+}
+
+} // namespace voxel_engine
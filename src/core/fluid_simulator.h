@@ -0,0 +1,82 @@
+// fluid_simulator.h
+
+#ifndef FLUID_SIMULATOR_H
+#define FLUID_SIMULATOR_H
+
+#include "job_system.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Godot includes
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/hash_set.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+using namespace godot;
+
+namespace voxel_engine {
+
+class Chunk;
+
+// Cellular automaton for the liquid voxel types. Liquid cells carry a level:
+// sources are full, flowing cells lose a step per voxel travelled sideways
+// (two for lava) and dry up when nothing feeds them. Falling liquid stays
+// nearly full.
+//
+// Only active cells are simulated: the ones that changed last tick, their
+// neighbors and anything edited. Still water costs nothing. A tick works per
+// chunk in two job phases: every chunk's active cells compute their writes
+// reading the current state, then every touched chunk applies the writes that
+// land in it. No chunk is written by two jobs, so there is no locking.
+class FluidSimulator {
+public:
+	using ChunkLookup = std::function<Chunk *(const Vector3i &chunk_coord)>;
+
+	static constexpr uint8_t LEVEL_SOURCE = 8;
+	static constexpr uint8_t LEVEL_FALLING = 7;
+
+	struct Change {
+		Vector3i world_pos;
+		uint8_t old_type;
+		uint8_t new_type;
+	};
+
+	void set_chunk_lookup(const ChunkLookup &p_lookup) { lookup = p_lookup; }
+	void clear();
+
+	// Call after editing a voxel, wakes it and its neighbors up
+	void on_voxel_set(const Vector3i &world_pos);
+	void activate(const Vector3i &world_pos);
+
+	// Runs one step on the job system and waits for it. Voxels that changed
+	// type are appended to `r_changes`, every chunk whose voxels changed (and
+	// its neighbors on the touched borders) to `r_changed_chunks`.
+	void tick(std::vector<Change> &r_changes, HashSet<Vector3i> &r_changed_chunks);
+
+	int get_active_cell_count() const;
+	uint64_t get_tick_count() const { return tick_count; }
+
+private:
+	struct Write {
+		Vector3i world_pos;
+		uint8_t type;
+		uint8_t level;
+	};
+
+	ChunkLookup lookup;
+	// Active cells per chunk, as local indices into the chunk's VoxelBuffer layout
+	HashMap<Vector3i, std::vector<int>> active_cells;
+	uint64_t tick_count = 0;
+
+	Chunk *get_chunk_at(const Vector3i &world_pos, Vector3i &r_local) const;
+	void read_cell(const Vector3i &world_pos, int &r_type, int &r_level, bool &r_loaded) const;
+	void compute_chunk(const Vector3i &chunk_coord, const std::vector<int> &cells, std::vector<Write> &r_writes) const;
+	// `r_touched` gets every cell whose type or level changed
+	static void apply_chunk(Chunk *chunk, std::vector<Write> &writes, std::vector<Change> &r_changes, std::vector<Vector3i> &r_touched);
+};
+
+} // namespace voxel_engine
+
+#endif // FLUID_SIMULATOR_H
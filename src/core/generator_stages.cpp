@@ -0,0 +1,281 @@
+#include "generator_stages.h"
+#include "voxel.h"
+#include "voxel_math.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace voxel_engine {
+
+namespace {
+
+struct OreDefinition {
+	VoxelType type;
+	int min_y;
+	int max_y;
+	float veins_per_4096; // Expected vein count per 16^3 voxels
+	int vein_size;
+};
+
+const OreDefinition ORES[] = {
+	{ COAL, 0, 160, 10.0f, 8 },
+	{ IRON, 0, 96, 6.0f, 6 },
+	{ GOLD, 0, 48, 2.5f, 5 },
+	{ DIAMOND, 0, 20, 1.0f, 4 },
+};
+
+constexpr int DECORATION_MARGIN = 2; // Largest horizontal reach of a structure from its anchor
+
+// Salts keep the random streams of different stages independent
+constexpr uint64_t ORE_SALT = 0x6F7265ull;
+constexpr uint64_t DECORATION_SALT = 0x6465636Full;
+
+} // namespace
+
+void TerrainStage::generate(ChunkGenerationContext &ctx) const {
+	VoxelBuffer &buffer = *ctx.buffer;
+
+	// Whole chunk below the surface band: one memset, no sampling
+	if (ctx.chunk_class == ChunkClass::SOLID) {
+		buffer.fill(STONE);
+		return;
+	}
+
+	const ColumnData &column = *ctx.column;
+	const FastNoiseLite *detail = ctx.generator->detail_noise.ptr();
+	const float amplitude = ctx.generator->get_settings().overhang_amplitude;
+	const int band = (int)std::ceil(amplitude);
+	const int chunk_top = ctx.origin.y + ctx.size - 1;
+	uint64_t samples = 0;
+
+	for (int z = 0; z < ctx.size; ++z) {
+		for (int x = 0; x < ctx.size; ++x) {
+			const int index = column.get_index(x, z);
+			const int height = column.heights[index];
+			const Biome biome = column.biomes[index];
+
+			uint8_t top = GRASS;
+			uint8_t filler = DIRT;
+			switch (biome) {
+				case Biome::OCEAN:
+				case Biome::BEACH:
+				case Biome::DESERT:
+					top = SAND;
+					filler = SAND;
+					break;
+				case Biome::ROCKY:
+					top = STONE;
+					filler = STONE;
+					break;
+				case Biome::GRASSLAND:
+					break;
+			}
+
+			const int band_low = height - band;
+			const int band_high = height + band;
+
+			// Column entirely below the band
+			if (chunk_top < band_low - 4) {
+				buffer.fill_box(Vector3i(x, 0, z), Vector3i(x, ctx.size - 1, z), STONE);
+				continue;
+			}
+
+			// Scan top-down counting solid voxels since the last air, so surface and
+			// filler layers follow overhangs. A few voxels above the chunk are scanned
+			// for that count, and detail noise is only sampled inside the band.
+			const float world_x = (float)(ctx.origin.x + x);
+			const float world_z = (float)(ctx.origin.z + z);
+			int depth = 0;
+			for (int world_y = std::min(band_high, chunk_top + 4); world_y >= ctx.origin.y; --world_y) {
+				bool solid = true;
+				if (world_y >= band_low) {
+					const float density = (float)(height - world_y) + amplitude * detail->get_noise_3d(world_x, (float)world_y, world_z);
+					samples++;
+					solid = density > 0.0f;
+				}
+				depth = solid ? depth + 1 : 0;
+
+				const int y = world_y - ctx.origin.y;
+				if (!solid || y >= ctx.size) {
+					continue;
+				}
+				if (world_y < band_low - 4) {
+					// Everything further down is plain stone
+					buffer.fill_box(Vector3i(x, 0, z), Vector3i(x, y, z), STONE);
+					break;
+				}
+				buffer.set(x, y, z, depth == 1 ? top : (depth <= 4 ? filler : (uint8_t)STONE));
+			}
+		}
+	}
+	ctx.generator->stats.noise_samples_3d += samples;
+}
+
+void CaveStage::generate(ChunkGenerationContext &ctx) const {
+	VoxelBuffer &buffer = *ctx.buffer;
+	const ColumnData &column = *ctx.column;
+	const FastNoiseLite *noise = ctx.generator->cave_noise.ptr();
+	const WorldGeneratorSettings &settings = ctx.generator->get_settings();
+	const float threshold = settings.cave_threshold;
+	uint64_t samples = 0;
+
+	// Caves live in a band under the surface, deep rock stays untouched
+	if (ctx.origin.y + ctx.size - 1 < column.min_height - settings.cave_depth) {
+		return;
+	}
+
+	for (int z = 0; z < ctx.size; ++z) {
+		for (int x = 0; x < ctx.size; ++x) {
+			const int height = column.heights[column.get_index(x, z)];
+			// Keep a crust under the surface so caves don't open into the sea everywhere
+			const int ceiling = height - 4;
+			const int top_y = std::min(ceiling - ctx.origin.y, ctx.size - 1);
+			const int bottom_y = std::max(height - settings.cave_depth - ctx.origin.y, 0);
+			for (int y = bottom_y; y <= top_y; ++y) {
+				const int world_y = ctx.origin.y + y;
+				if (world_y <= 0 || buffer.get(x, y, z) == AIR) {
+					continue;
+				}
+				// Squash vertically for wider, flatter tunnels
+				const float n = noise->get_noise_3d(ctx.origin.x + x, world_y * 1.5f, ctx.origin.z + z);
+				samples++;
+				if (std::fabs(n) < threshold) {
+					buffer.set(x, y, z, AIR);
+				}
+			}
+		}
+	}
+	ctx.generator->stats.noise_samples_3d += samples;
+}
+
+void OreStage::generate(ChunkGenerationContext &ctx) const {
+	VoxelBuffer &buffer = *ctx.buffer;
+	const uint64_t seed = (uint64_t)ctx.generator->get_settings().seed;
+	const float volume_scale = (float)(ctx.size * ctx.size * ctx.size) / 4096.0f;
+
+	for (int ore_index = 0; ore_index < (int)(sizeof(ORES) / sizeof(ORES[0])); ++ore_index) {
+		const OreDefinition &ore = ORES[ore_index];
+		// Skip chunks entirely outside the ore's depth range, veins included
+		if (ctx.origin.y > ore.max_y + ore.vein_size || ctx.origin.y + ctx.size < ore.min_y - ore.vein_size) {
+			continue;
+		}
+
+		for (int nx = -1; nx <= 1; ++nx) {
+			for (int ny = -1; ny <= 1; ++ny) {
+				for (int nz = -1; nz <= 1; ++nz) {
+					const Vector3i source = ctx.chunk_coord + Vector3i(nx, ny, nz);
+					CounterRandom random(derive_seed(seed, source, ORE_SALT + ore_index));
+
+					const float expected = ore.veins_per_4096 * volume_scale;
+					int vein_count = (int)expected;
+					if (random.next_float() < expected - vein_count) {
+						vein_count++;
+					}
+
+					const Vector3i source_origin = source * ctx.size;
+					for (int vein = 0; vein < vein_count; ++vein) {
+						Vector3i pos = source_origin + Vector3i(random.next_range(ctx.size), random.next_range(ctx.size), random.next_range(ctx.size));
+						const bool in_range = pos.y >= ore.min_y && pos.y <= ore.max_y;
+
+						// Always consume the same random numbers so the stream stays aligned
+						for (int step = 0; step < ore.vein_size; ++step) {
+							const Vector3i local = pos - ctx.origin;
+							if (in_range && buffer.is_in_bounds(local) && buffer.get(local.x, local.y, local.z) == STONE) {
+								buffer.set(local.x, local.y, local.z, ore.type);
+							}
+							const int axis = random.next_range(3);
+							pos[axis] += (random.next_u32() & 1) ? 1 : -1;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+void FluidStage::generate(ChunkGenerationContext &ctx) const {
+	VoxelBuffer &buffer = *ctx.buffer;
+	const ColumnData &column = *ctx.column;
+	const WorldGeneratorSettings &settings = ctx.generator->get_settings();
+
+	for (int z = 0; z < ctx.size; ++z) {
+		for (int x = 0; x < ctx.size; ++x) {
+			const int height = column.heights[column.get_index(x, z)];
+			for (int y = 0; y < ctx.size; ++y) {
+				const int world_y = ctx.origin.y + y;
+				if (world_y > settings.sea_level && world_y > settings.lava_level) {
+					break;
+				}
+				if (buffer.get(x, y, z) != AIR) {
+					continue;
+				}
+				if (world_y > height && world_y <= settings.sea_level) {
+					buffer.set(x, y, z, WATER);
+				} else if (world_y < height && world_y <= settings.lava_level) {
+					buffer.set(x, y, z, LAVA);
+				}
+			}
+		}
+	}
+}
+
+void DecorationStage::generate(ChunkGenerationContext &ctx) const {
+	VoxelBuffer &buffer = *ctx.buffer;
+	const uint64_t seed = (uint64_t)ctx.generator->get_settings().seed;
+
+	auto place = [&](const Vector3i &world_pos, uint8_t type) {
+		const Vector3i local = world_pos - ctx.origin;
+		if (buffer.is_in_bounds(local)) {
+			const uint8_t current = buffer.get(local.x, local.y, local.z);
+			if (current == AIR || current == WATER) {
+				buffer.set(local.x, local.y, local.z, type);
+			}
+		}
+	};
+
+	for (int anchor_z = ctx.origin.z - DECORATION_MARGIN; anchor_z < ctx.origin.z + ctx.size + DECORATION_MARGIN; ++anchor_z) {
+		for (int anchor_x = ctx.origin.x - DECORATION_MARGIN; anchor_x < ctx.origin.x + ctx.size + DECORATION_MARGIN; ++anchor_x) {
+			// One stream per world column, whichever chunk draws the structure
+			CounterRandom random(derive_seed(seed, Vector3i(anchor_x, 0, anchor_z), DECORATION_SALT));
+			const float roll = random.next_float();
+			if (roll >= 0.012f) {
+				continue;
+			}
+
+			// Neighbor context: the anchor may sit in another chunk column
+			const Vector2i column_coord(floor_div(anchor_x, ctx.size), floor_div(anchor_z, ctx.size));
+			std::shared_ptr<const ColumnData> column = ctx.generator->get_column(column_coord, ctx.size);
+			const int index = column->get_index(floor_mod(anchor_x, ctx.size), floor_mod(anchor_z, ctx.size));
+			const int height = column->heights[index];
+			const Biome biome = column->biomes[index];
+
+			// Structures never reach more than their own height above the anchor
+			if (height + 8 < ctx.origin.y || height - DECORATION_MARGIN > ctx.origin.y + ctx.size) {
+				continue;
+			}
+
+			if (biome == Biome::OCEAN) {
+				// Rock spire rising from the seabed
+				const int spire_height = 2 + random.next_range(5);
+				for (int y = 1; y <= spire_height; ++y) {
+					place(Vector3i(anchor_x, height + y, anchor_z), STONE);
+				}
+			} else if (roll < 0.005f) {
+				// Boulder half buried in the surface
+				const int radius = 1 + random.next_range(DECORATION_MARGIN);
+				const int radius_squared = radius * radius;
+				for (int dy = -radius; dy <= radius; ++dy) {
+					for (int dz = -radius; dz <= radius; ++dz) {
+						for (int dx = -radius; dx <= radius; ++dx) {
+							if (dx * dx + dy * dy + dz * dz <= radius_squared) {
+								place(Vector3i(anchor_x + dx, height + dy, anchor_z + dz), STONE);
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+} // namespace voxel_engine
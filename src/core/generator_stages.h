@@ -0,0 +1,49 @@
+// generator_stages.h
+
+#ifndef GENERATOR_STAGES_H
+#define GENERATOR_STAGES_H
+
+#include "world_generator.h"
+
+namespace voxel_engine {
+
+// Fills stone, filler and surface voxels from the column heightmap and biome
+class TerrainStage : public GeneratorStage {
+public:
+	const char *get_name() const override { return "terrain"; }
+	void generate(ChunkGenerationContext &ctx) const override;
+};
+
+// Carves tunnels where 3D noise is close to zero
+class CaveStage : public GeneratorStage {
+public:
+	const char *get_name() const override { return "caves"; }
+	void generate(ChunkGenerationContext &ctx) const override;
+};
+
+// Random-walk ore veins replacing stone. Veins started in neighbor chunks are
+// replayed so they continue across chunk borders.
+class OreStage : public GeneratorStage {
+public:
+	const char *get_name() const override { return "ores"; }
+	void generate(ChunkGenerationContext &ctx) const override;
+};
+
+// Floods open air below sea level with water and deep cave air with lava
+class FluidStage : public GeneratorStage {
+public:
+	const char *get_name() const override { return "fluids"; }
+	void generate(ChunkGenerationContext &ctx) const override;
+};
+
+// Rock spires and boulders anchored on the surface. Anchors are picked per world
+// column, so a chunk also draws the parts of structures rooted in its neighbors.
+class DecorationStage : public GeneratorStage {
+public:
+	const char *get_name() const override { return "decorations"; }
+	void generate(ChunkGenerationContext &ctx) const override;
+};
+
+} // namespace voxel_engine
+
+#endif // GENERATOR_STAGES_H
@@ -0,0 +1,219 @@
+#include "job_system.h"
+
+#include <chrono>
+
+namespace voxel_engine {
+
+JobSystem *JobSystem::singleton = nullptr;
+
+namespace {
+
+// Queue index of the worker running on this thread, -1 elsewhere
+thread_local int current_worker = -1;
+
+int64_t get_time_usec() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+JobSystem::CancellationToken JobSystem::make_token() {
+	return std::make_shared<std::atomic<bool>>(false);
+}
+
+void JobSystem::create(int thread_count) {
+	if (singleton) {
+		return;
+	}
+	if (thread_count <= 0) {
+		// The main thread helps while it waits, leave it a core
+		thread_count = (int)std::thread::hardware_concurrency() - 1;
+	}
+	singleton = new JobSystem(thread_count > 0 ? thread_count : 1);
+}
+
+void JobSystem::destroy() {
+	delete singleton;
+	singleton = nullptr;
+}
+
+JobSystem::JobSystem(int thread_count) {
+	for (int i = 0; i < thread_count; ++i) {
+		queues.push_back(std::make_unique<WorkerQueue>());
+	}
+	for (int i = 0; i < thread_count; ++i) {
+		workers.emplace_back(&JobSystem::worker_loop, this, i);
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		stopping.store(true);
+	}
+	wake_condition.notify_all();
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+	// Jobs still queued are dropped with their queues, completions with the MPSC queue
+}
+
+JobSystem::JobHandle JobSystem::submit(std::function<void()> work, Priority priority,
+		const std::vector<JobHandle> &dependencies, const CancellationToken &token,
+		std::function<void()> on_complete) {
+	JobHandle job = std::make_shared<Job>();
+	job->work = std::move(work);
+	job->on_complete = std::move(on_complete);
+	job->token = token;
+	job->priority = priority;
+
+	for (const JobHandle &dependency : dependencies) {
+		if (!dependency) {
+			continue;
+		}
+		std::lock_guard<std::mutex> lock(dependency->dependents_mutex);
+		if (!dependency->finished.load(std::memory_order_acquire)) {
+			job->unfinished_dependencies.fetch_add(1, std::memory_order_relaxed);
+			dependency->dependents.push_back(job);
+		}
+	}
+	// Drop the registration guard, queues the job if every dependency is done
+	if (job->unfinished_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		enqueue(job);
+	}
+	return job;
+}
+
+void JobSystem::enqueue(const JobHandle &job) {
+	// Jobs spawned by a worker stay local, others are spread round robin
+	const int index = current_worker >= 0 ? current_worker : (int)(next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size());
+	{
+		std::lock_guard<std::mutex> lock(queues[index]->mutex);
+		queues[index]->jobs[job->priority].push_back(job);
+	}
+	{
+		// Under the sleep mutex so a worker about to sleep can't miss it
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		queued_jobs.fetch_add(1, std::memory_order_release);
+	}
+	wake_condition.notify_one();
+}
+
+JobSystem::JobHandle JobSystem::take_job(int queue_index) {
+	const int queue_count = (int)queues.size();
+	for (int priority = 0; priority < PRIORITY_COUNT; ++priority) {
+		if (queue_index >= 0) {
+			// Oldest first from our own queue, keeps submission order (near chunks first)
+			WorkerQueue &own = *queues[queue_index];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			std::deque<JobHandle> &jobs = own.jobs[priority];
+			if (!jobs.empty()) {
+				JobHandle job = jobs.front();
+				jobs.pop_front();
+				queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+				return job;
+			}
+		}
+		for (int offset = 1; offset <= queue_count; ++offset) {
+			const int victim = ((queue_index >= 0 ? queue_index : 0) + offset) % queue_count;
+			if (victim == queue_index) {
+				continue;
+			}
+			// Steal from the back, away from where the owner works
+			WorkerQueue &other = *queues[victim];
+			std::lock_guard<std::mutex> lock(other.mutex);
+			std::deque<JobHandle> &jobs = other.jobs[priority];
+			if (!jobs.empty()) {
+				JobHandle job = jobs.back();
+				jobs.pop_back();
+				queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+				return job;
+			}
+		}
+	}
+	return JobHandle();
+}
+
+void JobSystem::run(const JobHandle &job) {
+	const bool cancelled = job->is_cancelled();
+	if (!cancelled && job->work) {
+		job->work();
+	}
+	job->work = std::function<void()>(); // Release captures early
+
+	std::vector<JobHandle> dependents;
+	{
+		std::lock_guard<std::mutex> lock(job->dependents_mutex);
+		job->finished.store(true, std::memory_order_release);
+		dependents.swap(job->dependents);
+	}
+	for (const JobHandle &dependent : dependents) {
+		if (dependent->unfinished_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			enqueue(dependent);
+		}
+	}
+
+	if (!cancelled && job->on_complete) {
+		pending_completions.fetch_add(1, std::memory_order_relaxed);
+		completions.push(Completion{ std::move(job->on_complete), job->token });
+	}
+}
+
+void JobSystem::worker_loop(int index) {
+	current_worker = index;
+	while (true) {
+		JobHandle job = take_job(index);
+		if (job) {
+			run(job);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		wake_condition.wait(lock, [this]() {
+			return stopping.load() || queued_jobs.load(std::memory_order_acquire) > 0;
+		});
+		if (stopping.load()) {
+			return;
+		}
+	}
+}
+
+bool JobSystem::is_finished(const JobHandle &job) const {
+	return !job || job->finished.load(std::memory_order_acquire);
+}
+
+void JobSystem::wait(const JobHandle &job) {
+	while (!is_finished(job)) {
+		JobHandle other = take_job(current_worker);
+		if (other) {
+			run(other);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::wait_all(const std::vector<JobHandle> &jobs) {
+	for (const JobHandle &job : jobs) {
+		wait(job);
+	}
+}
+
+int JobSystem::drain_completions(int64_t budget_usec) {
+	const int64_t start = get_time_usec();
+	int count = 0;
+	Completion completion;
+	while (completions.pop(completion)) {
+		pending_completions.fetch_sub(1, std::memory_order_relaxed);
+		if (!(completion.token && completion.token->load(std::memory_order_acquire))) {
+			completion.fn();
+			count++;
+		}
+		completion = Completion();
+		if (get_time_usec() - start >= budget_usec) {
+			break;
+		}
+	}
+	return count;
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,164 @@
+// job_system.h
+
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace voxel_engine {
+
+// Multi-producer single-consumer queue. Pushing is lock-free and can happen
+// from any thread, popping must always happen on the same thread.
+template <typename T>
+class MpscQueue {
+public:
+	MpscQueue() :
+			head(&stub), tail(&stub) {}
+	~MpscQueue() {
+		T value;
+		while (pop(value)) {
+		}
+		if (tail != &stub) {
+			delete tail;
+		}
+	}
+
+	void push(T value) {
+		Node *node = new Node;
+		node->value = std::move(value);
+		Node *previous = head.exchange(node, std::memory_order_acq_rel);
+		// Between the exchange and this store the consumer sees the queue as
+		// ending at `previous`, the item shows up on a later pop
+		previous->next.store(node, std::memory_order_release);
+	}
+
+	bool pop(T &r_value) {
+		Node *current = tail;
+		Node *next = current->next.load(std::memory_order_acquire);
+		if (next == nullptr) {
+			return false;
+		}
+		// `next` becomes the new sentinel, its value is moved out
+		r_value = std::move(next->value);
+		tail = next;
+		if (current != &stub) {
+			delete current;
+		}
+		return true;
+	}
+
+private:
+	struct Node {
+		std::atomic<Node *> next{ nullptr };
+		T value;
+	};
+
+	std::atomic<Node *> head; // Last pushed node, shared by the producers
+	Node *tail; // Sentinel before the next item, owned by the consumer
+	Node stub;
+};
+
+// Background jobs for the whole extension: one work-stealing worker per core
+// (minus the main thread), three priority classes, dependencies between jobs
+// and cancellation. Work that has to touch the scene tree goes into the
+// job's completion, which the main thread runs from drain_completions().
+class JobSystem {
+public:
+	enum Priority {
+		PRIORITY_HIGH, // Near chunks, anything the player is waiting on
+		PRIORITY_NORMAL,
+		PRIORITY_LOW, // Distant chunks, saving
+		PRIORITY_COUNT
+	};
+
+	// Set to true to cancel. Jobs check it before running and completions
+	// before being applied; a job already running is not interrupted.
+	using CancellationToken = std::shared_ptr<std::atomic<bool>>;
+	static CancellationToken make_token();
+
+	struct Job;
+	using JobHandle = std::shared_ptr<Job>;
+
+	// Owned by the extension, see register_types.cpp. 0 threads means one per core.
+	static void create(int thread_count = 0);
+	static void destroy();
+	static JobSystem *get_singleton() { return singleton; }
+
+	// Queues `work` once all `dependencies` are finished. `on_complete` runs on
+	// the main thread during drain_completions(), unless the token is cancelled.
+	JobHandle submit(std::function<void()> work, Priority priority = PRIORITY_NORMAL,
+			const std::vector<JobHandle> &dependencies = {}, const CancellationToken &token = CancellationToken(),
+			std::function<void()> on_complete = std::function<void()>());
+
+	bool is_finished(const JobHandle &job) const;
+	// Blocks until the jobs are finished, running queued jobs meanwhile
+	void wait(const JobHandle &job);
+	void wait_all(const std::vector<JobHandle> &jobs);
+
+	// Runs completions until `budget_usec` is spent, at least one when any is
+	// queued. Main thread only. Returns the number of completions run.
+	int drain_completions(int64_t budget_usec);
+
+	int get_thread_count() const { return (int)workers.size(); }
+	int get_queued_job_count() const { return queued_jobs.load(std::memory_order_relaxed); }
+	int get_pending_completion_count() const { return pending_completions.load(std::memory_order_relaxed); }
+
+	struct Job {
+		std::function<void()> work;
+		std::function<void()> on_complete;
+		CancellationToken token;
+		Priority priority = PRIORITY_NORMAL;
+		// Dependencies still running, plus one while submit() registers them
+		std::atomic<int> unfinished_dependencies{ 1 };
+		std::mutex dependents_mutex; // Guards `dependents` and the transition to finished
+		std::vector<JobHandle> dependents;
+		std::atomic<bool> finished{ false };
+
+		bool is_cancelled() const { return token && token->load(std::memory_order_acquire); }
+	};
+
+private:
+	struct WorkerQueue {
+		std::mutex mutex;
+		std::deque<JobHandle> jobs[PRIORITY_COUNT];
+	};
+	struct Completion {
+		std::function<void()> fn;
+		CancellationToken token;
+	};
+
+	static JobSystem *singleton;
+
+	std::vector<std::thread> workers;
+	std::vector<std::unique_ptr<WorkerQueue>> queues; // One per worker
+	std::atomic<uint32_t> next_queue{ 0 }; // Round robin for submissions from other threads
+	std::atomic<int> queued_jobs{ 0 };
+	std::atomic<bool> stopping{ false };
+	std::mutex sleep_mutex;
+	std::condition_variable wake_condition;
+
+	MpscQueue<Completion> completions;
+	std::atomic<int> pending_completions{ 0 };
+
+	explicit JobSystem(int thread_count);
+	~JobSystem();
+
+	void worker_loop(int index);
+	void enqueue(const JobHandle &job);
+	// Own queue first for each priority class, then steals from the others.
+	// -1 for threads that are not workers.
+	JobHandle take_job(int queue_index);
+	void run(const JobHandle &job);
+};
+
+} // namespace voxel_engine
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,246 @@
+#include "light_engine.h"
+#include "chunk.h"
+#include "direction.h"
+#include "voxel.h"
+#include "voxel_math.h"
+
+namespace voxel_engine {
+
+Chunk *LightEngine::get_chunk_at(const Vector3i &world_pos, Vector3i &r_local) {
+	const Vector3i coord = world_to_chunk_coord(world_pos, DEFAULT_CHUNK_SIZE);
+	if (cached_chunk == nullptr || coord != cached_coord) {
+		cached_chunk = lookup ? lookup(coord) : nullptr;
+		cached_coord = coord;
+	}
+	r_local = world_to_local_pos(world_pos, DEFAULT_CHUNK_SIZE);
+	return cached_chunk;
+}
+
+int LightEngine::get_light(const Vector3i &world_pos, Channel channel) {
+	Vector3i local;
+	const Chunk *chunk = get_chunk_at(world_pos, local);
+	if (chunk == nullptr) {
+		return -1;
+	}
+	const uint8_t light = chunk->light.get(local.x, local.y, local.z);
+	return channel == SKY ? get_sky_light(light) : get_block_light(light);
+}
+
+int LightEngine::get_type(const Vector3i &world_pos) {
+	Vector3i local;
+	const Chunk *chunk = get_chunk_at(world_pos, local);
+	return chunk ? chunk->get_voxel_type(local) : VoxelType::AIR;
+}
+
+void LightEngine::set_light(const Vector3i &world_pos, Channel channel, int level) {
+	Vector3i local;
+	Chunk *chunk = get_chunk_at(world_pos, local);
+	if (chunk == nullptr) {
+		return;
+	}
+	{
+		// Edits are lit on the main thread while mesh jobs read the light
+		RWSpinLock::WriteGuard guard(chunk->voxel_data->lock);
+		const uint8_t light = chunk->light.get(local.x, local.y, local.z);
+		chunk->light.set(local.x, local.y, local.z,
+				channel == SKY ? make_light(level, get_block_light(light)) : make_light(get_sky_light(light), level));
+	}
+
+	const Vector3i coord = chunk->get_chunk_coord();
+	changed_chunks.insert(coord);
+	// Neighbors read border light through their padding
+	for (int axis = 0; axis < 3; ++axis) {
+		if (local[axis] == 0 || local[axis] == DEFAULT_CHUNK_SIZE - 1) {
+			Vector3i offset;
+			offset[axis] = local[axis] == 0 ? -1 : 1;
+			changed_chunks.insert(coord + offset);
+		}
+	}
+}
+
+int LightEngine::get_sky_source_level(const Vector3i &world_pos) {
+	// Voxels with nothing loaded above them see the open sky
+	Vector3i local;
+	if (get_chunk_at(world_pos + Vector3i(0, 1, 0), local) != nullptr) {
+		return 0;
+	}
+	const int type = get_type(world_pos);
+	if (is_voxel_type_opaque(type)) {
+		return 0;
+	}
+	return type == VoxelType::AIR ? MAX_LIGHT : MAX_LIGHT - 1;
+}
+
+void LightEngine::propagate_removals(Channel channel) {
+	std::deque<Node> &removals = remove_queues[channel];
+	std::deque<Node> &additions = add_queues[channel];
+	while (!removals.empty()) {
+		const Node node = removals.front();
+		removals.pop_front();
+		last_update_visits++;
+
+		for (int d = 0; d < Direction::COUNT; ++d) {
+			const Direction::Value direction = Direction::Value(d);
+			const Vector3i neighbor = node.pos + Direction::get_direction_vector(direction);
+			const int level = get_light(neighbor, channel);
+			if (level <= 0) {
+				continue;
+			}
+			// Full sky light below full sky light came from it, even at the same level
+			const bool sky_column = channel == SKY && direction == Direction::NEGATIVE_Y && node.level == MAX_LIGHT && level == MAX_LIGHT;
+			if (level < node.level || sky_column) {
+				// Sky sources at the top of the world keep their light
+				const int source = channel == SKY ? get_sky_source_level(neighbor) : 0;
+				set_light(neighbor, channel, source);
+				if (source > 0) {
+					additions.push_back({ neighbor, (uint8_t)source });
+				}
+				removals.push_back({ neighbor, (uint8_t)level });
+			} else {
+				// Lit from elsewhere, it refills the hole
+				additions.push_back({ neighbor, (uint8_t)level });
+			}
+		}
+	}
+}
+
+void LightEngine::propagate_additions(Channel channel) {
+	std::deque<Node> &additions = add_queues[channel];
+	while (!additions.empty()) {
+		const Node node = additions.front();
+		additions.pop_front();
+		last_update_visits++;
+
+		// The queued level may be stale if a removal ran over it since
+		const int level = get_light(node.pos, channel);
+		if (level <= 1) {
+			continue;
+		}
+		for (int d = 0; d < Direction::COUNT; ++d) {
+			const Direction::Value direction = Direction::Value(d);
+			const Vector3i neighbor = node.pos + Direction::get_direction_vector(direction);
+			const int current = get_light(neighbor, channel);
+			if (current < 0) {
+				continue;
+			}
+			const int type = get_type(neighbor);
+			if (is_voxel_type_opaque(type)) {
+				continue;
+			}
+			int target = level - 1;
+			if (channel == SKY && direction == Direction::NEGATIVE_Y && level == MAX_LIGHT && type == VoxelType::AIR) {
+				target = MAX_LIGHT;
+			}
+			if (current < target) {
+				set_light(neighbor, channel, target);
+				additions.push_back({ neighbor, (uint8_t)target });
+			}
+		}
+	}
+}
+
+void LightEngine::propagate() {
+	propagate_removals(SKY);
+	propagate_removals(BLOCK);
+	propagate_additions(SKY);
+	propagate_additions(BLOCK);
+}
+
+void LightEngine::compute_initial(const std::vector<Chunk *> &chunks) {
+	cached_chunk = nullptr;
+	last_update_visits = 0;
+
+	for (Chunk *chunk : chunks) {
+		chunk->light.create(chunk->get_chunk_size(), 0);
+	}
+	for (Chunk *chunk : chunks) {
+		const int size = chunk->get_chunk_size();
+		const Vector3i origin = chunk->get_chunk_coord() * size;
+
+		// Sky enters the top layer of the topmost chunks, the fill carries it down
+		for (int z = 0; z < size; ++z) {
+			for (int x = 0; x < size; ++x) {
+				const Vector3i world = origin + Vector3i(x, size - 1, z);
+				const int level = get_sky_source_level(world);
+				if (level == 0) {
+					continue;
+				}
+				chunk->light.set(x, size - 1, z, make_light(level, 0));
+				add_queues[SKY].push_back({ world, (uint8_t)level });
+			}
+		}
+
+		chunk->for_each_voxel_in_box(Vector3i(), Vector3i(size - 1, size - 1, size - 1), [&](const Vector3i &local, uint8_t type) {
+			const int emission = get_voxel_type_emission(type);
+			if (emission > 0) {
+				const uint8_t light = chunk->light.get(local.x, local.y, local.z);
+				chunk->light.set(local.x, local.y, local.z, make_light(get_sky_light(light), emission));
+				add_queues[BLOCK].push_back({ origin + local, (uint8_t)emission });
+			}
+		});
+	}
+	propagate();
+	// Everything is meshed after this anyway
+	changed_chunks.clear();
+}
+
+void LightEngine::on_voxel_changed(const Vector3i &world_pos, int old_type, int new_type) {
+	cached_chunk = nullptr;
+	last_update_visits = 0;
+
+	const int sky = get_light(world_pos, SKY);
+	const int block = get_light(world_pos, BLOCK);
+	if (sky < 0) {
+		return;
+	}
+
+	// Old block light goes away first, the emitter may be what changed
+	if (block > 0) {
+		set_light(world_pos, BLOCK, 0);
+		remove_queues[BLOCK].push_back({ world_pos, (uint8_t)block });
+	}
+	if (is_voxel_type_opaque(new_type)) {
+		if (sky > 0) {
+			set_light(world_pos, SKY, 0);
+			remove_queues[SKY].push_back({ world_pos, (uint8_t)sky });
+		}
+	} else {
+		if (old_type != new_type) {
+			// Opened up, or the medium changed: let the neighbors light it again
+			if (sky > 0) {
+				set_light(world_pos, SKY, 0);
+				remove_queues[SKY].push_back({ world_pos, (uint8_t)sky });
+			}
+			for (int d = 0; d < Direction::COUNT; ++d) {
+				const Vector3i neighbor = world_pos + Direction::get_direction_vector(Direction::Value(d));
+				for (int channel = SKY; channel <= BLOCK; ++channel) {
+					const int level = get_light(neighbor, Channel(channel));
+					if (level > 0) {
+						add_queues[channel].push_back({ neighbor, (uint8_t)level });
+					}
+				}
+			}
+		}
+		const int source = get_sky_source_level(world_pos);
+		if (source > 0) {
+			set_light(world_pos, SKY, source);
+			add_queues[SKY].push_back({ world_pos, (uint8_t)source });
+		}
+	}
+
+	const int emission = get_voxel_type_emission(new_type);
+	if (emission > 0) {
+		set_light(world_pos, BLOCK, emission);
+		add_queues[BLOCK].push_back({ world_pos, (uint8_t)emission });
+	}
+	propagate();
+}
+
+void LightEngine::take_changed_chunks(HashSet<Vector3i> &r_chunks) {
+	for (const Vector3i &coord : changed_chunks) {
+		r_chunks.insert(coord);
+	}
+	changed_chunks.clear();
+}
+
+} // namespace voxel_engine
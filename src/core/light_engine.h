@@ -0,0 +1,103 @@
+// light_engine.h
+
+#ifndef LIGHT_ENGINE_H
+#define LIGHT_ENGINE_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+// Godot includes
+#include <godot_cpp/templates/hash_set.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+using namespace godot;
+
+namespace voxel_engine {
+
+class Chunk;
+
+// Light is stored per voxel in one byte: sky light (0-15) in the high nibble,
+// block light from emissive voxels (0-15) in the low one
+constexpr int MAX_LIGHT = 15;
+
+inline int get_sky_light(uint8_t light) {
+	return light >> 4;
+}
+inline int get_block_light(uint8_t light) {
+	return light & 0x0F;
+}
+inline uint8_t make_light(int sky, int block) {
+	return (uint8_t)((sky << 4) | block);
+}
+
+// Vertex color factor for a light value. Each level is 80% of the one above,
+// with a floor so unlit caves are dark but not black.
+inline float get_light_brightness(uint8_t light) {
+	static const float CURVE[MAX_LIGHT + 1] = {
+		0.05f, 0.06f, 0.07f, 0.08f, 0.09f, 0.11f, 0.13f, 0.16f,
+		0.20f, 0.26f, 0.33f, 0.41f, 0.51f, 0.64f, 0.80f, 1.0f
+	};
+	const int sky = get_sky_light(light);
+	const int block = get_block_light(light);
+	return CURVE[sky > block ? sky : block];
+}
+
+// Flood fill lighting over the loaded chunks. Sky light enters from above the
+// topmost chunks and goes straight down through air without fading, block
+// light spreads from emissive voxels. Both lose one level per step and stop
+// at opaque voxels. Edits are handled with the usual add/remove queues, so an
+// update only visits the voxels whose light actually changes.
+class LightEngine {
+public:
+	using ChunkLookup = std::function<Chunk *(const Vector3i &chunk_coord)>;
+
+	void set_chunk_lookup(const ChunkLookup &p_lookup) { lookup = p_lookup; }
+
+	// Clears and recomputes the light of `chunks` from scratch
+	void compute_initial(const std::vector<Chunk *> &chunks);
+	// Call after the voxel at `world_pos` changed from `old_type` to `new_type`
+	void on_voxel_changed(const Vector3i &world_pos, int old_type, int new_type);
+
+	// Chunks whose light changed since the last call, including neighbors that
+	// see the change through their mesh padding
+	void take_changed_chunks(HashSet<Vector3i> &r_chunks);
+	int64_t get_last_update_visits() const { return last_update_visits; }
+
+private:
+	enum Channel {
+		SKY,
+		BLOCK
+	};
+	struct Node {
+		Vector3i pos;
+		uint8_t level;
+	};
+
+	ChunkLookup lookup;
+	std::deque<Node> add_queues[2];
+	std::deque<Node> remove_queues[2];
+	HashSet<Vector3i> changed_chunks;
+	int64_t last_update_visits = 0;
+
+	// One entry cache, BFS steps mostly stay in the same chunk
+	Vector3i cached_coord;
+	Chunk *cached_chunk = nullptr;
+
+	Chunk *get_chunk_at(const Vector3i &world_pos, Vector3i &r_local);
+	// Returns -1 outside the loaded chunks
+	int get_light(const Vector3i &world_pos, Channel channel);
+	int get_type(const Vector3i &world_pos);
+	void set_light(const Vector3i &world_pos, Channel channel, int level);
+	// Sky light a voxel gets directly from the open sky, 0 when covered
+	int get_sky_source_level(const Vector3i &world_pos);
+
+	void propagate_removals(Channel channel);
+	void propagate_additions(Channel channel);
+	void propagate();
+};
+
+} // namespace voxel_engine
+
+#endif // LIGHT_ENGINE_H
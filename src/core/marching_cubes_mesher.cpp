@@ -0,0 +1,363 @@
+#include "marching_cubes_mesher.h"
+#include "../Constants.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MC_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace voxel_engine {
+
+namespace {
+
+// Corner offsets in the order the triangle table expects
+const Vector3i CORNER_OFFSETS[8] = {
+	Vector3i(0, 0, 0), Vector3i(1, 0, 0), Vector3i(1, 1, 0), Vector3i(0, 1, 0),
+	Vector3i(0, 0, 1), Vector3i(1, 0, 1), Vector3i(1, 1, 1), Vector3i(0, 1, 1)
+};
+
+// Row classification: bit i of the result is set when values[i] < iso, for
+// up to 32 values. Rows are BRICK_SIZE + 1 points long.
+using ClassifyRowFn = uint32_t (*)(const float *values, int count, float iso);
+
+uint32_t classify_row_scalar(const float *values, int count, float iso) {
+	uint32_t mask = 0;
+	for (int i = 0; i < count; ++i) {
+		mask |= (uint32_t)(values[i] < iso) << i;
+	}
+	return mask;
+}
+
+#ifdef MC_KERNELS_X86
+
+// Baseline on x86-64, no check needed
+uint32_t classify_row_sse2(const float *values, int count, float iso) {
+	const __m128 threshold = _mm_set1_ps(iso);
+	uint32_t mask = 0;
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		mask |= (uint32_t)_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(values + i), threshold)) << i;
+	}
+	for (; i < count; ++i) {
+		mask |= (uint32_t)(values[i] < iso) << i;
+	}
+	return mask;
+}
+
+// Float compares only need AVX, AVX2 adds nothing here
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((target("avx")))
+#endif
+uint32_t classify_row_avx(const float *values, int count, float iso) {
+	const __m256 threshold = _mm256_set1_ps(iso);
+	uint32_t mask = 0;
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		// Ordered compare: NaN reads as not below, like the scalar `<`
+		mask |= (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(values + i), threshold, _CMP_LT_OQ)) << i;
+	}
+	for (; i < count; ++i) {
+		mask |= (uint32_t)(values[i] < iso) << i;
+	}
+	return mask;
+}
+
+bool cpu_has_avx() {
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	// The CPU supports it and the OS saves the YMM registers
+	const bool avx = (info[2] & (1 << 28)) != 0;
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	return avx && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx");
+#endif
+}
+
+#endif // MC_KERNELS_X86
+
+struct RowKernel {
+	ClassifyRowFn classify;
+	const char *name;
+};
+
+RowKernel select_row_kernel() {
+#ifdef MC_KERNELS_X86
+	if (cpu_has_avx()) {
+		return { classify_row_avx, "avx" };
+	}
+	return { classify_row_sse2, "sse2" };
+#else
+	return { classify_row_scalar, "scalar" };
+#endif
+}
+
+const RowKernel row_kernel = select_row_kernel();
+
+inline int count_trailing_zeros(uint32_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return (int)index;
+#else
+	return __builtin_ctz(value);
+#endif
+}
+
+inline int count_bits(uint32_t value) {
+	value = value - ((value >> 1) & 0x55555555u);
+	value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+	return (int)((((value + (value >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+}
+
+// Per cube index: the edges its triangles cross, bit per edge, how many
+// triangles it has, and where each triangle vertex sits among the cell's
+// batched edges (pushed in ascending edge order)
+struct CaseTable {
+	uint16_t edge_masks[256] = {};
+	uint8_t triangle_counts[256] = {};
+	uint8_t vertex_slots[256][16] = {};
+};
+
+const CaseTable &get_case_table() {
+	static const CaseTable table = []() {
+		CaseTable result;
+		const std::vector<std::array<int, 16>> &triangles = Constants::get_marching_triangles();
+		for (int index = 0; index < 256; ++index) {
+			int i = 0;
+			for (; i < 16 && triangles[index][i] != -1; ++i) {
+				result.edge_masks[index] |= (uint16_t)(1 << triangles[index][i]);
+			}
+			result.triangle_counts[index] = (uint8_t)(i / 3);
+			for (int j = 0; j < i; ++j) {
+				result.vertex_slots[index][j] = (uint8_t)count_bits(result.edge_masks[index] & ((1u << triangles[index][j]) - 1));
+			}
+		}
+		return result;
+	}();
+	return table;
+}
+
+// Occlusion probes around a vertex: the 8 cube diagonals, pushed toward the
+// normal so they cover the open hemisphere
+const float AO_DIAGONAL = 0.57735f; // 1 / sqrt(3)
+const Vector3 AO_DIRECTIONS[8] = {
+	Vector3(-AO_DIAGONAL, -AO_DIAGONAL, -AO_DIAGONAL), Vector3(AO_DIAGONAL, -AO_DIAGONAL, -AO_DIAGONAL),
+	Vector3(-AO_DIAGONAL, AO_DIAGONAL, -AO_DIAGONAL), Vector3(AO_DIAGONAL, AO_DIAGONAL, -AO_DIAGONAL),
+	Vector3(-AO_DIAGONAL, -AO_DIAGONAL, AO_DIAGONAL), Vector3(AO_DIAGONAL, -AO_DIAGONAL, AO_DIAGONAL),
+	Vector3(-AO_DIAGONAL, AO_DIAGONAL, AO_DIAGONAL), Vector3(AO_DIAGONAL, AO_DIAGONAL, AO_DIAGONAL)
+};
+const float AO_RADIUS = 1.5f; // In grid cells
+const float AO_STRENGTH = 0.6f; // Brightness lost when every probe is blocked
+
+} // namespace
+
+void MarchingCubesMesher::build(const DensityField &field, float iso, bool ambient_occlusion, MeshData &r_mesh, Stats *r_stats, std::vector<Vector3> *r_active_cells) {
+	Context ctx;
+	ctx.field = &field;
+	ctx.iso = iso;
+	ctx.ambient_occlusion = ambient_occlusion;
+	ctx.mesh = &r_mesh;
+	ctx.active_cells = r_active_cells;
+
+	visit_brick(ctx, field.get_level_count() - 1, 0, 0, 0);
+
+	if (r_stats) {
+		*r_stats = ctx.stats;
+	}
+}
+
+void MarchingCubesMesher::visit_brick(Context &ctx, int level, int x, int y, int z) {
+	const DensityField &field = *ctx.field;
+	if (!field.brick_may_contain_surface(level, x, y, z, ctx.iso)) {
+		// Every corner is on the same side, no cell in here can emit a triangle
+		const int span = DensityField::BRICK_SIZE << level;
+		const Vector3i cells = field.get_cell_dims();
+		const uint64_t count_x = MIN(span, cells.x - x * span);
+		const uint64_t count_y = MIN(span, cells.y - y * span);
+		const uint64_t count_z = MIN(span, cells.z - z * span);
+		ctx.stats.cells_skipped += count_x * count_y * count_z;
+		ctx.stats.bricks_skipped++;
+		return;
+	}
+
+	if (level == 0) {
+		polygonize_brick(ctx, x, y, z);
+		return;
+	}
+
+	const DensityField::Level &children = field.get_level(level - 1);
+	for (int cz = z * 2; cz < MIN(z * 2 + 2, children.dims.z); ++cz) {
+		for (int cy = y * 2; cy < MIN(y * 2 + 2, children.dims.y); ++cy) {
+			for (int cx = x * 2; cx < MIN(x * 2 + 2, children.dims.x); ++cx) {
+				visit_brick(ctx, level - 1, cx, cy, cz);
+			}
+		}
+	}
+}
+
+void MarchingCubesMesher::polygonize_brick(Context &ctx, int x, int y, int z) {
+	const DensityField &field = *ctx.field;
+	const Vector3i cells = field.get_cell_dims();
+	const Vector3i from(x, y, z);
+	const Vector3i begin = from * DensityField::BRICK_SIZE;
+	const Vector3i end(
+			MIN(begin.x + DensityField::BRICK_SIZE, cells.x),
+			MIN(begin.y + DensityField::BRICK_SIZE, cells.y),
+			MIN(begin.z + DensityField::BRICK_SIZE, cells.z));
+	const Vector3i count = end - begin;
+	ctx.stats.cells_visited += (uint64_t)count.x * count.y * count.z;
+
+	// Which points are below `iso`, a mask per row of points along X
+	uint32_t below[DensityField::BRICK_SIZE + 1][DensityField::BRICK_SIZE + 1];
+	const float *values = field.ptr();
+	for (int pz = 0; pz <= count.z; ++pz) {
+		for (int py = 0; py <= count.y; ++py) {
+			below[pz][py] = row_kernel.classify(values + field.get_index(begin.x, begin.y + py, begin.z + pz), count.x + 1, ctx.iso);
+		}
+	}
+
+	// Cube indices from the four rows around each row of cells. Corner i of
+	// cell c is bit c or c + 1 of one of them, see CORNER_OFFSETS.
+	const CaseTable &cases = get_case_table();
+	const uint32_t row_cells = (1u << count.x) - 1;
+	ctx.cells.clear();
+	ctx.edges.reset(count.x * count.y * count.z * 12);
+	int vertex_count = 0;
+	for (int cz = 0; cz < count.z; ++cz) {
+		for (int cy = 0; cy < count.y; ++cy) {
+			const uint32_t r0 = below[cz][cy]; // Corners 0 and 1
+			const uint32_t r1 = below[cz][cy + 1]; // 3 and 2
+			const uint32_t r2 = below[cz + 1][cy]; // 4 and 5
+			const uint32_t r3 = below[cz + 1][cy + 1]; // 7 and 6
+			// Unless all eight corners agree, the cell has triangles
+			const uint32_t all_below = r0 & (r0 >> 1) & r1 & (r1 >> 1) & r2 & (r2 >> 1) & r3 & (r3 >> 1);
+			const uint32_t any_below = r0 | (r0 >> 1) | r1 | (r1 >> 1) | r2 | (r2 >> 1) | r3 | (r3 >> 1);
+			uint32_t active = any_below & ~all_below & row_cells;
+			while (active) {
+				const int cx = count_trailing_zeros(active);
+				active &= active - 1;
+				ActiveCell cell;
+				cell.position = begin + Vector3i(cx, cy, cz);
+				cell.lookup_index = (int)(((r0 >> cx) & 1) | ((r0 >> cx) & 2) | (((r1 >> cx) & 2) << 1) | (((r1 >> cx) & 1) << 3) |
+						(((r2 >> cx) & 1) << 4) | (((r2 >> cx) & 2) << 4) | (((r3 >> cx) & 2) << 5) | (((r3 >> cx) & 1) << 7));
+				cell.first_edge = ctx.edges.count;
+				vertex_count += cases.triangle_counts[cell.lookup_index] * 3;
+
+				// Each crossed edge once, even when several triangles share it
+				float corner_values[8];
+				Vector3 corners[8];
+				for (int i = 0; i < 8; ++i) {
+					const Vector3i p = cell.position + CORNER_OFFSETS[i];
+					corner_values[i] = field.get(p.x, p.y, p.z);
+					corners[i] = field.get_point_position(p.x, p.y, p.z);
+				}
+				for (uint32_t edges = cases.edge_masks[cell.lookup_index]; edges; edges &= edges - 1) {
+					const int edge = count_trailing_zeros(edges);
+					const int a = Constants::cornerIndexAFromEdge[edge];
+					const int b = Constants::cornerIndexBFromEdge[edge];
+					ctx.edges.push(corners[a], corner_values[a], corners[b], corner_values[b]);
+				}
+				ctx.cells.push_back(cell);
+			}
+		}
+	}
+
+	ctx.edges.interpolate(ctx.iso);
+
+	// Sized once per brick, the cells write in place
+	MeshData &mesh = *ctx.mesh;
+	int vertex = (int)mesh.vertices.size();
+	mesh.vertices.resize(vertex + vertex_count);
+	mesh.normals.resize(vertex + vertex_count);
+	if (ctx.ambient_occlusion) {
+		mesh.colors.resize(vertex + vertex_count);
+	}
+	for (const ActiveCell &cell : ctx.cells) {
+		emit_cell(ctx, cell, vertex);
+	}
+}
+
+void MarchingCubesMesher::emit_cell(Context &ctx, const ActiveCell &cell, int &r_vertex) {
+	const DensityField &field = *ctx.field;
+	const CaseTable &cases = get_case_table();
+	const uint8_t *slots = cases.vertex_slots[cell.lookup_index];
+	const int triangle_count = cases.triangle_counts[cell.lookup_index];
+	MeshData &mesh = *ctx.mesh;
+
+	for (int index = 0; index < triangle_count * 3; index += 3) {
+		Vector3 vertices[3];
+		for (int i = 0; i < 3; ++i) {
+			vertices[i] = ctx.edges.get(cell.first_edge + slots[index + i]);
+		}
+
+		const Vector3 normal = (vertices[2] - vertices[0]).cross(vertices[1] - vertices[0]).normalized();
+		for (int i = 0; i < 3; ++i) {
+			mesh.vertices[r_vertex] = vertices[i];
+			mesh.normals[r_vertex] = normal;
+			if (ctx.ambient_occlusion) {
+				const float brightness = compute_occlusion(field, ctx.iso, vertices[i], normal);
+				mesh.colors[r_vertex] = Color(brightness, brightness, brightness);
+			}
+			r_vertex++;
+		}
+		ctx.stats.triangles++;
+	}
+
+	if (triangle_count > 0 && ctx.active_cells) {
+		ctx.active_cells->push_back(field.get_point_position(cell.position.x, cell.position.y, cell.position.z) + Vector3(0.5f, 0.5f, 0.5f) * field.get_spacing());
+	}
+}
+
+void MarchingCubesMesher::EdgeBatch::reset(int capacity) {
+	count = 0;
+	if ((int)value_a.size() >= capacity) {
+		return;
+	}
+	for (std::vector<float> *array : { &value_a, &value_b, &ax, &ay, &az, &bx, &by, &bz, &x, &y, &z }) {
+		array->resize(capacity);
+	}
+}
+
+void MarchingCubesMesher::EdgeBatch::interpolate(float iso) {
+	// Independent lanes over plain arrays, the compiler vectorizes this for
+	// whatever the build targets
+	const float *va = value_a.data();
+	const float *vb = value_b.data();
+	float *rx = x.data();
+	float *ry = y.data();
+	float *rz = z.data();
+	for (int i = 0; i < count; ++i) {
+		const float t = (iso - va[i]) / (vb[i] - va[i]);
+		rx[i] = ax[i] + (bx[i] - ax[i]) * t;
+		ry[i] = ay[i] + (by[i] - ay[i]) * t;
+		rz[i] = az[i] + (bz[i] - az[i]) * t;
+	}
+}
+
+const char *MarchingCubesMesher::get_kernel_name() {
+	return row_kernel.name;
+}
+
+float MarchingCubesMesher::compute_occlusion(const DensityField &field, float iso, const Vector3 &vertex, const Vector3 &normal) {
+	const float radius = AO_RADIUS * field.get_spacing();
+
+	// Which side of the iso value is open space is read just in front of the
+	// surface, so this works whichever way the field is signed
+	const bool open_below = field.sample_trilinear(vertex + normal * (0.25f * field.get_spacing())) < iso;
+	int blocked = 0;
+	for (const Vector3 &direction : AO_DIRECTIONS) {
+		const Vector3 probe = vertex + (normal + direction).normalized() * radius;
+		if ((field.sample_trilinear(probe) < iso) != open_below) {
+			blocked++;
+		}
+	}
+	return 1.0f - AO_STRENGTH * blocked / 8.0f;
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,92 @@
+// marching_cubes_mesher.h
+
+#ifndef MARCHING_CUBES_MESHER_H
+#define MARCHING_CUBES_MESHER_H
+
+#include "density_field.h"
+#include "mesh_data.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace voxel_engine {
+
+// Extracts the `iso` surface of a DensityField. The brick pyramid is walked top
+// down and any brick whose min/max doesn't straddle `iso` is dropped with all
+// its cells, so the cost follows the surface area rather than the volume.
+//
+// Bricks that remain are polygonized in three passes: every row of points is
+// compared with `iso` at once (SIMD, see get_kernel_name()) into a bit mask,
+// the masks give the cube index of all the cells of a row and the active ones
+// are compacted into a list, then the edge vertices of those cells are
+// interpolated together from struct-of-arrays batches.
+class MarchingCubesMesher {
+public:
+	struct Stats {
+		uint64_t cells_visited = 0;
+		uint64_t cells_skipped = 0; // Inside bricks rejected by their bounds
+		uint64_t bricks_skipped = 0;
+		uint64_t triangles = 0;
+	};
+
+	// Appends to `r_mesh`. `r_active_cells`, when given, receives the center of
+	// every cell that produced triangles (debug view). With `ambient_occlusion`
+	// every vertex gets a gray color, darker where the field closes in around it.
+	static void build(const DensityField &field, float iso, bool ambient_occlusion, MeshData &r_mesh, Stats *r_stats = nullptr, std::vector<Vector3> *r_active_cells = nullptr);
+	// Brightness of a surface vertex, 1 when nothing around it is solid. Also
+	// used by DualMesher.
+	static float compute_occlusion(const DensityField &field, float iso, const Vector3 &vertex, const Vector3 &normal);
+	// Row classification picked for this CPU: "avx", "sse2" or "scalar"
+	static const char *get_kernel_name();
+
+private:
+	struct ActiveCell {
+		Vector3i position;
+		int lookup_index;
+		int first_edge; // Of its edge vertices in the batch
+	};
+	// Edges to interpolate, one entry per edge of each active cell
+	struct EdgeBatch {
+		int count = 0;
+		std::vector<float> value_a, value_b;
+		std::vector<float> ax, ay, az, bx, by, bz;
+		std::vector<float> x, y, z; // Results
+
+		// Room for `capacity` edges, clears
+		void reset(int capacity);
+		inline void push(const Vector3 &a, float p_value_a, const Vector3 &b, float p_value_b) {
+			value_a[count] = p_value_a;
+			value_b[count] = p_value_b;
+			ax[count] = a.x;
+			ay[count] = a.y;
+			az[count] = a.z;
+			bx[count] = b.x;
+			by[count] = b.y;
+			bz[count] = b.z;
+			count++;
+		}
+		void interpolate(float iso);
+		Vector3 get(int index) const { return Vector3(x[index], y[index], z[index]); }
+	};
+
+	struct Context {
+		const DensityField *field;
+		float iso;
+		bool ambient_occlusion;
+		MeshData *mesh;
+		Stats stats;
+		std::vector<Vector3> *active_cells;
+		// Reused from brick to brick
+		std::vector<ActiveCell> cells;
+		EdgeBatch edges;
+	};
+
+	static void visit_brick(Context &ctx, int level, int x, int y, int z);
+	static void polygonize_brick(Context &ctx, int x, int y, int z);
+	// Writes the cell's triangles from `r_vertex` on, the mesh is already sized
+	static void emit_cell(Context &ctx, const ActiveCell &cell, int &r_vertex);
+};
+
+} // namespace voxel_engine
+
+#endif // MARCHING_CUBES_MESHER_H
@@ -0,0 +1,59 @@
+#include "memory_tracker.h"
+
+namespace voxel_engine {
+
+MemoryTracker *MemoryTracker::singleton = nullptr;
+
+void MemoryTracker::create() {
+	if (!singleton) {
+		singleton = new MemoryTracker();
+	}
+}
+
+void MemoryTracker::destroy() {
+	delete singleton;
+	singleton = nullptr;
+}
+
+const char *MemoryTracker::get_category_name(Category category) {
+	static const char *NAMES[CATEGORY_COUNT] = {
+		"voxels", "voxel_objects", "light", "meshes", "collision", "caches"
+	};
+	return NAMES[category];
+}
+
+double MemoryTracker::get_category_megabytes(int category) {
+	if (!singleton || category < 0 || category >= CATEGORY_COUNT) {
+		return 0.0;
+	}
+	return singleton->get_usage(Category(category)) / (1024.0 * 1024.0);
+}
+
+double MemoryTracker::get_total_megabytes() {
+	return singleton ? singleton->get_total() / (1024.0 * 1024.0) : 0.0;
+}
+
+void MemoryTracker::add(Category category, int64_t bytes) {
+	usage[category].fetch_add(bytes, std::memory_order_relaxed);
+	if (bytes > 0) {
+		const int64_t total = get_total();
+		int64_t previous = peak.load(std::memory_order_relaxed);
+		while (total > previous && !peak.compare_exchange_weak(previous, total, std::memory_order_relaxed)) {
+		}
+	}
+}
+
+int64_t MemoryTracker::get_total() const {
+	int64_t total = 0;
+	for (int i = 0; i < CATEGORY_COUNT; ++i) {
+		total += usage[i].load(std::memory_order_relaxed);
+	}
+	return total;
+}
+
+bool MemoryTracker::is_over_budget() const {
+	const int64_t limit = get_budget();
+	return limit > 0 && get_total() > limit;
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,81 @@
+// memory_tracker.h
+
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace voxel_engine {
+
+// Bytes held per subsystem, for the whole extension. Owners report what they
+// hold, usually through a TrackedBytes member, and the totals can be read from
+// any thread. The generator compares the total with the budget to decide when
+// to evict.
+class MemoryTracker {
+public:
+	enum Category {
+		CATEGORY_VOXELS, // Voxel types in dense buffers or octrees, fluid levels, sampled fields
+		CATEGORY_VOXEL_OBJECTS, // Script-facing Voxel views
+		CATEGORY_LIGHT,
+		CATEGORY_MESHES, // Geometry uploaded for chunks and regions
+		CATEGORY_COLLISION,
+		CATEGORY_CACHES, // Derived data that can be recomputed, e.g. generator columns
+		CATEGORY_COUNT
+	};
+
+	// Owned by the extension, see register_types.cpp
+	static void create();
+	static void destroy();
+	static MemoryTracker *get_singleton() { return singleton; }
+
+	static const char *get_category_name(Category category);
+	// Performance monitor callback, in MiB
+	static double get_category_megabytes(int category);
+	static double get_total_megabytes();
+
+	void add(Category category, int64_t bytes);
+	int64_t get_usage(Category category) const { return usage[category].load(std::memory_order_relaxed); }
+	int64_t get_total() const;
+	int64_t get_peak() const { return peak.load(std::memory_order_relaxed); }
+
+	// 0 means no budget
+	void set_budget(int64_t bytes) { budget.store(bytes, std::memory_order_relaxed); }
+	int64_t get_budget() const { return budget.load(std::memory_order_relaxed); }
+	bool is_over_budget() const;
+
+private:
+	static MemoryTracker *singleton;
+
+	std::atomic<int64_t> usage[CATEGORY_COUNT] = {};
+	std::atomic<int64_t> peak{ 0 };
+	std::atomic<int64_t> budget{ 0 };
+};
+
+// Amount reported by one owner. set() reports the difference from the last
+// call, destruction gives everything back.
+class TrackedBytes {
+public:
+	explicit TrackedBytes(MemoryTracker::Category p_category) :
+			category(p_category) {}
+	~TrackedBytes() { set(0); }
+	TrackedBytes(const TrackedBytes &) = delete;
+	TrackedBytes &operator=(const TrackedBytes &) = delete;
+
+	void set(int64_t p_bytes) {
+		MemoryTracker *tracker = MemoryTracker::get_singleton();
+		if (tracker && p_bytes != bytes) {
+			tracker->add(category, p_bytes - bytes);
+		}
+		bytes = tracker ? p_bytes : 0;
+	}
+	int64_t get() const { return bytes; }
+
+private:
+	MemoryTracker::Category category;
+	int64_t bytes = 0;
+};
+
+} // namespace voxel_engine
+
+#endif // MEMORY_TRACKER_H
@@ -0,0 +1,198 @@
+// mesh_data.h
+
+#ifndef MESH_DATA_H
+#define MESH_DATA_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Godot includes
+#include <godot_cpp/classes/mesh.hpp>
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/color.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/packed_color_array.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+using namespace godot;
+
+namespace voxel_engine {
+
+// Compact vertex attribute of the blocky chunk meshes, decoded by the voxel
+// shader (see voxel_material.h). One RGBA8 value per vertex:
+// - r: voxel type
+// - g: light byte (see light_engine.h)
+// - b, a: 16 bits = octahedral normal (6 bits per axis), AO level (2 bits),
+//   emissive flag, packed normal flag
+// Axis aligned normals encode exactly, which is all the blocky mesher emits.
+// Without the packed normal flag the mesh has a normal array of its own.
+constexpr int VOXEL_NORMAL_BITS = 6;
+constexpr int VOXEL_NORMAL_MAX = (1 << VOXEL_NORMAL_BITS) - 2; // Even, so 0 is exact
+constexpr uint32_t VOXEL_PACKED_NORMAL = 1u << 31;
+
+inline uint32_t pack_voxel_material(int type, uint8_t light, int ao, bool emissive) {
+	return (uint32_t)type | ((uint32_t)light << 8) | ((uint32_t)ao << 28) | (emissive ? 1u << 30 : 0u);
+}
+
+inline uint32_t pack_voxel_vertex(int type, uint8_t light, const Vector3 &normal, int ao, bool emissive) {
+	// Octahedral mapping: project on |x| + |y| + |z| = 1, fold the lower half over
+	const float sum = Math::abs(normal.x) + Math::abs(normal.y) + Math::abs(normal.z);
+	float u = sum > 0.0f ? normal.x / sum : 0.0f;
+	float v = sum > 0.0f ? normal.y / sum : 0.0f;
+	if (normal.z < 0.0f) {
+		const float fu = (1.0f - Math::abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+		const float fv = (1.0f - Math::abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+		u = fu;
+		v = fv;
+	}
+	const uint32_t qu = (uint32_t)Math::round((u * 0.5f + 0.5f) * VOXEL_NORMAL_MAX);
+	const uint32_t qv = (uint32_t)Math::round((v * 0.5f + 0.5f) * VOXEL_NORMAL_MAX);
+	return pack_voxel_material(type, light, ao, emissive) | ((qu | (qv << VOXEL_NORMAL_BITS)) << 16) | VOXEL_PACKED_NORMAL;
+}
+
+inline Vector3 unpack_voxel_vertex_normal(uint32_t attribute) {
+	const uint32_t word = attribute >> 16;
+	const float u = (float)(word & ((1 << VOXEL_NORMAL_BITS) - 1)) / VOXEL_NORMAL_MAX * 2.0f - 1.0f;
+	const float v = (float)((word >> VOXEL_NORMAL_BITS) & ((1 << VOXEL_NORMAL_BITS) - 1)) / VOXEL_NORMAL_MAX * 2.0f - 1.0f;
+	Vector3 normal(u, v, 1.0f - Math::abs(u) - Math::abs(v));
+	if (normal.z < 0.0f) {
+		normal.x = (1.0f - Math::abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+		normal.y = (1.0f - Math::abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+	}
+	return normal.normalized();
+}
+
+// Triangles produced by the meshers. Plain std::vectors so it can be filled
+// from worker threads without going through the Variant API per vertex, then
+// copied once into surface arrays. Without indices it is a triangle soup.
+struct MeshData {
+	std::vector<Vector3> vertices;
+	std::vector<Vector3> normals;
+	std::vector<Color> colors;
+	std::vector<int32_t> indices;
+	// Compact format, replaces normals and colors (see pack_voxel_vertex).
+	// Colors, when also present, tint the result.
+	std::vector<uint32_t> voxel_attributes;
+
+	void clear() {
+		vertices.clear();
+		normals.clear();
+		colors.clear();
+		indices.clear();
+		voxel_attributes.clear();
+	}
+	bool is_empty() const { return vertices.empty(); }
+	bool is_compact() const { return !voxel_attributes.empty(); }
+	int get_triangle_count() const { return (int)(indices.empty() ? vertices.size() : indices.size()) / 3; }
+	// Whole triangles, indices in range and every attribute array either
+	// empty or one entry per vertex
+	bool is_consistent() const {
+		const size_t count = vertices.size();
+		if ((indices.empty() ? count : indices.size()) % 3 != 0) {
+			return false;
+		}
+		for (int32_t index : indices) {
+			if (index < 0 || (size_t)index >= count) {
+				return false;
+			}
+		}
+		return (normals.empty() || normals.size() == count) && (colors.empty() || colors.size() == count) &&
+				(voxel_attributes.empty() || voxel_attributes.size() == count);
+	}
+	// Size of the arrays as uploaded, see to_surface_arrays()
+	int64_t get_memory_usage() const {
+		return (int64_t)(vertices.size() * sizeof(Vector3) + normals.size() * sizeof(Vector3) + colors.size() * sizeof(Color) + indices.size() * sizeof(int32_t) + voxel_attributes.size() * sizeof(uint32_t));
+	}
+
+	// Appends `other` moved by `offset`. The result is always indexed, a soup
+	// gets sequential indices.
+	void append(const MeshData &other, const Vector3 &offset) {
+		const int32_t base = (int32_t)vertices.size();
+		if (indices.empty() && base > 0) {
+			for (int32_t i = 0; i < base; ++i) {
+				indices.push_back(i);
+			}
+		}
+		vertices.reserve(vertices.size() + other.vertices.size());
+		for (const Vector3 &vertex : other.vertices) {
+			vertices.push_back(vertex + offset);
+		}
+		normals.insert(normals.end(), other.normals.begin(), other.normals.end());
+		colors.insert(colors.end(), other.colors.begin(), other.colors.end());
+		voxel_attributes.insert(voxel_attributes.end(), other.voxel_attributes.begin(), other.voxel_attributes.end());
+		if (other.indices.empty()) {
+			for (int32_t i = 0; i < (int32_t)other.vertices.size(); ++i) {
+				indices.push_back(base + i);
+			}
+		} else {
+			indices.reserve(indices.size() + other.indices.size());
+			for (int32_t index : other.indices) {
+				indices.push_back(base + index);
+			}
+		}
+	}
+
+	// Arrays for ArrayMesh::add_surface_from_arrays(PRIMITIVE_TRIANGLES, ...)
+	Array to_surface_arrays() const {
+		Array arrays;
+		arrays.resize(Mesh::ARRAY_MAX);
+		arrays[Mesh::ARRAY_VERTEX] = to_packed(vertices);
+		if (!normals.empty()) {
+			arrays[Mesh::ARRAY_NORMAL] = to_packed(normals);
+		}
+		if (!colors.empty()) {
+			PackedColorArray packed;
+			packed.resize(colors.size());
+			memcpy(packed.ptrw(), colors.data(), colors.size() * sizeof(Color));
+			arrays[Mesh::ARRAY_COLOR] = packed;
+		}
+		if (!voxel_attributes.empty()) {
+			PackedByteArray packed;
+			packed.resize(voxel_attributes.size() * 4);
+			uint8_t *bytes = packed.ptrw();
+			for (size_t i = 0; i < voxel_attributes.size(); ++i) {
+				const uint32_t attribute = voxel_attributes[i];
+				bytes[i * 4] = attribute & 0xFF;
+				bytes[i * 4 + 1] = (attribute >> 8) & 0xFF;
+				bytes[i * 4 + 2] = (attribute >> 16) & 0xFF;
+				bytes[i * 4 + 3] = attribute >> 24;
+			}
+			arrays[Mesh::ARRAY_CUSTOM0] = packed;
+		}
+		if (!indices.empty()) {
+			PackedInt32Array packed;
+			packed.resize(indices.size());
+			memcpy(packed.ptrw(), indices.data(), indices.size() * sizeof(int32_t));
+			arrays[Mesh::ARRAY_INDEX] = packed;
+		}
+		return arrays;
+	}
+	// Flags to pass along with to_surface_arrays(). Compact meshes without
+	// normals get their positions stored as 16 bit in the AABB of the surface,
+	// next to the 4 byte attribute: 12 bytes per vertex on the GPU. Godot only
+	// compresses normals together with tangents, so meshes that keep their
+	// normals stay uncompressed.
+	int64_t get_surface_flags() const {
+		if (!is_compact()) {
+			return 0;
+		}
+		const int64_t custom_format = (int64_t)Mesh::ARRAY_CUSTOM_RGBA8_UNORM << Mesh::ARRAY_FORMAT_CUSTOM0_SHIFT;
+		return normals.empty() ? (int64_t)Mesh::ARRAY_FLAG_COMPRESS_ATTRIBUTES | custom_format : custom_format;
+	}
+
+private:
+	static PackedVector3Array to_packed(const std::vector<Vector3> &source) {
+		PackedVector3Array packed;
+		packed.resize(source.size());
+		memcpy(packed.ptrw(), source.data(), source.size() * sizeof(Vector3));
+		return packed;
+	}
+};
+
+} // namespace voxel_engine
+
+#endif // MESH_DATA_H
@@ -0,0 +1,338 @@
+#include "mesh_simplifier.h"
+
+#include <algorithm>
+#include <array>
+#include <queue>
+
+namespace voxel_engine {
+
+namespace {
+
+// Symmetric 4x4 matrix of the summed squared plane distances
+struct Quadric {
+	double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+	void add_plane(const Vector3 &normal, const Vector3 &point) {
+		const double a = normal.x, b = normal.y, c = normal.z;
+		const double d = -(a * point.x + b * point.y + c * point.z);
+		a2 += a * a, ab += a * b, ac += a * c, ad += a * d;
+		b2 += b * b, bc += b * c, bd += b * d;
+		c2 += c * c, cd += c * d;
+		d2 += d * d;
+	}
+	void add(const Quadric &q) {
+		a2 += q.a2, ab += q.ab, ac += q.ac, ad += q.ad;
+		b2 += q.b2, bc += q.bc, bd += q.bd;
+		c2 += q.c2, cd += q.cd;
+		d2 += q.d2;
+	}
+	double evaluate(const Vector3 &p) const {
+		const double x = p.x, y = p.y, z = p.z;
+		return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x +
+				b2 * y * y + 2 * bc * y * z + 2 * bd * y +
+				c2 * z * z + 2 * cd * z + d2;
+	}
+};
+
+struct Collapse {
+	double cost;
+	int32_t from;
+	int32_t to;
+	uint32_t version;
+
+	bool operator>(const Collapse &other) const { return cost > other.cost; }
+};
+
+bool is_vertex_less(const MeshData &mesh, int32_t a, int32_t b) {
+	const Vector3 &pa = mesh.vertices[a], &pb = mesh.vertices[b];
+	if (pa != pb) {
+		return pa.x != pb.x ? pa.x < pb.x : (pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z);
+	}
+	if (mesh.is_compact()) {
+		return mesh.voxel_attributes[a] < mesh.voxel_attributes[b];
+	}
+	const Vector3 &na = mesh.normals[a], &nb = mesh.normals[b];
+	if (na != nb) {
+		return na.x != nb.x ? na.x < nb.x : (na.y != nb.y ? na.y < nb.y : na.z < nb.z);
+	}
+	if (mesh.colors.empty()) {
+		return false;
+	}
+	const Color &ca = mesh.colors[a], &cb = mesh.colors[b];
+	for (int i = 0; i < 4; ++i) {
+		if (ca[i] != cb[i]) {
+			return ca[i] < cb[i];
+		}
+	}
+	return false;
+}
+
+bool is_on_bounds(const Vector3 &p, const AABB &bounds) {
+	const Vector3 end = bounds.position + bounds.size;
+	for (int axis = 0; axis < 3; ++axis) {
+		if (p[axis] <= bounds.position[axis] || p[axis] >= end[axis]) {
+			return true;
+		}
+	}
+	return false;
+}
+
+} // namespace
+
+void MeshSimplifier::simplify(MeshData &r_mesh, float max_error, const AABB &locked_bounds, Stats *r_stats) {
+	Stats stats;
+	stats.triangles_before = (uint32_t)(r_mesh.indices.size() / 3);
+	stats.triangles_after = stats.triangles_before;
+	const bool compact = r_mesh.is_compact();
+	if (r_mesh.indices.empty() || (compact ? r_mesh.voxel_attributes.size() : r_mesh.normals.size()) != r_mesh.vertices.size()) {
+		if (r_stats) {
+			*r_stats = stats;
+		}
+		return;
+	}
+	const bool has_colors = r_mesh.colors.size() == r_mesh.vertices.size();
+
+	// Weld identical vertices, meshers emit one per face corner
+	const int32_t input_count = (int32_t)r_mesh.vertices.size();
+	std::vector<int32_t> order(input_count);
+	for (int32_t i = 0; i < input_count; ++i) {
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&r_mesh](int32_t a, int32_t b) {
+		return is_vertex_less(r_mesh, a, b);
+	});
+	std::vector<int32_t> remap(input_count);
+	std::vector<int32_t> welded; // Input vertex kept for each welded one
+	for (int32_t i = 0; i < input_count; ++i) {
+		if (i == 0 || is_vertex_less(r_mesh, order[i - 1], order[i])) {
+			welded.push_back(order[i]);
+		}
+		remap[order[i]] = (int32_t)welded.size() - 1;
+	}
+	const int32_t vertex_count = (int32_t)welded.size();
+	auto get_position = [&r_mesh, &welded](int32_t v) -> const Vector3 & {
+		return r_mesh.vertices[welded[v]];
+	};
+
+	std::vector<std::array<int32_t, 3>> triangles(r_mesh.indices.size() / 3);
+	std::vector<uint8_t> triangle_alive(triangles.size(), 1);
+	std::vector<std::vector<int32_t>> vertex_triangles(vertex_count);
+	std::vector<Quadric> quadrics(vertex_count);
+	for (size_t t = 0; t < triangles.size(); ++t) {
+		for (int i = 0; i < 3; ++i) {
+			triangles[t][i] = remap[r_mesh.indices[t * 3 + i]];
+			vertex_triangles[triangles[t][i]].push_back((int32_t)t);
+		}
+		const Vector3 &p0 = get_position(triangles[t][0]);
+		const Vector3 normal = (get_position(triangles[t][2]) - p0).cross(get_position(triangles[t][1]) - p0).normalized();
+		for (int i = 0; i < 3; ++i) {
+			quadrics[triangles[t][i]].add_plane(normal, p0);
+		}
+	}
+
+	// Open and non manifold edges lock their vertices
+	std::vector<uint8_t> locked(vertex_count, 0);
+	std::vector<std::pair<int32_t, int32_t>> edges;
+	edges.reserve(triangles.size() * 3);
+	for (const std::array<int32_t, 3> &triangle : triangles) {
+		for (int i = 0; i < 3; ++i) {
+			const int32_t a = triangle[i];
+			const int32_t b = triangle[(i + 1) % 3];
+			edges.push_back(std::make_pair(MIN(a, b), MAX(a, b)));
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+	for (size_t i = 0; i < edges.size();) {
+		size_t j = i + 1;
+		while (j < edges.size() && edges[j] == edges[i]) {
+			++j;
+		}
+		if (j - i != 2) {
+			locked[edges[i].first] = 1;
+			locked[edges[i].second] = 1;
+		}
+		i = j;
+	}
+	for (int32_t v = 0; v < vertex_count; ++v) {
+		if (is_on_bounds(get_position(v), locked_bounds)) {
+			locked[v] = 1;
+		}
+	}
+
+	std::vector<uint8_t> removed(vertex_count, 0);
+	std::vector<uint32_t> versions(vertex_count, 0);
+	auto get_ring = [&](int32_t v, std::vector<int32_t> &r_ring) {
+		r_ring.clear();
+		for (int32_t t : vertex_triangles[v]) {
+			for (int32_t w : triangles[t]) {
+				if (w != v && std::find(r_ring.begin(), r_ring.end(), w) == r_ring.end()) {
+					r_ring.push_back(w);
+				}
+			}
+		}
+	};
+	auto has_same_attributes = [&](int32_t a, int32_t b) {
+		if (compact) {
+			return r_mesh.voxel_attributes[welded[a]] == r_mesh.voxel_attributes[welded[b]];
+		}
+		if (r_mesh.normals[welded[a]].dot(r_mesh.normals[welded[b]]) < 0.999f) {
+			return false;
+		}
+		if (has_colors) {
+			const Color &ca = r_mesh.colors[welded[a]];
+			const Color &cb = r_mesh.colors[welded[b]];
+			for (int i = 0; i < 4; ++i) {
+				if (Math::abs(ca[i] - cb[i]) > 1.0f / 255.0f) {
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+
+	const double max_cost = (double)max_error * max_error;
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+	std::vector<int32_t> ring;
+	auto push_candidate = [&](int32_t u) {
+		if (locked[u] || removed[u]) {
+			return;
+		}
+		get_ring(u, ring);
+		for (int32_t w : ring) {
+			if (!has_same_attributes(u, w)) {
+				return;
+			}
+		}
+		Collapse best = { max_cost, -1, -1, versions[u] };
+		for (int32_t v : ring) {
+			Quadric q = quadrics[u];
+			q.add(quadrics[v]);
+			const double cost = MAX(q.evaluate(get_position(v)), 0.0);
+			if (cost <= best.cost) {
+				best.cost = cost;
+				best.from = u;
+				best.to = v;
+			}
+		}
+		if (best.from >= 0) {
+			queue.push(best);
+		}
+	};
+	for (int32_t v = 0; v < vertex_count; ++v) {
+		push_candidate(v);
+	}
+
+	std::vector<int32_t> other_ring;
+	while (!queue.empty()) {
+		const Collapse collapse = queue.top();
+		queue.pop();
+		const int32_t u = collapse.from;
+		const int32_t v = collapse.to;
+		if (removed[u] || removed[v] || versions[u] != collapse.version) {
+			continue;
+		}
+
+		// Link condition: an interior edge shares exactly its two opposite
+		// vertices, anything else would pinch the surface
+		get_ring(u, ring);
+		get_ring(v, other_ring);
+		int shared = 0;
+		for (int32_t w : ring) {
+			shared += std::find(other_ring.begin(), other_ring.end(), w) != other_ring.end() ? 1 : 0;
+		}
+		if (shared != 2) {
+			continue;
+		}
+		// Moving u onto v must not flip or flatten the triangles that survive
+		bool valid = true;
+		for (int32_t t : vertex_triangles[u]) {
+			const std::array<int32_t, 3> &triangle = triangles[t];
+			if (triangle[0] == v || triangle[1] == v || triangle[2] == v) {
+				continue;
+			}
+			Vector3 before[3];
+			Vector3 after[3];
+			for (int i = 0; i < 3; ++i) {
+				before[i] = get_position(triangle[i]);
+				after[i] = triangle[i] == u ? get_position(v) : before[i];
+			}
+			const Vector3 normal_before = (before[2] - before[0]).cross(before[1] - before[0]);
+			const Vector3 normal_after = (after[2] - after[0]).cross(after[1] - after[0]);
+			if (normal_after.length_squared() < 1e-12f || normal_before.dot(normal_after) <= 0.0f) {
+				valid = false;
+				break;
+			}
+		}
+		if (!valid) {
+			continue;
+		}
+
+		for (int32_t t : vertex_triangles[u]) {
+			std::array<int32_t, 3> &triangle = triangles[t];
+			if (triangle[0] == v || triangle[1] == v || triangle[2] == v) {
+				triangle_alive[t] = 0;
+				stats.triangles_after--;
+				for (int32_t w : triangle) {
+					if (w != u) {
+						std::vector<int32_t> &list = vertex_triangles[w];
+						list.erase(std::find(list.begin(), list.end(), t));
+					}
+				}
+				continue;
+			}
+			for (int32_t &w : triangle) {
+				if (w == u) {
+					w = v;
+				}
+			}
+			vertex_triangles[v].push_back(t);
+		}
+		vertex_triangles[u].clear();
+		quadrics[v].add(quadrics[u]);
+		removed[u] = 1;
+		stats.collapses++;
+
+		// Every vertex around v sees new triangles, their best collapse changed
+		get_ring(v, other_ring);
+		for (int32_t w : other_ring) {
+			versions[w]++;
+			push_candidate(w);
+		}
+		versions[v]++;
+		push_candidate(v);
+	}
+
+	if (stats.collapses > 0) {
+		MeshData result;
+		std::vector<int32_t> output_index(vertex_count, -1);
+		for (size_t t = 0; t < triangles.size(); ++t) {
+			if (!triangle_alive[t]) {
+				continue;
+			}
+			for (int32_t v : triangles[t]) {
+				if (output_index[v] < 0) {
+					output_index[v] = (int32_t)result.vertices.size();
+					result.vertices.push_back(r_mesh.vertices[welded[v]]);
+					if (compact) {
+						result.voxel_attributes.push_back(r_mesh.voxel_attributes[welded[v]]);
+					} else {
+						result.normals.push_back(r_mesh.normals[welded[v]]);
+						if (has_colors) {
+							result.colors.push_back(r_mesh.colors[welded[v]]);
+						}
+					}
+				}
+				result.indices.push_back(output_index[v]);
+			}
+		}
+		// The input is left as is rather than uploading a broken mesh
+		ERR_FAIL_COND_MSG(!result.is_consistent(), "Simplified mesh is inconsistent, keeping the original.");
+		r_mesh = std::move(result);
+	}
+
+	if (r_stats) {
+		*r_stats = stats;
+	}
+}
+
+} // namespace voxel_engine
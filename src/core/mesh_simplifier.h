@@ -0,0 +1,45 @@
+// mesh_simplifier.h
+
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include "mesh_data.h"
+
+#include <cstdint>
+
+// Godot includes
+#include <godot_cpp/variant/aabb.hpp>
+
+namespace voxel_engine {
+
+// Quadric error metric decimation (Garland & Heckbert) with half edge
+// collapses: a vertex is merged into one of its neighbors, never moved, so
+// the surviving vertices keep their exact position and attributes.
+//
+// What stays put:
+// - vertices on the faces of `locked_bounds`, so neighbors meshed at another
+//   detail still meet without cracks
+// - vertices on open edges, which is also where faces of different colors or
+//   normals meet once identical vertices are welded
+// - vertices whose neighbors don't all share their normal and color, since
+//   removing them would change how light and AO are interpolated
+//
+// A flat area of one color costs nothing to collapse whatever `max_error` is,
+// which is what big uniform surfaces (seabeds, plains) turn into.
+class MeshSimplifier {
+public:
+	struct Stats {
+		uint32_t triangles_before = 0;
+		uint32_t triangles_after = 0;
+		uint32_t collapses = 0;
+	};
+
+	// `max_error` bounds, in mesh units, how far the surface may move: the
+	// root of the summed squared distances to the planes a collapse affects.
+	// `r_mesh` must be indexed.
+	static void simplify(MeshData &r_mesh, float max_error, const AABB &locked_bounds, Stats *r_stats = nullptr);
+};
+
+} // namespace voxel_engine
+
+#endif // MESH_SIMPLIFIER_H
@@ -0,0 +1,240 @@
+#include "region_batcher.h"
+#include "voxel_math.h"
+
+#include <godot_cpp/classes/array_mesh.hpp>
+#include <godot_cpp/classes/multi_mesh.hpp>
+
+namespace voxel_engine {
+
+void RegionBatcher::configure(Node3D *p_parent, int p_region_size, int p_chunk_size) {
+	clear();
+	if (p_parent != parent) {
+		for (DecorationSet &set : decorations) {
+			free_instance(set.instance);
+		}
+		forget_decoration_instances();
+	}
+	parent = p_parent;
+	region_size = MAX(p_region_size, 1);
+	chunk_size = p_chunk_size;
+}
+
+Vector3i RegionBatcher::get_region_coord(const Vector3i &chunk_coord) const {
+	return Vector3i(
+			floor_div(chunk_coord.x, region_size),
+			floor_div(chunk_coord.y, region_size),
+			floor_div(chunk_coord.z, region_size));
+}
+
+void RegionBatcher::set_chunk_mesh(const Vector3i &chunk_coord, const Ref<Material> &material, const MeshData &mesh) {
+	if (mesh.is_empty()) {
+		remove_chunk(chunk_coord);
+		return;
+	}
+	ChunkEntry &entry = chunk_meshes[chunk_coord];
+	chunk_mesh_bytes += mesh.get_memory_usage() - entry.mesh.get_memory_usage();
+	entry.material = material;
+	entry.mesh = mesh;
+	dirty_regions.insert(get_region_coord(chunk_coord));
+	update_memory_tracking();
+}
+
+void RegionBatcher::remove_chunk(const Vector3i &chunk_coord) {
+	const ChunkEntry *entry = chunk_meshes.getptr(chunk_coord);
+	if (entry) {
+		chunk_mesh_bytes -= entry->mesh.get_memory_usage();
+		chunk_meshes.erase(chunk_coord);
+		dirty_regions.insert(get_region_coord(chunk_coord));
+		update_memory_tracking();
+	}
+}
+
+void RegionBatcher::flush() {
+	for (const Vector3i &region_coord : dirty_regions) {
+		rebuild_region(region_coord);
+	}
+	dirty_regions.clear();
+	update_memory_tracking();
+
+	for (DecorationSet &set : decorations) {
+		if (!set.dirty || parent == nullptr) {
+			continue;
+		}
+		set.dirty = false;
+		if (set.instance == nullptr) {
+			set.instance = memnew(MultiMeshInstance3D);
+			set.instance->set_name("Decorations");
+			parent->add_child(set.instance);
+		}
+		Ref<MultiMesh> multimesh;
+		multimesh.instantiate();
+		multimesh->set_transform_format(MultiMesh::TRANSFORM_3D);
+		multimesh->set_mesh(set.mesh);
+		multimesh->set_instance_count((int32_t)set.transforms.size());
+		for (int32_t i = 0; i < (int32_t)set.transforms.size(); ++i) {
+			multimesh->set_instance_transform(i, set.transforms[i]);
+		}
+		set.instance->set_multimesh(multimesh);
+	}
+}
+
+void RegionBatcher::rebuild_region(const Vector3i &region_coord) {
+	ERR_FAIL_NULL(parent);
+	const Vector3i first_chunk = region_coord * region_size;
+
+	// One merged mesh per material, in the order materials are first seen
+	std::vector<Ref<Material>> materials;
+	std::vector<MeshData> merged;
+	for (int y = 0; y < region_size; ++y) {
+		for (int z = 0; z < region_size; ++z) {
+			for (int x = 0; x < region_size; ++x) {
+				const Vector3i local_chunk(x, y, z);
+				const ChunkEntry *entry = chunk_meshes.getptr(first_chunk + local_chunk);
+				if (entry == nullptr) {
+					continue;
+				}
+				size_t slot = 0;
+				while (slot < materials.size() && materials[slot] != entry->material) {
+					++slot;
+				}
+				if (slot == materials.size()) {
+					materials.push_back(entry->material);
+					merged.push_back(MeshData());
+				}
+				merged[slot].append(entry->mesh, Vector3(local_chunk * chunk_size));
+			}
+		}
+	}
+
+	Region *region = regions.getptr(region_coord);
+	if (merged.empty()) {
+		if (region) {
+			region_mesh_bytes -= region->mesh_bytes;
+			free_instance(region->instance);
+			regions.erase(region_coord);
+		}
+		return;
+	}
+	if (region == nullptr) {
+		region = &regions[region_coord];
+	}
+
+	Ref<ArrayMesh> array_mesh;
+	array_mesh.instantiate();
+	for (size_t i = 0; i < merged.size(); ++i) {
+		array_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, merged[i].to_surface_arrays(), TypedArray<Array>(), Dictionary(), merged[i].get_surface_flags());
+		array_mesh->surface_set_material((int32_t)i, materials[i]);
+	}
+
+	if (region->instance == nullptr) {
+		region->instance = memnew(MeshInstance3D);
+		region->instance->set_name(String("Region_{0}_{1}_{2}").format(Array::make(region_coord.x, region_coord.y, region_coord.z)));
+		region->instance->set_position(Vector3(first_chunk * chunk_size));
+		region->instance->set_visible(region->visible);
+		parent->add_child(region->instance);
+	}
+	region->instance->set_mesh(array_mesh);
+	region->surface_count = (int)merged.size();
+	region_mesh_bytes -= region->mesh_bytes;
+	region->mesh_bytes = 0;
+	for (const MeshData &mesh : merged) {
+		region->mesh_bytes += mesh.get_memory_usage();
+	}
+	region_mesh_bytes += region->mesh_bytes;
+}
+
+void RegionBatcher::begin_visibility_pass() {
+	for (KeyValue<Vector3i, Region> &kv : regions) {
+		kv.value.pass_visible = false;
+	}
+}
+
+void RegionBatcher::mark_chunk_visible(const Vector3i &chunk_coord) {
+	Region *region = regions.getptr(get_region_coord(chunk_coord));
+	if (region) {
+		region->pass_visible = true;
+	}
+}
+
+void RegionBatcher::end_visibility_pass() {
+	for (KeyValue<Vector3i, Region> &kv : regions) {
+		Region &region = kv.value;
+		if (region.pass_visible != region.visible) {
+			region.visible = region.pass_visible;
+			if (region.instance) {
+				region.instance->set_visible(region.visible);
+			}
+		}
+	}
+}
+
+void RegionBatcher::add_decoration(const Ref<Mesh> &mesh, const Transform3D &transform) {
+	ERR_FAIL_COND(mesh.is_null());
+	for (DecorationSet &set : decorations) {
+		if (set.mesh == mesh) {
+			set.transforms.push_back(transform);
+			set.dirty = true;
+			return;
+		}
+	}
+	DecorationSet set;
+	set.mesh = mesh;
+	set.transforms.push_back(transform);
+	set.dirty = true;
+	decorations.push_back(set);
+}
+
+void RegionBatcher::clear_decorations() {
+	for (DecorationSet &set : decorations) {
+		free_instance(set.instance);
+	}
+	decorations.clear();
+}
+
+void RegionBatcher::forget_decoration_instances() {
+	for (DecorationSet &set : decorations) {
+		set.instance = nullptr;
+		set.dirty = true;
+	}
+}
+
+void RegionBatcher::clear() {
+	for (KeyValue<Vector3i, Region> &kv : regions) {
+		free_instance(kv.value.instance);
+	}
+	regions.clear();
+	chunk_meshes.clear();
+	chunk_mesh_bytes = 0;
+	region_mesh_bytes = 0;
+	dirty_regions.clear();
+	update_memory_tracking();
+}
+
+void RegionBatcher::update_memory_tracking() {
+	tracked_meshes.set(chunk_mesh_bytes + region_mesh_bytes);
+}
+
+void RegionBatcher::free_instance(Node *instance) {
+	if (instance && parent) {
+		parent->remove_child(instance);
+		instance->queue_free();
+	}
+}
+
+int RegionBatcher::get_draw_call_count() const {
+	int count = 0;
+	for (const KeyValue<Vector3i, Region> &kv : regions) {
+		count += kv.value.surface_count;
+	}
+	return count + (int)decorations.size();
+}
+
+int RegionBatcher::get_decoration_instance_count() const {
+	int count = 0;
+	for (const DecorationSet &set : decorations) {
+		count += (int)set.transforms.size();
+	}
+	return count;
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,105 @@
+// region_batcher.h
+
+#ifndef REGION_BATCHER_H
+#define REGION_BATCHER_H
+
+#include "memory_tracker.h"
+#include "mesh_data.h"
+
+#include <vector>
+
+// Godot includes
+#include <godot_cpp/classes/material.hpp>
+#include <godot_cpp/classes/mesh.hpp>
+#include <godot_cpp/classes/mesh_instance3d.hpp>
+#include <godot_cpp/classes/multi_mesh_instance3d.hpp>
+#include <godot_cpp/classes/node3d.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/hash_set.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+using namespace godot;
+
+namespace voxel_engine {
+
+// Merges the meshes of region_size^3 chunks into one MeshInstance3D per
+// region, with one surface per material, so stable terrain costs a draw call
+// per region and material instead of one per chunk. The chunk meshes are kept
+// so a change in one chunk only re-merges its own region.
+//
+// Repeated decorations (grass, rocks...) go through one MultiMesh per mesh.
+class RegionBatcher {
+public:
+	// Instances are created as children of `parent`, which should be the node
+	// the chunks are placed in. Drops the chunk meshes batched so far, the
+	// decorations stay and move to the new parent on the next flush.
+	void configure(Node3D *parent, int region_size, int chunk_size);
+	int get_region_size() const { return region_size; }
+
+	// Replaces the mesh of a chunk and marks its region for re-merge
+	void set_chunk_mesh(const Vector3i &chunk_coord, const Ref<Material> &material, const MeshData &mesh);
+	void remove_chunk(const Vector3i &chunk_coord);
+	// Rebuilds the regions touched since the last flush, call from the main thread
+	void flush();
+	// Frees the region instances and forgets the chunk meshes, decorations
+	// are only dropped by clear_decorations()
+	void clear();
+
+	Vector3i get_region_coord(const Vector3i &chunk_coord) const;
+
+	// Region visibility follows its chunks: visible when any member is
+	void begin_visibility_pass();
+	void mark_chunk_visible(const Vector3i &chunk_coord);
+	void end_visibility_pass();
+
+	void add_decoration(const Ref<Mesh> &mesh, const Transform3D &transform);
+	void clear_decorations();
+	// The parent freed its children: the decorations are instanced again on
+	// the next flush
+	void forget_decoration_instances();
+
+	int get_region_count() const { return (int)regions.size(); }
+	// Surfaces across all regions plus one per decoration MultiMesh
+	int get_draw_call_count() const;
+	int get_decoration_instance_count() const;
+
+private:
+	struct ChunkEntry {
+		Ref<Material> material;
+		MeshData mesh;
+	};
+	struct Region {
+		MeshInstance3D *instance = nullptr;
+		int surface_count = 0;
+		int64_t mesh_bytes = 0;
+		bool visible = true;
+		bool pass_visible = false;
+	};
+	struct DecorationSet {
+		Ref<Mesh> mesh;
+		std::vector<Transform3D> transforms;
+		MultiMeshInstance3D *instance = nullptr;
+		bool dirty = false;
+	};
+
+	Node3D *parent = nullptr;
+	int region_size = 4;
+	int chunk_size = 8;
+	HashMap<Vector3i, ChunkEntry> chunk_meshes;
+	HashMap<Vector3i, Region> regions;
+	HashSet<Vector3i> dirty_regions;
+	std::vector<DecorationSet> decorations;
+	// Kept chunk meshes plus the merged region meshes
+	int64_t chunk_mesh_bytes = 0;
+	int64_t region_mesh_bytes = 0;
+	TrackedBytes tracked_meshes{ MemoryTracker::CATEGORY_MESHES };
+
+	void rebuild_region(const Vector3i &region_coord);
+	void free_instance(Node *instance);
+	void update_memory_tracking();
+};
+
+} // namespace voxel_engine
+
+#endif // REGION_BATCHER_H
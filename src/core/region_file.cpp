@@ -0,0 +1,72 @@
+#include "region_file.h"
+
+#include <cstring>
+
+namespace voxel_engine {
+
+namespace {
+
+const uint8_t MAGIC[4] = { 'V', 'X', 'R', 'G' };
+constexpr size_t HEADER_SIZE = 4 + 4 * 4;
+constexpr size_t CHUNK_HEADER_SIZE = 4 * 4;
+
+void write_u32(uint32_t value, std::vector<uint8_t> &r_bytes) {
+	for (int i = 0; i < 4; ++i) {
+		r_bytes.push_back((uint8_t)(value >> (i * 8)));
+	}
+}
+
+uint32_t read_u32(const uint8_t *data) {
+	return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+} // namespace
+
+void write_region_header(const RegionFileHeader &header, std::vector<uint8_t> &r_bytes) {
+	r_bytes.insert(r_bytes.end(), MAGIC, MAGIC + 4);
+	write_u32(header.version, r_bytes);
+	write_u32(header.chunk_size, r_bytes);
+	write_u32((uint32_t)header.seed, r_bytes);
+	write_u32(header.chunk_count, r_bytes);
+}
+
+void write_region_chunk(const godot::Vector3i &coord, const std::vector<uint8_t> &data, std::vector<uint8_t> &r_bytes) {
+	write_u32((uint32_t)coord.x, r_bytes);
+	write_u32((uint32_t)coord.y, r_bytes);
+	write_u32((uint32_t)coord.z, r_bytes);
+	write_u32((uint32_t)data.size(), r_bytes);
+	r_bytes.insert(r_bytes.end(), data.begin(), data.end());
+}
+
+bool read_region_file(const uint8_t *data, size_t length, RegionFileHeader &r_header, std::vector<RegionFileChunk> &r_chunks) {
+	if (length < HEADER_SIZE || memcmp(data, MAGIC, 4) != 0) {
+		return false;
+	}
+	r_header.version = read_u32(data + 4);
+	r_header.chunk_size = read_u32(data + 8);
+	r_header.seed = (int32_t)read_u32(data + 12);
+	r_header.chunk_count = read_u32(data + 16);
+	if (r_header.version > REGION_FILE_VERSION) {
+		return false;
+	}
+
+	r_chunks.clear();
+	size_t offset = HEADER_SIZE;
+	for (uint32_t i = 0; i < r_header.chunk_count; ++i) {
+		if (length - offset < CHUNK_HEADER_SIZE) {
+			return false;
+		}
+		RegionFileChunk chunk;
+		chunk.coord = godot::Vector3i((int32_t)read_u32(data + offset), (int32_t)read_u32(data + offset + 4), (int32_t)read_u32(data + offset + 8));
+		chunk.length = read_u32(data + offset + 12);
+		chunk.offset = offset + CHUNK_HEADER_SIZE;
+		if (length - chunk.offset < chunk.length) {
+			return false;
+		}
+		offset = chunk.offset + chunk.length;
+		r_chunks.push_back(chunk);
+	}
+	return true;
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,43 @@
+// region_file.h
+
+#ifndef REGION_FILE_H
+#define REGION_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <godot_cpp/variant/vector3i.hpp>
+
+namespace voxel_engine {
+
+// Pre-generated chunks, as written by VoxelGenerator::bake_region() and read
+// back by VoxelGenerator::load_region(). All values little endian:
+//
+//   "VXRG", u32 version, u32 chunk_size, i32 seed, u32 chunk_count
+//   per chunk: i32 x, i32 y, i32 z, u32 byte_count, then byte_count bytes of
+//   octree data (the Chunk::serialize_voxels() format)
+constexpr uint32_t REGION_FILE_VERSION = 1;
+
+struct RegionFileHeader {
+	uint32_t version = REGION_FILE_VERSION;
+	uint32_t chunk_size = 0;
+	int32_t seed = 0;
+	uint32_t chunk_count = 0;
+};
+
+struct RegionFileChunk {
+	godot::Vector3i coord;
+	size_t offset = 0; // Of the octree data in the file
+	uint32_t length = 0;
+};
+
+void write_region_header(const RegionFileHeader &header, std::vector<uint8_t> &r_bytes);
+void write_region_chunk(const godot::Vector3i &coord, const std::vector<uint8_t> &data, std::vector<uint8_t> &r_bytes);
+
+// Indexes the chunks of a whole file. False on a foreign, newer or truncated file.
+bool read_region_file(const uint8_t *data, size_t length, RegionFileHeader &r_header, std::vector<RegionFileChunk> &r_chunks);
+
+} // namespace voxel_engine
+
+#endif // REGION_FILE_H
@@ -1,4 +1,5 @@
 #include "voxel.h"
+#include "chunk.h"
 
 // Godot includes
 #include <godot_cpp/core/class_db.hpp>
@@ -31,10 +32,7 @@ void Voxel::_bind_methods() {
 }
 
 Voxel::Voxel() {
-	// Default constructor implementation
-	size = 1; // Default size
-	position = Vector3(0, 0, 0);
-	type = VoxelType::DIRT;
+	tracked.set(sizeof(Voxel));
 }
 
 Voxel::~Voxel() {
@@ -42,35 +40,61 @@ Voxel::~Voxel() {
 }
 
 Vector3 Voxel::get_position() const {
-	return position;
+	return is_bound() ? Vector3(get_local_position()) : position;
 }
 
 void Voxel::set_position(const Vector3 &p_position) {
+	ERR_FAIL_COND_MSG(is_bound(), "The position of a chunk's voxel follows from its index.");
 	position = p_position;
 }
 
+Vector3i Voxel::get_local_position() const {
+	const int area = chunk_size * chunk_size;
+	return Vector3i(index % chunk_size, index / area, (index / chunk_size) % chunk_size);
+}
+
 int Voxel::get_size() const {
  return size;
 }
 
 void Voxel::set_size(int p_size) {
  if (p_size > 0) {
-  size = p_size;
+  size = (uint16_t)MIN(p_size, UINT16_MAX);
  } else {
   size = 1; // Default to 1 if invalid size is set
  }
 }
 
+void Voxel::bind_to_chunk(ObjectID p_chunk, uint32_t p_index, int p_chunk_size, int p_type) {
+	owner_chunk = p_chunk;
+	index = p_index;
+	chunk_size = (uint8_t)p_chunk_size;
+	type = (uint8_t)p_type;
+}
+
 int Voxel::get_type() const {
+	if (owner_chunk.is_valid()) {
+		const Chunk *chunk = Object::cast_to<Chunk>(ObjectDB::get_instance(owner_chunk));
+		if (chunk) {
+			return chunk->get_voxel_type(get_local_position());
+		}
+	}
 	return static_cast<int>(type);
 }
 
 void Voxel::set_type(int p_type) {
-	type = static_cast<VoxelType>(p_type);
+	ERR_FAIL_INDEX(p_type, VOXEL_TYPE_COUNT);
+	type = (uint8_t)p_type;
+	if (owner_chunk.is_valid()) {
+		Chunk *chunk = Object::cast_to<Chunk>(ObjectDB::get_instance(owner_chunk));
+		if (chunk) {
+			chunk->set_voxel(get_local_position(), p_type);
+		}
+	}
 }
 
 bool Voxel::is_solid() const {
-	return type != static_cast<int>(VoxelType::AIR);
+	return get_type() != static_cast<int>(VoxelType::AIR);
 }
 
 } // namespace voxel_engine
\ No newline at end of file
@@ -3,11 +3,17 @@
 #ifndef VOXEL_H
 #define VOXEL_H
 
+#include "memory_tracker.h"
+#include "voxel_constants.h"
+
 // Godot includes
 #include <godot_cpp/classes/node3d.hpp>
 #include <godot_cpp/classes/ref_counted.hpp>
 #include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/object_id.hpp>
+#include <godot_cpp/variant/color.hpp>
 #include <godot_cpp/variant/vector3.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
 
 using namespace godot;
 
@@ -29,6 +35,68 @@ enum VoxelType {
 	// Add more voxel types as needed
 };
 
+constexpr int VOXEL_TYPE_COUNT = COAL + 1;
+
+// Property flags (VOXEL_PROPERTY_*) describing how a voxel type behaves
+inline unsigned int get_voxel_type_properties(int type) {
+	switch (type) {
+		case AIR:
+			return VOXEL_PROPERTY_TRANSPARENT;
+		case WATER:
+			return VOXEL_PROPERTY_TRANSPARENT | VOXEL_PROPERTY_LIQUID;
+		case LAVA:
+			return VOXEL_PROPERTY_LIQUID | VOXEL_PROPERTY_EMISSIVE;
+		default:
+			return VOXEL_PROPERTY_COLLIDABLE | VOXEL_PROPERTY_OPAQUE;
+	}
+}
+
+inline bool is_voxel_type_liquid(int type) {
+	return (get_voxel_type_properties(type) & VOXEL_PROPERTY_LIQUID) != 0;
+}
+
+inline bool is_voxel_type_opaque(int type) {
+	return (get_voxel_type_properties(type) & VOXEL_PROPERTY_OPAQUE) != 0;
+}
+
+// Block light level a voxel type gives off, 0 for most types
+inline int get_voxel_type_emission(int type) {
+	return (get_voxel_type_properties(type) & VOXEL_PROPERTY_EMISSIVE) != 0 ? 15 : 0;
+}
+
+// Base color used by the blocky mesher until voxel types get textures
+inline Color get_voxel_type_color(int type) {
+	switch (type) {
+		case DIRT:
+			return Color(0.45f, 0.32f, 0.2f);
+		case GRASS:
+			return Color(0.3f, 0.6f, 0.2f);
+		case STONE:
+			return Color(0.5f, 0.5f, 0.52f);
+		case WATER:
+			return Color(0.2f, 0.4f, 0.8f, 0.6f);
+		case SAND:
+			return Color(0.85f, 0.8f, 0.55f);
+		case LAVA:
+			return Color(1.0f, 0.4f, 0.1f);
+		case GOLD:
+			return Color(0.9f, 0.75f, 0.2f);
+		case DIAMOND:
+			return Color(0.5f, 0.9f, 0.95f);
+		case IRON:
+			return Color(0.7f, 0.6f, 0.55f);
+		case COAL:
+			return Color(0.15f, 0.15f, 0.15f);
+		default:
+			return Color(1.0f, 1.0f, 1.0f, 0.0f);
+	}
+}
+
+// A voxel for scripts. Either standalone, holding its own type and position,
+// or a view over a chunk's packed storage (see Chunk::get_voxel): views only
+// keep the chunk and the voxel's index, reads and writes go through to the
+// chunk and the position is computed from the index. Chunks create views on
+// demand, nothing is allocated for voxels scripts never ask about.
 class Voxel : public RefCounted {
 	GDCLASS(Voxel, RefCounted);
 
@@ -50,10 +118,24 @@ public:
 	void set_size(int size);
 	int get_size() const;
 
+	// Read and write the type through to a chunk's voxel storage instead of the
+	// local copy. `p_index` follows VoxelBuffer's layout for `p_chunk_size`.
+	// `p_type` is the voxel's current type: once the chunk is freed the view
+	// reads that, or whatever was last set through it.
+	void bind_to_chunk(ObjectID p_chunk, uint32_t p_index, int p_chunk_size, int p_type);
+	bool is_bound() const { return owner_chunk.is_valid(); }
+
 private:
+	Vector3i get_local_position() const;
+
 	Vector3 position;
-	int type;
-	int size;
+	uint8_t type = VoxelType::DIRT;
+	uint8_t chunk_size = 0;
+	uint16_t size = 1;
+	uint32_t index = 0;
+	ObjectID owner_chunk;
+	// Live views are what scripts hold, see CATEGORY_VOXEL_OBJECTS
+	TrackedBytes tracked{ MemoryTracker::CATEGORY_VOXEL_OBJECTS };
 };
 
 } //namespace voxel_engine
@@ -0,0 +1,105 @@
+#include "voxel_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace voxel_engine {
+
+void VoxelBuffer::create(int p_size, uint8_t p_fill) {
+	size = p_size > 0 ? p_size : 0;
+	// Never reuses the storage, a copy may still read it
+	storage = std::make_shared<std::vector<uint8_t>>((size_t)size * size * size, p_fill);
+	types = storage->data();
+}
+
+void VoxelBuffer::detach() {
+	storage = std::make_shared<std::vector<uint8_t>>(*storage);
+	types = storage->data();
+}
+
+void VoxelBuffer::fill(uint8_t type) {
+	if (storage.use_count() > 1) {
+		// Nothing to copy, every voxel is overwritten
+		create(size, type);
+		return;
+	}
+	std::memset(types, type, (size_t)get_volume());
+}
+
+bool VoxelBuffer::clip_box(const godot::Vector3i &from, const godot::Vector3i &to, godot::Vector3i &r_from, godot::Vector3i &r_to) const {
+	for (int axis = 0; axis < 3; ++axis) {
+		r_from[axis] = std::max(from[axis], 0);
+		r_to[axis] = std::min(to[axis], size - 1);
+		if (r_from[axis] > r_to[axis]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void VoxelBuffer::fill_box(const godot::Vector3i &from, const godot::Vector3i &to, uint8_t type) {
+	godot::Vector3i lo, hi;
+	if (!clip_box(from, to, lo, hi)) {
+		return;
+	}
+	copy_on_write();
+	const int row_length = hi.x - lo.x + 1;
+	for (int y = lo.y; y <= hi.y; ++y) {
+		for (int z = lo.z; z <= hi.z; ++z) {
+			std::memset(&types[get_index(lo.x, y, z)], type, row_length);
+		}
+	}
+}
+
+int VoxelBuffer::replace_in_box(const godot::Vector3i &from, const godot::Vector3i &to, uint8_t old_type, uint8_t new_type) {
+	godot::Vector3i lo, hi;
+	if (!clip_box(from, to, lo, hi)) {
+		return 0;
+	}
+	copy_on_write();
+	int replaced = 0;
+	for (int y = lo.y; y <= hi.y; ++y) {
+		for (int z = lo.z; z <= hi.z; ++z) {
+			uint8_t *row = &types[get_index(lo.x, y, z)];
+			for (int x = 0; x <= hi.x - lo.x; ++x) {
+				const bool match = row[x] == old_type;
+				row[x] = match ? new_type : row[x];
+				replaced += match ? 1 : 0;
+			}
+		}
+	}
+	return replaced;
+}
+
+void VoxelBuffer::copy_box_to(const godot::Vector3i &from, const godot::Vector3i &to, uint8_t *dst) const {
+	const godot::Vector3i box_size = to - from + godot::Vector3i(1, 1, 1);
+	godot::Vector3i lo, hi;
+	if (!clip_box(from, to, lo, hi)) {
+		return;
+	}
+	const int row_length = hi.x - lo.x + 1;
+	for (int y = lo.y; y <= hi.y; ++y) {
+		for (int z = lo.z; z <= hi.z; ++z) {
+			const size_t dst_index = (size_t)(lo.x - from.x) + (size_t)box_size.x * ((z - from.z) + (size_t)box_size.z * (y - from.y));
+			std::memcpy(dst + dst_index, &types[get_index(lo.x, y, z)], row_length);
+		}
+	}
+}
+
+void VoxelBuffer::copy_box_from(const godot::Vector3i &from, const godot::Vector3i &to, const uint8_t *src) {
+	const godot::Vector3i box_size = to - from + godot::Vector3i(1, 1, 1);
+	godot::Vector3i lo, hi;
+	if (!clip_box(from, to, lo, hi)) {
+		return;
+	}
+	copy_on_write();
+	const int row_length = hi.x - lo.x + 1;
+	for (int y = lo.y; y <= hi.y; ++y) {
+		for (int z = lo.z; z <= hi.z; ++z) {
+			const size_t src_index = (size_t)(lo.x - from.x) + (size_t)box_size.x * ((z - from.z) + (size_t)box_size.z * (y - from.y));
+			std::memcpy(&types[get_index(lo.x, y, z)], src + src_index, row_length);
+		}
+	}
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,87 @@
+// voxel_buffer.h
+
+#ifndef VOXEL_BUFFER_H
+#define VOXEL_BUFFER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <godot_cpp/variant/vector3i.hpp>
+
+namespace voxel_engine {
+
+// Dense cubic block of voxel types, one byte per voxel.
+// Voxels are laid out X-fastest, then Z, then Y so that rows along X are
+// contiguous (box copies become one memcpy per row) and horizontal layers are
+// contiguous (filling everything below a height is a single memset).
+//
+// Copies share their voxels until one of them is written (copy on write), so
+// a copy is a snapshot costing a reference count, and only buffers modified
+// afterwards get duplicated. Pointers from ptrw() are only valid until the
+// buffer is copied.
+class VoxelBuffer {
+public:
+	VoxelBuffer() = default;
+
+	void create(int p_size, uint8_t p_fill = 0);
+	int get_size() const { return size; }
+	int get_volume() const { return size * size * size; }
+
+	inline bool is_in_bounds(int x, int y, int z) const {
+		return x >= 0 && x < size && y >= 0 && y < size && z >= 0 && z < size;
+	}
+	inline bool is_in_bounds(const godot::Vector3i &pos) const {
+		return is_in_bounds(pos.x, pos.y, pos.z);
+	}
+	inline int get_index(int x, int y, int z) const {
+		return x + size * (z + size * y);
+	}
+
+	inline uint8_t get(int x, int y, int z) const { return types[get_index(x, y, z)]; }
+	inline void set(int x, int y, int z, uint8_t type) {
+		copy_on_write();
+		types[get_index(x, y, z)] = type;
+	}
+	inline uint8_t get_at_index(int index) const { return types[index]; }
+	inline void set_at_index(int index, uint8_t type) {
+		copy_on_write();
+		types[index] = type;
+	}
+
+	const uint8_t *ptr() const { return types; }
+	uint8_t *ptrw() {
+		copy_on_write();
+		return types;
+	}
+
+	// Whether both buffers still read the same voxels, i.e. one is an
+	// unmodified copy of the other
+	bool is_shared_with(const VoxelBuffer &other) const { return storage == other.storage; }
+
+	void fill(uint8_t type);
+
+	// Box operations take inclusive voxel ranges and ignore the parts outside the buffer.
+	// Copies use a tightly packed box of (to - from + 1) voxels in the same X, Z, Y order.
+	void fill_box(const godot::Vector3i &from, const godot::Vector3i &to, uint8_t type);
+	int replace_in_box(const godot::Vector3i &from, const godot::Vector3i &to, uint8_t old_type, uint8_t new_type);
+	void copy_box_to(const godot::Vector3i &from, const godot::Vector3i &to, uint8_t *dst) const;
+	void copy_box_from(const godot::Vector3i &from, const godot::Vector3i &to, const uint8_t *src);
+
+private:
+	inline void copy_on_write() {
+		if (storage.use_count() > 1) {
+			detach();
+		}
+	}
+	void detach();
+	bool clip_box(const godot::Vector3i &from, const godot::Vector3i &to, godot::Vector3i &r_from, godot::Vector3i &r_to) const;
+
+	int size = 0;
+	std::shared_ptr<std::vector<uint8_t>> storage;
+	uint8_t *types = nullptr; // storage->data(), shared by copies
+};
+
+} // namespace voxel_engine
+
+#endif // VOXEL_BUFFER_H
@@ -0,0 +1,133 @@
+#include "voxel_material.h"
+#include "chunk_mesher.h"
+#include "light_engine.h"
+#include "mesh_data.h"
+#include "voxel.h"
+
+// Godot includes
+#include <godot_cpp/classes/shader.hpp>
+#include <godot_cpp/variant/packed_color_array.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+
+namespace voxel_engine {
+
+namespace {
+
+// VOXEL_TYPE_COUNT and NORMAL_MAX are substituted before compiling
+const char *SHADER_CODE = R"(
+shader_type spatial;
+
+uniform vec4 type_colors[VOXEL_TYPE_COUNT];
+uniform float light_curve[16];
+uniform float ao_curve[4];
+// Layer n is the texture of voxel type n, sampled in world space (texture_scale
+// repeats per voxel) and blended between the three axis projections
+uniform bool use_textures = false;
+uniform sampler2DArray type_textures : source_color, filter_nearest_mipmap, repeat_enable;
+uniform float texture_scale = 1.0;
+uniform float triplanar_sharpness = 4.0;
+
+varying flat int voxel_type;
+varying vec3 world_position;
+varying vec3 world_normal;
+
+vec2 sign_not_zero(vec2 v) {
+	return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec3 decode_normal(uint word) {
+	vec2 uv = vec2(float(word & 63u), float((word >> 6u) & 63u)) / NORMAL_MAX * 2.0 - 1.0;
+	vec3 n = vec3(uv, 1.0 - abs(uv.x) - abs(uv.y));
+	if (n.z < 0.0) {
+		n.xy = (1.0 - abs(n.yx)) * sign_not_zero(n.xy);
+	}
+	return normalize(n);
+}
+
+void vertex() {
+	uvec4 bytes = uvec4(round(CUSTOM0 * 255.0));
+	uint word = bytes.b | (bytes.a << 8u);
+	if ((word & 0x8000u) != 0u) {
+		NORMAL = decode_normal(word);
+	}
+
+	uint light = bytes.g;
+	bool emissive = ((word >> 14u) & 1u) != 0u;
+	float brightness = emissive ? 1.0 : light_curve[int(max(light >> 4u, light & 15u))];
+	float occlusion = ao_curve[int((word >> 12u) & 3u)];
+	// Vertex colors, white when the mesh has none, tint the result
+	COLOR = vec4(COLOR.rgb * brightness * occlusion, 1.0);
+
+	voxel_type = min(int(bytes.r), VOXEL_TYPE_COUNT - 1);
+	world_position = (MODEL_MATRIX * vec4(VERTEX, 1.0)).xyz;
+	world_normal = normalize((MODEL_MATRIX * vec4(NORMAL, 0.0)).xyz);
+}
+
+void fragment() {
+	vec3 albedo = type_colors[voxel_type].rgb;
+	if (use_textures) {
+		// Axis aligned faces get a single projection, no extra samples
+		vec3 weights = pow(abs(normalize(world_normal)), vec3(triplanar_sharpness));
+		weights /= weights.x + weights.y + weights.z;
+		vec3 p = world_position * texture_scale;
+		// Derivatives are taken outside the branches, mip selection stays right
+		vec3 dx = dFdx(p);
+		vec3 dy = dFdy(p);
+		float layer = float(voxel_type);
+		albedo = vec3(0.0);
+		if (weights.x > 0.001) {
+			albedo += textureGrad(type_textures, vec3(p.zy, layer), dx.zy, dy.zy).rgb * weights.x;
+		}
+		if (weights.y > 0.001) {
+			albedo += textureGrad(type_textures, vec3(p.xz, layer), dx.xz, dy.xz).rgb * weights.y;
+		}
+		if (weights.z > 0.001) {
+			albedo += textureGrad(type_textures, vec3(p.xy, layer), dx.xy, dy.xy).rgb * weights.z;
+		}
+	}
+	ALBEDO = albedo * COLOR.rgb;
+}
+)";
+
+} // namespace
+
+String VoxelMaterial::get_shader_code() {
+	return String(SHADER_CODE)
+			.replace("VOXEL_TYPE_COUNT", String::num_int64(VOXEL_TYPE_COUNT))
+			.replace("NORMAL_MAX", String::num_int64(VOXEL_NORMAL_MAX) + ".0");
+}
+
+Ref<ShaderMaterial> VoxelMaterial::create(const Ref<Texture2DArray> &textures) {
+	Ref<Shader> shader;
+	shader.instantiate();
+	shader->set_code(get_shader_code());
+
+	PackedColorArray type_colors;
+	for (int type = 0; type < VOXEL_TYPE_COUNT; ++type) {
+		type_colors.push_back(get_voxel_type_color(type));
+	}
+	PackedFloat32Array light_curve;
+	for (int level = 0; level <= MAX_LIGHT; ++level) {
+		light_curve.push_back(get_light_brightness(make_light(level, 0)));
+	}
+	PackedFloat32Array ao_curve;
+	for (float brightness : ChunkMesher::AO_CURVE) {
+		ao_curve.push_back(brightness);
+	}
+
+	Ref<ShaderMaterial> material;
+	material.instantiate();
+	material->set_shader(shader);
+	material->set_shader_parameter("type_colors", type_colors);
+	material->set_shader_parameter("light_curve", light_curve);
+	material->set_shader_parameter("ao_curve", ao_curve);
+	set_textures(material, textures);
+	return material;
+}
+
+void VoxelMaterial::set_textures(const Ref<ShaderMaterial> &material, const Ref<Texture2DArray> &textures) {
+	material->set_shader_parameter("use_textures", textures.is_valid());
+	material->set_shader_parameter("type_textures", textures);
+}
+
+} // namespace voxel_engine
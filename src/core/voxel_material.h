@@ -0,0 +1,32 @@
+// voxel_material.h
+
+#ifndef VOXEL_MATERIAL_H
+#define VOXEL_MATERIAL_H
+
+// Godot includes
+#include <godot_cpp/classes/shader_material.hpp>
+#include <godot_cpp/classes/texture2d_array.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+using namespace godot;
+
+namespace voxel_engine {
+
+// Material for the compact meshes. The vertex shader decodes the packed
+// attribute (see pack_voxel_vertex) into the normal, light and AO, lit and
+// occluded the way the plain vertex colors are, so both formats look the
+// same. The voxel type picks a palette color, or a layer of the shared
+// texture array mapped triplanar, so every voxel type of a mesh is drawn by
+// one surface with one material.
+class VoxelMaterial {
+public:
+	// A new material with the palette and curves filled in. `textures` has
+	// one layer per voxel type, null keeps the palette colors.
+	static Ref<ShaderMaterial> create(const Ref<Texture2DArray> &textures = Ref<Texture2DArray>());
+	static void set_textures(const Ref<ShaderMaterial> &material, const Ref<Texture2DArray> &textures);
+	static String get_shader_code();
+};
+
+} // namespace voxel_engine
+
+#endif // VOXEL_MATERIAL_H
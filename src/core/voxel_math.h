@@ -0,0 +1,66 @@
+// voxel_math.h
+#pragma once
+
+#include <cmath>
+
+#include <godot_cpp/variant/aabb.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+namespace voxel_engine {
+
+// Integer division rounding towards negative infinity (-1 / 8 == -1)
+inline int floor_div(int value, int divisor) {
+	int q = value / divisor;
+	if ((value % divisor != 0) && ((value < 0) != (divisor < 0))) {
+		--q;
+	}
+	return q;
+}
+
+// Modulo that always returns a value in [0, divisor)
+inline int floor_mod(int value, int divisor) {
+	int r = value % divisor;
+	if (r < 0) {
+		r += divisor;
+	}
+	return r;
+}
+
+// Convert a world voxel position to the coordinate of the chunk containing it
+inline godot::Vector3i world_to_chunk_coord(const godot::Vector3i &world_pos, int chunk_size) {
+	return godot::Vector3i(
+			floor_div(world_pos.x, chunk_size),
+			floor_div(world_pos.y, chunk_size),
+			floor_div(world_pos.z, chunk_size));
+}
+
+// Convert a world voxel position to a position local to its chunk
+inline godot::Vector3i world_to_local_pos(const godot::Vector3i &world_pos, int chunk_size) {
+	return godot::Vector3i(
+			floor_mod(world_pos.x, chunk_size),
+			floor_mod(world_pos.y, chunk_size),
+			floor_mod(world_pos.z, chunk_size));
+}
+
+// Voxel cell containing a continuous position
+inline godot::Vector3i world_to_voxel(const godot::Vector3 &position) {
+	return godot::Vector3i(
+			(int)std::floor(position.x),
+			(int)std::floor(position.y),
+			(int)std::floor(position.z));
+}
+
+// Inclusive range of voxels touched by a box. A box ending exactly on a voxel
+// boundary doesn't touch the next voxel.
+inline void aabb_to_voxel_range(const godot::AABB &box, godot::Vector3i &r_from, godot::Vector3i &r_to) {
+	const godot::AABB abs_box = box.abs();
+	const godot::Vector3 end = abs_box.get_end();
+	r_from = world_to_voxel(abs_box.position);
+	r_to = godot::Vector3i(
+			(int)std::ceil(end.x) - 1,
+			(int)std::ceil(end.y) - 1,
+			(int)std::ceil(end.z) - 1);
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,438 @@
+#include "voxel_octree.h"
+
+#include <array>
+#include <cstring>
+#include <map>
+
+using namespace godot;
+
+namespace voxel_engine {
+
+namespace {
+
+const uint8_t SERIALIZATION_MAGIC[4] = { 'S', 'V', 'O', '1' };
+
+enum NodeTag : uint8_t {
+	TAG_LEAF = 0,
+	TAG_BRANCH = 1
+};
+
+void write_u16(std::vector<uint8_t> &out, uint16_t value) {
+	out.push_back(value & 0xFF);
+	out.push_back(value >> 8);
+}
+
+void write_u32(std::vector<uint8_t> &out, uint32_t value) {
+	for (int i = 0; i < 4; ++i) {
+		out.push_back((value >> (i * 8)) & 0xFF);
+	}
+}
+
+void patch_u32(std::vector<uint8_t> &out, size_t offset, uint32_t value) {
+	for (int i = 0; i < 4; ++i) {
+		out[offset + i] = (value >> (i * 8)) & 0xFF;
+	}
+}
+
+uint32_t read_u32(const uint8_t *data) {
+	return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+struct DagWriter {
+	std::vector<uint8_t> &out;
+	uint32_t count = 0;
+	int32_t leaf_ids[256];
+	std::map<std::array<uint32_t, 8>, uint32_t> branch_ids;
+
+	explicit DagWriter(std::vector<uint8_t> &p_out) :
+			out(p_out) {
+		for (int32_t &id : leaf_ids) {
+			id = -1;
+		}
+	}
+};
+
+struct DagEntry {
+	bool leaf = true;
+	uint8_t type = 0;
+	std::array<uint32_t, 8> children;
+};
+
+} // namespace
+
+void VoxelOctree::create(int p_size, uint8_t p_fill) {
+	size = p_size;
+	root_size = 1;
+	while (root_size < size) {
+		root_size *= 2;
+	}
+	nodes.clear();
+	free_blocks.clear();
+	nodes.push_back(Node());
+	nodes[0].type = p_fill;
+}
+
+uint8_t VoxelOctree::get(int x, int y, int z) const {
+	uint32_t node = 0;
+	int half = root_size / 2;
+	while (!is_leaf(node)) {
+		const int slot = get_child_slot(x, y, z, half);
+		node = nodes[node].first_child + slot;
+		// Make coordinates relative to the child
+		x -= (slot & 1) ? half : 0;
+		y -= (slot & 2) ? half : 0;
+		z -= (slot & 4) ? half : 0;
+		half /= 2;
+	}
+	return nodes[node].type;
+}
+
+void VoxelOctree::set(int x, int y, int z, uint8_t type) {
+	if (is_in_bounds(x, y, z)) {
+		set_recursive(0, root_size, x, y, z, type);
+	}
+}
+
+void VoxelOctree::set_recursive(uint32_t node, int node_size, int x, int y, int z, uint8_t type) {
+	if (is_leaf(node)) {
+		if (nodes[node].type == type) {
+			return;
+		}
+		if (node_size == 1) {
+			nodes[node].type = type;
+			return;
+		}
+		split(node);
+	}
+	const int half = node_size / 2;
+	const int slot = get_child_slot(x, y, z, half);
+	const Vector3i offset = get_child_offset(slot, half);
+	set_recursive(nodes[node].first_child + slot, half, x - offset.x, y - offset.y, z - offset.z, type);
+	try_collapse(node);
+}
+
+void VoxelOctree::fill(uint8_t type) {
+	create(size, type);
+}
+
+bool VoxelOctree::clip_box(const Vector3i &from, const Vector3i &to, Vector3i &r_from, Vector3i &r_to) const {
+	r_from = Vector3i(MAX(from.x, 0), MAX(from.y, 0), MAX(from.z, 0));
+	r_to = Vector3i(MIN(to.x, size - 1), MIN(to.y, size - 1), MIN(to.z, size - 1));
+	return r_from.x <= r_to.x && r_from.y <= r_to.y && r_from.z <= r_to.z;
+}
+
+void VoxelOctree::fill_box(const Vector3i &from, const Vector3i &to, uint8_t type) {
+	Vector3i lo, hi;
+	if (!clip_box(from, to, lo, hi)) {
+		return;
+	}
+	// Boxes reaching the far edge also cover the hidden padding, so a full fill collapses to one leaf
+	for (int axis = 0; axis < 3; ++axis) {
+		if (hi[axis] == size - 1) {
+			hi[axis] = root_size - 1;
+		}
+	}
+	fill_box_recursive(0, Vector3i(), root_size, lo, hi, type);
+}
+
+void VoxelOctree::fill_box_recursive(uint32_t node, const Vector3i &origin, int node_size, const Vector3i &from, const Vector3i &to, uint8_t type) {
+	const Vector3i end = origin + Vector3i(node_size - 1, node_size - 1, node_size - 1);
+	if (end.x < from.x || end.y < from.y || end.z < from.z || origin.x > to.x || origin.y > to.y || origin.z > to.z) {
+		return;
+	}
+	if (origin.x >= from.x && origin.y >= from.y && origin.z >= from.z && end.x <= to.x && end.y <= to.y && end.z <= to.z) {
+		free_subtree(node);
+		nodes[node].type = type;
+		return;
+	}
+	if (is_leaf(node)) {
+		if (nodes[node].type == type) {
+			return;
+		}
+		split(node);
+	}
+	const int half = node_size / 2;
+	for (int slot = 0; slot < 8; ++slot) {
+		fill_box_recursive(nodes[node].first_child + slot, origin + get_child_offset(slot, half), half, from, to, type);
+	}
+	try_collapse(node);
+}
+
+int VoxelOctree::replace_in_box(const Vector3i &from, const Vector3i &to, uint8_t old_type, uint8_t new_type) {
+	Vector3i lo, hi;
+	if (!clip_box(from, to, lo, hi) || old_type == new_type) {
+		return 0;
+	}
+	return replace_recursive(0, Vector3i(), root_size, lo, hi, old_type, new_type);
+}
+
+int VoxelOctree::replace_recursive(uint32_t node, const Vector3i &origin, int node_size, const Vector3i &from, const Vector3i &to, uint8_t old_type, uint8_t new_type) {
+	const Vector3i end = origin + Vector3i(node_size - 1, node_size - 1, node_size - 1);
+	if (end.x < from.x || end.y < from.y || end.z < from.z || origin.x > to.x || origin.y > to.y || origin.z > to.z) {
+		return 0;
+	}
+	if (is_leaf(node)) {
+		if (nodes[node].type != old_type) {
+			return 0;
+		}
+		if (origin.x >= from.x && origin.y >= from.y && origin.z >= from.z && end.x <= to.x && end.y <= to.y && end.z <= to.z) {
+			nodes[node].type = new_type;
+			return node_size * node_size * node_size;
+		}
+		split(node);
+	}
+	const int half = node_size / 2;
+	int count = 0;
+	for (int slot = 0; slot < 8; ++slot) {
+		count += replace_recursive(nodes[node].first_child + slot, origin + get_child_offset(slot, half), half, from, to, old_type, new_type);
+	}
+	try_collapse(node);
+	return count;
+}
+
+void VoxelOctree::copy_box_to(const Vector3i &from, const Vector3i &to, uint8_t *dst) const {
+	const Vector3i box_size = to - from + Vector3i(1, 1, 1);
+	// One memset per row of each uniform region
+	for_each_leaf_in_box(from, to, [&](const Vector3i &lo, const Vector3i &hi, uint8_t type) {
+		const int row_length = hi.x - lo.x + 1;
+		for (int y = lo.y; y <= hi.y; ++y) {
+			for (int z = lo.z; z <= hi.z; ++z) {
+				const int64_t index = (lo.x - from.x) + (int64_t)box_size.x * ((z - from.z) + (int64_t)box_size.z * (y - from.y));
+				memset(dst + index, type, row_length);
+			}
+		}
+	});
+}
+
+void VoxelOctree::copy_box_from(const Vector3i &from, const Vector3i &to, const uint8_t *src) {
+	Vector3i lo, hi;
+	if (!clip_box(from, to, lo, hi)) {
+		return;
+	}
+	const Vector3i box_size = to - from + Vector3i(1, 1, 1);
+	for (int y = lo.y; y <= hi.y; ++y) {
+		for (int z = lo.z; z <= hi.z; ++z) {
+			const int64_t row = (int64_t)box_size.x * ((z - from.z) + (int64_t)box_size.z * (y - from.y)) - from.x;
+			for (int x = lo.x; x <= hi.x; ++x) {
+				set_recursive(0, root_size, x, y, z, src[row + x]);
+			}
+		}
+	}
+}
+
+void VoxelOctree::from_buffer(const VoxelBuffer &buffer) {
+	create(buffer.get_size(), 0);
+	if (size > 0) {
+		build_recursive(0, Vector3i(), root_size, buffer);
+	}
+}
+
+void VoxelOctree::build_recursive(uint32_t node, const Vector3i &origin, int node_size, const VoxelBuffer &buffer) {
+	if (node_size == 1) {
+		// Padding repeats the last voxel so it never blocks a merge
+		nodes[node].type = buffer.get(MIN(origin.x, size - 1), MIN(origin.y, size - 1), MIN(origin.z, size - 1));
+		return;
+	}
+	const uint32_t first_child = allocate_children(0);
+	nodes[node].first_child = first_child;
+	const int half = node_size / 2;
+	for (int slot = 0; slot < 8; ++slot) {
+		build_recursive(first_child + slot, origin + get_child_offset(slot, half), half, buffer);
+	}
+	try_collapse(node);
+}
+
+void VoxelOctree::to_buffer(VoxelBuffer &r_buffer) const {
+	r_buffer.create(size, 0);
+	for_each_leaf_in_box(Vector3i(), Vector3i(size - 1, size - 1, size - 1), [&r_buffer](const Vector3i &lo, const Vector3i &hi, uint8_t type) {
+		r_buffer.fill_box(lo, hi, type);
+	});
+}
+
+uint32_t VoxelOctree::allocate_children(uint8_t type) {
+	uint32_t first_child;
+	if (!free_blocks.empty()) {
+		first_child = free_blocks.back();
+		free_blocks.pop_back();
+	} else {
+		first_child = (uint32_t)nodes.size();
+		nodes.resize(nodes.size() + 8);
+	}
+	for (int slot = 0; slot < 8; ++slot) {
+		nodes[first_child + slot].first_child = NO_CHILDREN;
+		nodes[first_child + slot].type = type;
+	}
+	return first_child;
+}
+
+void VoxelOctree::split(uint32_t node) {
+	const uint32_t first_child = allocate_children(nodes[node].type);
+	nodes[node].first_child = first_child;
+}
+
+void VoxelOctree::free_subtree(uint32_t node) {
+	if (is_leaf(node)) {
+		return;
+	}
+	const uint32_t first_child = nodes[node].first_child;
+	for (int slot = 0; slot < 8; ++slot) {
+		free_subtree(first_child + slot);
+	}
+	free_blocks.push_back(first_child);
+	nodes[node].first_child = NO_CHILDREN;
+}
+
+void VoxelOctree::try_collapse(uint32_t node) {
+	if (is_leaf(node)) {
+		return;
+	}
+	const uint32_t first_child = nodes[node].first_child;
+	const uint8_t type = nodes[first_child].type;
+	for (int slot = 0; slot < 8; ++slot) {
+		if (!is_leaf(first_child + slot) || nodes[first_child + slot].type != type) {
+			return;
+		}
+	}
+	free_blocks.push_back(first_child);
+	nodes[node].first_child = NO_CHILDREN;
+	nodes[node].type = type;
+}
+
+std::vector<uint8_t> VoxelOctree::serialize() const {
+	std::vector<uint8_t> out;
+	out.insert(out.end(), SERIALIZATION_MAGIC, SERIALIZATION_MAGIC + 4);
+	write_u16(out, (uint16_t)size);
+	const size_t count_offset = out.size();
+	write_u32(out, 0);
+
+	// Post-order walk, each distinct subtree is written once and referenced by id
+	DagWriter writer(out);
+	struct Walker {
+		const VoxelOctree &tree;
+		DagWriter &writer;
+
+		uint32_t visit(uint32_t node) {
+			if (tree.is_leaf(node)) {
+				const uint8_t type = tree.nodes[node].type;
+				if (writer.leaf_ids[type] < 0) {
+					writer.out.push_back(TAG_LEAF);
+					writer.out.push_back(type);
+					writer.leaf_ids[type] = (int32_t)writer.count++;
+				}
+				return (uint32_t)writer.leaf_ids[type];
+			}
+			std::array<uint32_t, 8> children;
+			for (int slot = 0; slot < 8; ++slot) {
+				children[slot] = visit(tree.nodes[node].first_child + slot);
+			}
+			auto it = writer.branch_ids.find(children);
+			if (it != writer.branch_ids.end()) {
+				return it->second;
+			}
+			writer.out.push_back(TAG_BRANCH);
+			for (uint32_t child : children) {
+				write_u32(writer.out, child);
+			}
+			const uint32_t id = writer.count++;
+			writer.branch_ids.emplace(children, id);
+			return id;
+		}
+	};
+	Walker walker{ *this, writer };
+	if (size > 0) {
+		walker.visit(0);
+	}
+	patch_u32(out, count_offset, writer.count);
+	return out;
+}
+
+bool VoxelOctree::deserialize(const uint8_t *data, size_t length, int expected_size) {
+	if (length < 10 || memcmp(data, SERIALIZATION_MAGIC, 4) != 0) {
+		return false;
+	}
+	const int new_size = data[4] | (data[5] << 8);
+	// A small shared DAG can declare a huge size, check it before expanding
+	if (new_size != expected_size) {
+		return false;
+	}
+	const uint32_t count = read_u32(data + 6);
+	size_t offset = 10;
+	// Every entry takes at least 2 bytes (a leaf), a bogus count fails here
+	// instead of reserving gigabytes
+	if (count > (length - offset) / 2) {
+		return false;
+	}
+
+	std::vector<DagEntry> entries;
+	entries.reserve(count);
+	for (uint32_t id = 0; id < count; ++id) {
+		if (offset >= length) {
+			return false;
+		}
+		DagEntry entry;
+		entry.leaf = data[offset++] == TAG_LEAF;
+		if (entry.leaf) {
+			if (offset >= length) {
+				return false;
+			}
+			entry.type = data[offset++];
+		} else {
+			if (offset + 32 > length) {
+				return false;
+			}
+			for (int slot = 0; slot < 8; ++slot) {
+				entry.children[slot] = read_u32(data + offset);
+				offset += 4;
+				// Children always come first, which also rules out cycles
+				if (entry.children[slot] >= id) {
+					return false;
+				}
+			}
+		}
+		entries.push_back(entry);
+	}
+
+	create(new_size, 0);
+	if (count == 0) {
+		return new_size == 0;
+	}
+
+	// Expand shared subtrees back into a tree that can be edited in place. A
+	// valid tree never has more nodes than a complete one of the same size.
+	size_t max_nodes = 0;
+	for (size_t level_size = 1; level_size <= (size_t)root_size; level_size *= 2) {
+		max_nodes += level_size * level_size * level_size;
+	}
+	struct Expander {
+		VoxelOctree &tree;
+		const std::vector<DagEntry> &entries;
+		const size_t max_nodes;
+
+		bool expand(uint32_t node, uint32_t id, int node_size) {
+			const DagEntry &entry = entries[id];
+			if (entry.leaf) {
+				tree.nodes[node].type = entry.type;
+				return true;
+			}
+			if (node_size == 1 || tree.nodes.size() + 8 > max_nodes) {
+				return false; // Deeper or larger than the declared size
+			}
+			const uint32_t first_child = tree.allocate_children(0);
+			tree.nodes[node].first_child = first_child;
+			for (int slot = 0; slot < 8; ++slot) {
+				if (!expand(first_child + slot, entry.children[slot], node_size / 2)) {
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+	Expander expander{ *this, entries, max_nodes };
+	if (!expander.expand(0, count - 1, root_size)) {
+		create(new_size, 0);
+		return false;
+	}
+	return true;
+}
+
+} // namespace voxel_engine
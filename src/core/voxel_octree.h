@@ -0,0 +1,148 @@
+// voxel_octree.h
+
+#ifndef VOXEL_OCTREE_H
+#define VOXEL_OCTREE_H
+
+#include "voxel_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <godot_cpp/variant/vector3i.hpp>
+
+namespace voxel_engine {
+
+// Sparse cubic block of voxel types. Uniform regions collapse into a single
+// leaf, so sky and deep rock cost one node and memory follows the surface
+// instead of the volume.
+//
+// The tree spans the next power of two above `size`; the padding is never
+// exposed. Nodes live in one pool, the 8 children of a node are contiguous and
+// ordered by (x, y, z) bits 0, 1, 2. Edits split leaves on the way down and
+// merge identical children on the way back up, so the tree stays minimal.
+//
+// serialize() writes a DAG: identical subtrees are stored once.
+class VoxelOctree {
+public:
+	VoxelOctree() = default;
+
+	void create(int p_size, uint8_t p_fill = 0);
+	int get_size() const { return size; }
+
+	inline bool is_in_bounds(int x, int y, int z) const {
+		return x >= 0 && x < size && y >= 0 && y < size && z >= 0 && z < size;
+	}
+	inline bool is_in_bounds(const godot::Vector3i &pos) const {
+		return is_in_bounds(pos.x, pos.y, pos.z);
+	}
+
+	uint8_t get(int x, int y, int z) const;
+	void set(int x, int y, int z, uint8_t type);
+	void fill(uint8_t type);
+
+	// Same contract as the VoxelBuffer box operations: inclusive ranges clipped
+	// to the block, packed data ordered X, Z, Y.
+	void fill_box(const godot::Vector3i &from, const godot::Vector3i &to, uint8_t type);
+	int replace_in_box(const godot::Vector3i &from, const godot::Vector3i &to, uint8_t old_type, uint8_t new_type);
+	void copy_box_to(const godot::Vector3i &from, const godot::Vector3i &to, uint8_t *dst) const;
+	void copy_box_from(const godot::Vector3i &from, const godot::Vector3i &to, const uint8_t *src);
+
+	// Calls `fn(const Vector3i &from, const Vector3i &to, uint8_t type)` once per
+	// uniform region intersecting the box, with the region clipped to the box.
+	template <typename F>
+	void for_each_leaf_in_box(const godot::Vector3i &from, const godot::Vector3i &to, F &&fn) const;
+	// Calls `fn(const Vector3i &pos, uint8_t type)` for every voxel in the box
+	template <typename F>
+	void for_each_in_box(const godot::Vector3i &from, const godot::Vector3i &to, F &&fn) const;
+
+	void from_buffer(const VoxelBuffer &buffer);
+	void to_buffer(VoxelBuffer &r_buffer) const;
+
+	std::vector<uint8_t> serialize() const;
+	// Fails without expanding anything when the data doesn't declare
+	// `expected_size`, or would expand past a complete tree of that size
+	bool deserialize(const uint8_t *data, size_t length, int expected_size);
+
+	int get_node_count() const { return (int)(nodes.size() - free_blocks.size() * 8); }
+	size_t get_memory_usage() const { return nodes.capacity() * sizeof(Node) + free_blocks.capacity() * sizeof(uint32_t); }
+
+private:
+	static constexpr uint32_t NO_CHILDREN = 0xFFFFFFFFu;
+
+	struct Node {
+		uint32_t first_child = NO_CHILDREN;
+		uint8_t type = 0; // Only meaningful on leaves
+	};
+
+	inline bool is_leaf(uint32_t node) const { return nodes[node].first_child == NO_CHILDREN; }
+	inline static int get_child_slot(int x, int y, int z, int half) {
+		return (x >= half ? 1 : 0) | (y >= half ? 2 : 0) | (z >= half ? 4 : 0);
+	}
+	inline static godot::Vector3i get_child_offset(int slot, int half) {
+		return godot::Vector3i((slot & 1) ? half : 0, (slot & 2) ? half : 0, (slot & 4) ? half : 0);
+	}
+
+	uint32_t allocate_children(uint8_t type);
+	void split(uint32_t node);
+	void free_subtree(uint32_t node);
+	void try_collapse(uint32_t node);
+	bool clip_box(const godot::Vector3i &from, const godot::Vector3i &to, godot::Vector3i &r_from, godot::Vector3i &r_to) const;
+
+	void set_recursive(uint32_t node, int node_size, int x, int y, int z, uint8_t type);
+	void fill_box_recursive(uint32_t node, const godot::Vector3i &origin, int node_size, const godot::Vector3i &from, const godot::Vector3i &to, uint8_t type);
+	int replace_recursive(uint32_t node, const godot::Vector3i &origin, int node_size, const godot::Vector3i &from, const godot::Vector3i &to, uint8_t old_type, uint8_t new_type);
+	void build_recursive(uint32_t node, const godot::Vector3i &origin, int node_size, const VoxelBuffer &buffer);
+	template <typename F>
+	void leaf_recursive(uint32_t node, const godot::Vector3i &origin, int node_size, const godot::Vector3i &from, const godot::Vector3i &to, F &fn) const;
+
+	int size = 0;
+	int root_size = 0; // Power of two >= size
+	std::vector<Node> nodes; // Node 0 is the root
+	std::vector<uint32_t> free_blocks; // First index of released child blocks
+};
+
+template <typename F>
+void VoxelOctree::for_each_leaf_in_box(const godot::Vector3i &from, const godot::Vector3i &to, F &&fn) const {
+	godot::Vector3i lo, hi;
+	if (!clip_box(from, to, lo, hi)) {
+		return;
+	}
+	leaf_recursive(0, godot::Vector3i(), root_size, lo, hi, fn);
+}
+
+template <typename F>
+void VoxelOctree::for_each_in_box(const godot::Vector3i &from, const godot::Vector3i &to, F &&fn) const {
+	for_each_leaf_in_box(from, to, [&fn](const godot::Vector3i &lo, const godot::Vector3i &hi, uint8_t type) {
+		for (int y = lo.y; y <= hi.y; ++y) {
+			for (int z = lo.z; z <= hi.z; ++z) {
+				for (int x = lo.x; x <= hi.x; ++x) {
+					fn(godot::Vector3i(x, y, z), type);
+				}
+			}
+		}
+	});
+}
+
+template <typename F>
+void VoxelOctree::leaf_recursive(uint32_t node, const godot::Vector3i &origin, int node_size, const godot::Vector3i &from, const godot::Vector3i &to, F &fn) const {
+	const godot::Vector3i end = origin + godot::Vector3i(node_size - 1, node_size - 1, node_size - 1);
+	if (end.x < from.x || end.y < from.y || end.z < from.z || origin.x > to.x || origin.y > to.y || origin.z > to.z) {
+		return;
+	}
+	if (is_leaf(node)) {
+		const godot::Vector3i lo(MAX(origin.x, from.x), MAX(origin.y, from.y), MAX(origin.z, from.z));
+		const godot::Vector3i hi(MIN(end.x, to.x), MIN(end.y, to.y), MIN(end.z, to.z));
+		fn(lo, hi, nodes[node].type);
+		return;
+	}
+	const int half = node_size / 2;
+	const uint32_t first_child = nodes[node].first_child;
+	for (int slot = 0; slot < 8; ++slot) {
+		leaf_recursive(first_child + slot, origin + get_child_offset(slot, half), half, from, to, fn);
+	}
+}
+
+} // namespace voxel_engine
+
+#endif // VOXEL_OCTREE_H
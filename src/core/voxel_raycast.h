@@ -0,0 +1,140 @@
+// voxel_raycast.h
+#pragma once
+
+#include "direction.h"
+#include "voxel_math.h"
+
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include <godot_cpp/variant/vector3.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+namespace voxel_engine {
+
+struct VoxelRaycastHit {
+	bool hit = false;
+	godot::Vector3i position; // Voxel that was hit
+	godot::Vector3i previous_position; // Last empty voxel before the hit, useful for placing
+	Direction::Value face = Direction::POSITIVE_Y; // Face of the hit voxel the ray entered through
+	float distance = 0.0f;
+	int type = 0;
+};
+
+// Distances along `direction` (any length, measured normalized) where the
+// ray is inside the box, r_enter clamped to 0. False when it misses the box or
+// the box is empty.
+inline bool ray_box_range(const godot::Vector3 &origin, const godot::Vector3 &direction, const godot::Vector3 &box_min, const godot::Vector3 &box_max, float &r_enter, float &r_exit) {
+	const float length = direction.length();
+	if (length <= 0.0f) {
+		return false;
+	}
+	r_enter = 0.0f;
+	r_exit = std::numeric_limits<float>::infinity();
+	for (int axis = 0; axis < 3; ++axis) {
+		if (box_max[axis] <= box_min[axis]) {
+			return false;
+		}
+		const float d = direction[axis] / length;
+		if (d == 0.0f) {
+			if (origin[axis] < box_min[axis] || origin[axis] > box_max[axis]) {
+				return false;
+			}
+			continue;
+		}
+		float t_near = (box_min[axis] - origin[axis]) / d;
+		float t_far = (box_max[axis] - origin[axis]) / d;
+		if (t_near > t_far) {
+			std::swap(t_near, t_far);
+		}
+		r_enter = std::fmax(r_enter, t_near);
+		r_exit = std::fmin(r_exit, t_far);
+	}
+	return r_enter <= r_exit;
+}
+
+// Amanatides & Woo voxel traversal. Voxels are unit cubes, voxel (x, y, z)
+// spanning [x, x + 1). `sample(Vector3i) -> int` returns the voxel type at a
+// position and `is_hit(int) -> bool` decides whether the ray stops there.
+// Each step costs one comparison per axis and one sample, so the sampler is
+// expected to be cheap (no allocation, cached chunk lookup). The walk only
+// ends on a hit or at max_distance, keep it finite (see ray_box_range).
+template <typename Sampler, typename HitTest>
+VoxelRaycastHit voxel_raycast(const godot::Vector3 &origin, const godot::Vector3 &direction, float max_distance, Sampler &&sample, HitTest &&is_hit) {
+	VoxelRaycastHit result;
+
+	const float length = direction.length();
+	if (length <= 0.0f || max_distance < 0.0f) {
+		return result;
+	}
+	const godot::Vector3 dir = direction / length;
+	const float inf = std::numeric_limits<float>::infinity();
+
+	godot::Vector3i cell = world_to_voxel(origin);
+	godot::Vector3i step;
+	float t_max[3];
+	float t_delta[3];
+
+	for (int axis = 0; axis < 3; ++axis) {
+		const float d = dir[axis];
+		if (d > 0.0f) {
+			step[axis] = 1;
+			t_delta[axis] = 1.0f / d;
+			t_max[axis] = ((float)(cell[axis] + 1) - origin[axis]) * t_delta[axis];
+		} else if (d < 0.0f) {
+			step[axis] = -1;
+			t_delta[axis] = -1.0f / d;
+			t_max[axis] = (origin[axis] - (float)cell[axis]) * t_delta[axis];
+		} else {
+			step[axis] = 0;
+			t_delta[axis] = inf;
+			t_max[axis] = inf;
+		}
+	}
+
+	// Starting inside a solid voxel: report it, entered through the face opposing the ray
+	int dominant = 0;
+	for (int axis = 1; axis < 3; ++axis) {
+		if (std::fabs(dir[axis]) > std::fabs(dir[dominant])) {
+			dominant = axis;
+		}
+	}
+	godot::Vector3i entry_normal;
+	entry_normal[dominant] = -step[dominant];
+
+	godot::Vector3i previous = cell;
+	float t = 0.0f;
+
+	while (t <= max_distance) {
+		const int type = sample(cell);
+		if (is_hit(type)) {
+			result.hit = true;
+			result.position = cell;
+			result.previous_position = previous;
+			result.face = Direction::from_vector(entry_normal);
+			result.distance = t;
+			result.type = type;
+			return result;
+		}
+
+		int axis = 0;
+		if (t_max[1] < t_max[axis]) {
+			axis = 1;
+		}
+		if (t_max[2] < t_max[axis]) {
+			axis = 2;
+		}
+
+		previous = cell;
+		t = t_max[axis];
+		cell[axis] += step[axis];
+		t_max[axis] += t_delta[axis];
+		entry_normal = godot::Vector3i();
+		entry_normal[axis] = -step[axis];
+	}
+
+	return result;
+}
+
+} // namespace voxel_engine
@@ -0,0 +1,67 @@
+#include "voxel_snapshot.h"
+
+#include <cstring>
+#include <vector>
+
+namespace voxel_engine {
+
+void VoxelSnapshot::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_chunk_count"), &VoxelSnapshot::get_chunk_count);
+	ClassDB::bind_method(D_METHOD("get_chunk_coords"), &VoxelSnapshot::get_chunk_coords);
+}
+
+void VoxelSnapshot::capture(const Chunk &chunk) {
+	ChunkState state;
+	state.sparse = chunk.get_storage_mode() == Chunk::STORAGE_SPARSE;
+	if (state.sparse) {
+		state.octree = chunk.octree;
+	} else {
+		state.buffer = chunk.buffer;
+	}
+	chunks.insert(chunk.get_chunk_coord(), state);
+}
+
+bool VoxelSnapshot::is_equal(const ChunkState &a, const ChunkState &b) {
+	if (!a.sparse && !b.sparse) {
+		return a.buffer.is_shared_with(b.buffer) ||
+				(a.buffer.get_volume() == b.buffer.get_volume() && memcmp(a.buffer.ptr(), b.buffer.ptr(), a.buffer.get_volume()) == 0);
+	}
+	const int size = a.sparse ? a.octree.get_size() : a.buffer.get_size();
+	if (size != (b.sparse ? b.octree.get_size() : b.buffer.get_size())) {
+		return false;
+	}
+	for (int y = 0; y < size; ++y) {
+		for (int z = 0; z < size; ++z) {
+			for (int x = 0; x < size; ++x) {
+				if (a.get(Vector3i(x, y, z)) != b.get(Vector3i(x, y, z))) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+void VoxelSnapshot::remove_unchanged(VoxelSnapshot &other) {
+	std::vector<Vector3i> unchanged;
+	for (const KeyValue<Vector3i, ChunkState> &entry : chunks) {
+		const ChunkState *other_state = other.chunks.getptr(entry.key);
+		if (other_state && is_equal(entry.value, *other_state)) {
+			unchanged.push_back(entry.key);
+		}
+	}
+	for (const Vector3i &coord : unchanged) {
+		chunks.erase(coord);
+		other.chunks.erase(coord);
+	}
+}
+
+TypedArray<Vector3i> VoxelSnapshot::get_chunk_coords() const {
+	TypedArray<Vector3i> coords;
+	for (const KeyValue<Vector3i, ChunkState> &entry : chunks) {
+		coords.push_back(entry.key);
+	}
+	return coords;
+}
+
+} // namespace voxel_engine
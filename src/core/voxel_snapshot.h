@@ -0,0 +1,92 @@
+// voxel_snapshot.h
+
+#ifndef VOXEL_SNAPSHOT_H
+#define VOXEL_SNAPSHOT_H
+
+#include "chunk.h"
+#include "voxel_buffer.h"
+#include "voxel_octree.h"
+
+// Godot includes
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+using namespace godot;
+
+namespace voxel_engine {
+
+// Voxel types of a set of chunks at one point in time, for undo. Dense chunks
+// are captured by sharing their buffer (see VoxelBuffer, copy on write), so a
+// capture costs a reference per chunk and a chunk's voxels are only duplicated
+// once it is edited. Sparse chunks copy their octree, which is already small.
+//
+// A RefCounted so that UndoRedo keeps snapshots alive for as long as the
+// actions referring to them are in its history.
+class VoxelSnapshot : public RefCounted {
+	GDCLASS(VoxelSnapshot, RefCounted);
+
+protected:
+	static void _bind_methods();
+
+public:
+	struct ChunkState {
+		bool sparse = false;
+		VoxelBuffer buffer;
+		VoxelOctree octree;
+
+		inline uint8_t get(const Vector3i &local_pos) const {
+			return sparse ? octree.get(local_pos.x, local_pos.y, local_pos.z) : buffer.get(local_pos.x, local_pos.y, local_pos.z);
+		}
+	};
+
+	void capture(const Chunk &chunk);
+	// Drops the chunks whose voxels are the same in both snapshots, leaving
+	// what an edit made between the two changed
+	void remove_unchanged(VoxelSnapshot &other);
+
+	const HashMap<Vector3i, ChunkState> &get_chunks() const { return chunks; }
+	int get_chunk_count() const { return chunks.size(); }
+	TypedArray<Vector3i> get_chunk_coords() const;
+
+	// Calls `fn(const Vector3i &local_pos, uint8_t type)` for every voxel of
+	// `chunk` that differs from `state`, with the type in `state`
+	template <typename F>
+	static void for_each_difference(const ChunkState &state, const Chunk &chunk, F &&fn);
+
+private:
+	static bool is_equal(const ChunkState &a, const ChunkState &b);
+
+	HashMap<Vector3i, ChunkState> chunks;
+};
+
+template <typename F>
+void VoxelSnapshot::for_each_difference(const ChunkState &state, const Chunk &chunk, F &&fn) {
+	const int size = chunk.get_chunk_size();
+	if (!state.sparse && chunk.get_storage_mode() == Chunk::STORAGE_DENSE) {
+		// Untouched since the capture: still the same storage
+		if (state.buffer.is_shared_with(chunk.buffer)) {
+			return;
+		}
+		const uint8_t *expected = state.buffer.ptr();
+		const uint8_t *current = chunk.buffer.ptr();
+		for (int i = 0; i < state.buffer.get_volume(); ++i) {
+			if (expected[i] != current[i]) {
+				fn(Vector3i(i % size, i / (size * size), (i / size) % size), expected[i]);
+			}
+		}
+		return;
+	}
+	chunk.for_each_voxel_in_box(Vector3i(), Vector3i(size - 1, size - 1, size - 1), [&](const Vector3i &local_pos, uint8_t type) {
+		const uint8_t expected = state.get(local_pos);
+		if (expected != type) {
+			fn(local_pos, expected);
+		}
+	});
+}
+
+} // namespace voxel_engine
+
+#endif // VOXEL_SNAPSHOT_H
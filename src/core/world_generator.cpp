@@ -0,0 +1,207 @@
+#include "world_generator.h"
+#include "generator_stages.h"
+#include "voxel.h"
+#include "voxel_math.h"
+
+#include <algorithm>
+
+namespace voxel_engine {
+
+WorldGenerator::WorldGenerator() {
+	configure(WorldGeneratorSettings());
+}
+
+WorldGenerator::WorldGenerator(const WorldGeneratorSettings &p_settings) {
+	configure(p_settings);
+}
+
+void WorldGenerator::configure(const WorldGeneratorSettings &p_settings) {
+	settings = p_settings;
+
+	height_noise.instantiate();
+	height_noise->set_seed(settings.seed);
+	height_noise->set_noise_type(FastNoiseLite::TYPE_SIMPLEX_SMOOTH);
+	height_noise->set_fractal_type(FastNoiseLite::FRACTAL_FBM);
+	height_noise->set_fractal_octaves(4);
+	height_noise->set_frequency(settings.terrain_scale);
+
+	biome_noise.instantiate();
+	biome_noise->set_seed(settings.seed + 1);
+	biome_noise->set_noise_type(FastNoiseLite::TYPE_SIMPLEX);
+	biome_noise->set_frequency(settings.terrain_scale * 0.5f);
+
+	detail_noise.instantiate();
+	detail_noise->set_seed(settings.seed + 3);
+	detail_noise->set_noise_type(FastNoiseLite::TYPE_SIMPLEX);
+	detail_noise->set_fractal_type(FastNoiseLite::FRACTAL_NONE);
+	detail_noise->set_frequency(settings.terrain_scale * 6.0f);
+
+	cave_noise.instantiate();
+	cave_noise->set_seed(settings.seed + 2);
+	cave_noise->set_noise_type(FastNoiseLite::TYPE_SIMPLEX);
+	cave_noise->set_fractal_type(FastNoiseLite::FRACTAL_NONE);
+	cave_noise->set_frequency(settings.terrain_scale * 4.0f);
+
+	clear_stages();
+	add_stage(std::make_unique<TerrainStage>());
+	if (settings.caves) {
+		add_stage(std::make_unique<CaveStage>());
+	}
+	if (settings.ores) {
+		add_stage(std::make_unique<OreStage>());
+	}
+	if (settings.fluids) {
+		add_stage(std::make_unique<FluidStage>());
+	}
+	if (settings.decorations) {
+		add_stage(std::make_unique<DecorationStage>());
+	}
+
+	clear_column_cache();
+	reset_stats();
+}
+
+void WorldGenerator::reset_stats() {
+	stats.empty_chunks = 0;
+	stats.solid_chunks = 0;
+	stats.mixed_chunks = 0;
+	stats.noise_samples_3d = 0;
+}
+
+void WorldGenerator::add_stage(std::unique_ptr<GeneratorStage> stage) {
+	stages.push_back(std::move(stage));
+}
+
+void WorldGenerator::clear_stages() {
+	stages.clear();
+}
+
+void WorldGenerator::generate_chunk(const Vector3i &chunk_coord, int size, VoxelBuffer &r_buffer) const {
+	r_buffer.create(size, AIR);
+
+	ChunkGenerationContext ctx;
+	ctx.generator = this;
+	ctx.chunk_coord = chunk_coord;
+	ctx.origin = chunk_coord * size;
+	ctx.size = size;
+	ctx.buffer = &r_buffer;
+	ctx.column = get_column(Vector2i(chunk_coord.x, chunk_coord.z), size);
+	ctx.chunk_class = classify_chunk(chunk_coord, size, *ctx.column);
+
+	if (ctx.chunk_class == ChunkClass::EMPTY) {
+		stats.empty_chunks++;
+		// Open sea or sky, nothing else can reach this high
+		if (settings.fluids && ctx.origin.y + size - 1 <= settings.sea_level) {
+			r_buffer.fill(WATER);
+		} else if (settings.fluids && ctx.origin.y <= settings.sea_level) {
+			r_buffer.fill_box(Vector3i(0, 0, 0), Vector3i(size - 1, settings.sea_level - ctx.origin.y, size - 1), WATER);
+		}
+		return;
+	}
+	if (ctx.chunk_class == ChunkClass::SOLID) {
+		stats.solid_chunks++;
+	} else {
+		stats.mixed_chunks++;
+	}
+
+	for (const std::unique_ptr<GeneratorStage> &stage : stages) {
+		stage->generate(ctx);
+	}
+}
+
+ChunkClass WorldGenerator::classify_chunk(const Vector3i &chunk_coord, int size, const ColumnData &column) const {
+	const int bottom = chunk_coord.y * size;
+	const int top = bottom + size - 1;
+	const int band = (int)std::ceil(settings.overhang_amplitude);
+
+	// Structures rooted in neighbor columns can lean over, so look at the 3x3 neighborhood
+	int neighborhood_max = column.max_height;
+	for (int dz = -1; dz <= 1; ++dz) {
+		for (int dx = -1; dx <= 1; ++dx) {
+			if (dx != 0 || dz != 0) {
+				neighborhood_max = std::max(neighborhood_max, get_column(Vector2i(chunk_coord.x + dx, chunk_coord.z + dz), size)->max_height);
+			}
+		}
+	}
+	if (bottom > neighborhood_max + band + SURFACE_REACH) {
+		return ChunkClass::EMPTY;
+	}
+	// Below the band and the surface filler layers, the terrain stage is pure stone
+	if (top < column.min_height - band - 4) {
+		return ChunkClass::SOLID;
+	}
+	return ChunkClass::MIXED;
+}
+
+std::shared_ptr<const ColumnData> WorldGenerator::get_column(const Vector2i &column_coord, int size) const {
+	{
+		std::lock_guard<std::mutex> lock(column_cache_mutex);
+		const std::shared_ptr<const ColumnData> *cached = column_cache.getptr(column_coord);
+		if (cached && (*cached)->size == size) {
+			return *cached;
+		}
+	}
+
+	// Compute outside the lock, two threads racing on the same column produce identical data
+	std::shared_ptr<const ColumnData> column = compute_column(column_coord, size);
+
+	std::lock_guard<std::mutex> lock(column_cache_mutex);
+	if (column_cache.size() >= MAX_CACHED_COLUMNS) {
+		column_cache.clear();
+	}
+	column_cache.insert(column_coord, column);
+	tracked_column_cache.set((int64_t)column_cache.size() * (int64_t)(sizeof(ColumnData) + size * size * (sizeof(int) + sizeof(Biome))));
+	return column;
+}
+
+int WorldGenerator::get_surface_height(int world_x, int world_z, int size) const {
+	std::shared_ptr<const ColumnData> column = get_column(Vector2i(floor_div(world_x, size), floor_div(world_z, size)), size);
+	return column->heights[column->get_index(floor_mod(world_x, size), floor_mod(world_z, size))];
+}
+
+void WorldGenerator::clear_column_cache() {
+	std::lock_guard<std::mutex> lock(column_cache_mutex);
+	column_cache.clear();
+	tracked_column_cache.set(0);
+}
+
+std::shared_ptr<ColumnData> WorldGenerator::compute_column(const Vector2i &column_coord, int size) const {
+	std::shared_ptr<ColumnData> column = std::make_shared<ColumnData>();
+	column->size = size;
+	column->heights.resize(size * size);
+	column->biomes.resize(size * size);
+
+	const float rocky_height = settings.sea_level + settings.terrain_height * 0.6f;
+	column->min_height = settings.world_height;
+	column->max_height = 0;
+
+	for (int z = 0; z < size; ++z) {
+		for (int x = 0; x < size; ++x) {
+			const float world_x = (float)(column_coord.x * size + x);
+			const float world_z = (float)(column_coord.y * size + z);
+
+			const float surface = settings.sea_level + height_noise->get_noise_2d(world_x, world_z) * settings.terrain_height;
+			const int height = std::clamp((int)std::floor(surface), 1, settings.world_height - 1);
+
+			Biome biome = Biome::GRASSLAND;
+			if (height < settings.sea_level - 1) {
+				biome = Biome::OCEAN;
+			} else if (height <= settings.sea_level + 1) {
+				biome = Biome::BEACH;
+			} else if (height > rocky_height) {
+				biome = Biome::ROCKY;
+			} else if (biome_noise->get_noise_2d(world_x, world_z) > 0.3f) {
+				biome = Biome::DESERT;
+			}
+
+			const int index = column->get_index(x, z);
+			column->heights[index] = height;
+			column->biomes[index] = biome;
+			column->min_height = std::min(column->min_height, height);
+			column->max_height = std::max(column->max_height, height);
+		}
+	}
+	return column;
+}
+
+} // namespace voxel_engine
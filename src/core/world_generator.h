@@ -0,0 +1,190 @@
+// world_generator.h
+
+#ifndef WORLD_GENERATOR_H
+#define WORLD_GENERATOR_H
+
+#include "memory_tracker.h"
+#include "voxel_buffer.h"
+#include "voxel_constants.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Godot includes
+#include <godot_cpp/classes/fast_noise_lite.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/variant/vector2i.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+using namespace godot;
+
+namespace voxel_engine {
+
+enum class Biome : uint8_t {
+	OCEAN,
+	BEACH,
+	GRASSLAND,
+	DESERT,
+	ROCKY
+};
+
+struct WorldGeneratorSettings {
+	int seed = DEFAULT_WORLD_SEED;
+	int world_height = DEFAULT_WORLD_HEIGHT;
+	int sea_level = 64;
+	int lava_level = 12; // Cave air below this turns into lava
+	float terrain_height = 32.0f; // Amplitude of the surface around sea level
+	float terrain_scale = TERRAIN_SCALE; // Frequency of the surface noise
+	float overhang_amplitude = 6.0f; // 3D detail is only sampled this far around the surface
+	float cave_threshold = 0.08f;
+	int cave_depth = 48; // Caves only reach this far below the surface
+	bool caves = true;
+	bool ores = true;
+	bool fluids = true;
+	bool decorations = true;
+};
+
+// Surface height and biome for every (x, z) of a chunk column. Computed once
+// and shared by all chunks stacked in that column, and by neighbors.
+struct ColumnData {
+	int size = 0;
+	int min_height = 0;
+	int max_height = 0;
+	std::vector<int> heights;
+	std::vector<Biome> biomes;
+
+	inline int get_index(int x, int z) const { return x + z * size; }
+};
+
+class WorldGenerator;
+
+// How a chunk sits relative to the surface band, decided from column bounds only
+enum class ChunkClass : uint8_t {
+	EMPTY, // Above everything: air (or sea water), no stage needs to run
+	SOLID, // Below the band: terrain is plain stone, no surface noise needed
+	MIXED // Intersects the band: evaluated per voxel
+};
+
+struct ChunkGenerationContext {
+	const WorldGenerator *generator = nullptr;
+	Vector3i chunk_coord;
+	Vector3i origin; // World position of the chunk's (0, 0, 0) voxel
+	int size = 0;
+	VoxelBuffer *buffer = nullptr;
+	std::shared_ptr<const ColumnData> column;
+	ChunkClass chunk_class = ChunkClass::MIXED;
+};
+
+// One pass of the generation pipeline. Stages run in order on the same chunk
+// and must be thread safe: several chunks are generated concurrently.
+class GeneratorStage {
+public:
+	virtual ~GeneratorStage() {}
+	virtual const char *get_name() const = 0;
+	virtual void generate(ChunkGenerationContext &ctx) const = 0;
+};
+
+class WorldGenerator {
+public:
+	WorldGenerator();
+	explicit WorldGenerator(const WorldGeneratorSettings &p_settings);
+
+	// Rebuilds noise and the default stage list, drops cached columns
+	void configure(const WorldGeneratorSettings &p_settings);
+	const WorldGeneratorSettings &get_settings() const { return settings; }
+
+	void add_stage(std::unique_ptr<GeneratorStage> stage);
+	void clear_stages();
+
+	// Thread safe, the buffer is (re)created at `size`
+	void generate_chunk(const Vector3i &chunk_coord, int size, VoxelBuffer &r_buffer) const;
+
+	// Neighbor context, usable from any stage
+	std::shared_ptr<const ColumnData> get_column(const Vector2i &column_coord, int size) const;
+	int get_surface_height(int world_x, int world_z, int size) const;
+
+	void clear_column_cache();
+
+	// Highest voxel any stage may write above the surface (overhangs, structures)
+	static constexpr int SURFACE_REACH = 8;
+	ChunkClass classify_chunk(const Vector3i &chunk_coord, int size, const ColumnData &column) const;
+
+	// Counters since the last configure()
+	struct Stats {
+		std::atomic<uint64_t> empty_chunks{ 0 };
+		std::atomic<uint64_t> solid_chunks{ 0 };
+		std::atomic<uint64_t> mixed_chunks{ 0 };
+		std::atomic<uint64_t> noise_samples_3d{ 0 };
+	};
+	mutable Stats stats;
+
+	// Shared noise, read only once configured
+	Ref<FastNoiseLite> height_noise;
+	Ref<FastNoiseLite> biome_noise;
+	Ref<FastNoiseLite> detail_noise;
+	Ref<FastNoiseLite> cave_noise;
+
+private:
+	std::shared_ptr<ColumnData> compute_column(const Vector2i &column_coord, int size) const;
+	void reset_stats();
+
+	WorldGeneratorSettings settings;
+	std::vector<std::unique_ptr<GeneratorStage>> stages;
+
+	static constexpr uint32_t MAX_CACHED_COLUMNS = 4096;
+	mutable std::mutex column_cache_mutex;
+	mutable HashMap<Vector2i, std::shared_ptr<const ColumnData>> column_cache;
+	mutable TrackedBytes tracked_column_cache{ MemoryTracker::CATEGORY_CACHES };
+};
+
+// Stateless 64 bit mixing (splitmix64 finalizer), used for placement decisions
+inline uint64_t hash_mix64(uint64_t x) {
+	x += 0x9E3779B97F4A7C15ull;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+	return x ^ (x >> 31);
+}
+
+inline uint64_t hash_coords(uint64_t seed, int x, int y, int z) {
+	uint64_t h = hash_mix64(seed);
+	h = hash_mix64(h ^ (uint32_t)x);
+	h = hash_mix64(h ^ (uint32_t)y);
+	return hash_mix64(h ^ (uint32_t)z);
+}
+
+// Seed of one stage's random stream for one chunk (or column). It only depends
+// on the world seed, the coordinate and the stage, never on generation order,
+// so any chunk regenerates bit-identically alone, in any order, on any thread.
+inline uint64_t derive_seed(uint64_t world_seed, const Vector3i &coord, uint64_t stage_salt) {
+	return hash_coords(hash_mix64(world_seed) ^ stage_salt, coord.x, coord.y, coord.z);
+}
+
+// Counter based generator: draw n of a stream is a pure function of the key
+// and n, so there is no hidden state to share between threads or to replay
+struct CounterRandom {
+	uint64_t key;
+	uint64_t counter = 0;
+
+	explicit CounterRandom(uint64_t p_key) :
+			key(p_key) {}
+
+	uint64_t at(uint64_t index) const {
+		return hash_mix64(key ^ hash_mix64(index));
+	}
+	uint32_t next_u32() {
+		return (uint32_t)(at(counter++) >> 32);
+	}
+	float next_float() {
+		return (next_u32() >> 8) * (1.0f / 16777216.0f);
+	}
+	int next_range(int n) {
+		return (int)(((uint64_t)next_u32() * (uint32_t)n) >> 32);
+	}
+};
+
+} // namespace voxel_engine
+
+#endif // WORLD_GENERATOR_H
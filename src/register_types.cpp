@@ -2,12 +2,17 @@
 
 #include <gdextension_interface.h>
 #include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/classes/performance.hpp>
 #include <godot_cpp/core/defs.hpp>
 #include <godot_cpp/godot.hpp>
 
 #include "VoxelGenerator.h"
 #include "core/chunk.h"
+#include "core/epoch_reclaimer.h"
+#include "core/job_system.h"
+#include "core/memory_tracker.h"
 #include "core/voxel.h"
+#include "core/voxel_snapshot.h"
 
 using namespace godot;
 using namespace voxel_engine;
@@ -17,10 +22,24 @@ void initialize_voxel_engine_module(ModuleInitializationLevel p_level) {
 		return;
 	}
 
+	// Background jobs shared by every generator
+	JobSystem::create();
+	MemoryTracker::create();
+	EpochReclaimer::create();
+
+	// Memory per category in the debugger's Monitors tab
+	Performance *performance = Performance::get_singleton();
+	for (int i = 0; i < MemoryTracker::CATEGORY_COUNT; ++i) {
+		const String name = MemoryTracker::get_category_name(MemoryTracker::Category(i));
+		performance->add_custom_monitor("VoxelEngine/" + name + "_mb", callable_mp_static(&MemoryTracker::get_category_megabytes).bind(i));
+	}
+	performance->add_custom_monitor("VoxelEngine/total_mb", callable_mp_static(&MemoryTracker::get_total_megabytes));
+
 	// Register the Voxel class
 	GDREGISTER_CLASS(Voxel);
 	// Register the Chunk class
 	GDREGISTER_CLASS(Chunk);
+	GDREGISTER_CLASS(VoxelSnapshot);
 	// Register the VoxelGenerator class
 	GDREGISTER_CLASS(VoxelGenerator);
 }
@@ -29,6 +48,18 @@ void uninitialize_voxel_engine_module(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
+
+	Performance *performance = Performance::get_singleton();
+	for (int i = 0; i < MemoryTracker::CATEGORY_COUNT; ++i) {
+		performance->remove_custom_monitor("VoxelEngine/" + String(MemoryTracker::get_category_name(MemoryTracker::Category(i))) + "_mb");
+	}
+	performance->remove_custom_monitor("VoxelEngine/total_mb");
+
+	// Nodes are gone by now, so are their jobs
+	JobSystem::destroy();
+	// No job left to read what is still retired
+	EpochReclaimer::destroy();
+	MemoryTracker::destroy();
 }
 
 extern "C" {